@@ -0,0 +1,307 @@
+#include "ArcTopology.h"
+#include <macgyver/Exception.h>
+#include <macgyver/Hash.h>
+#include <algorithm>
+#include <limits>
+#include <ogr_geometry.h>
+
+namespace Fmi
+{
+namespace
+{
+const std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Split the linestrings and rings into unique arcs
+ *
+ * A vertex is a junction if the coordinates appear with different
+ * neighbours in different places, or if it is an end point of an open
+ * linestring. Open paths are cut at every junction, rings at every
+ * junction with the last arc wrapping around to the first junction.
+ */
+// ----------------------------------------------------------------------
+
+ArcTopology::ArcTopology(const std::vector<OGRGeometryPtr>& theGeoms) : m_paths(theGeoms)
+{
+  try
+  {
+    const auto& paths = m_paths;
+    const auto groups = paths.groups();
+    const auto& group = groups.group;
+    const auto ngroups = groups.count.size();
+
+    // Find the junctions by comparing the neighbours of each occurrence of the coordinates
+    std::vector<std::size_t> neighbour1(ngroups, npos);
+    std::vector<std::size_t> neighbour2(ngroups, npos);
+    std::vector<unsigned char> junction(ngroups, 0);
+
+    for (const auto& path : paths.paths)
+    {
+      const auto offset = path.offset;
+      const int period = (path.closed ? path.size - 1 : path.size);
+      for (int i = 0; i < period; i++)
+      {
+        const auto g = group[offset + i];
+        if (!path.closed && (i == 0 || i == period - 1))
+        {
+          junction[g] = 1;
+          continue;
+        }
+        const auto prev = group[offset + (i > 0 ? i - 1 : period - 1)];
+        const auto next = group[offset + (i < period - 1 ? i + 1 : 0)];
+        const auto lo = std::min(prev, next);
+        const auto hi = std::max(prev, next);
+        if (neighbour1[g] == npos)
+        {
+          neighbour1[g] = lo;
+          neighbour2[g] = hi;
+        }
+        else if (neighbour1[g] != lo || neighbour2[g] != hi)
+          junction[g] = 1;
+      }
+    }
+
+    // Cut the paths into arcs
+    std::vector<std::size_t> vertices;
+    std::vector<int> cuts;
+    for (const auto& path : paths.paths)
+    {
+      m_first.push_back(m_refs.size());
+
+      const auto offset = path.offset;
+      const int period = (path.closed ? path.size - 1 : path.size);
+      if (period < 2)
+        continue;
+
+      cuts.clear();
+      for (int i = 0; i < period; i++)
+        if (junction[group[offset + i]])
+          cuts.push_back(i);
+
+      if (cuts.empty())
+      {
+        vertices.clear();
+        for (int i = 0; i < period; i++)
+          vertices.push_back(offset + i);
+        add_arc(paths, group, vertices, true);
+        continue;
+      }
+
+      const int ncuts = static_cast<int>(cuts.size());
+      const int narcs = (path.closed ? ncuts : ncuts - 1);
+      for (int k = 0; k < narcs; k++)
+      {
+        const int start = cuts[k];
+        const int end = (k + 1 < ncuts ? cuts[k + 1] : cuts[0] + period);
+        vertices.clear();
+        for (int i = start; i <= end; i++)
+          vertices.push_back(offset + (i % period));
+        add_arc(paths, group, vertices, false);
+      }
+    }
+    m_first.push_back(m_refs.size());
+
+    // Rings made of one or two arcs would collapse if the arcs were simplified to their end
+    // points
+    m_minimum.resize(m_arcs.paths.size(), 0);
+    for (std::size_t c = 0; c < paths.paths.size(); c++)
+    {
+      const auto nrefs = m_first[c + 1] - m_first[c];
+      if (nrefs == 0 || nrefs > 2 || !paths.paths[c].closed)
+        continue;
+      for (auto r = m_first[c]; r < m_first[c + 1]; r++)
+      {
+        const auto arc = m_refs[r].arc;
+        const int minimum = (nrefs == 1 && !m_arcs.paths[arc].closed ? 4 : 3);
+        m_minimum[arc] = std::max(m_minimum[arc], minimum);
+      }
+    }
+
+    m_index.clear();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Add a reference to an arc, creating the arc if it is new
+ *
+ * Arcs are stored in a canonical direction, and closed arcs start from
+ * a canonical vertex, so that the same boundary traversed by different
+ * paths in either direction maps to the same arc.
+ */
+// ----------------------------------------------------------------------
+
+void ArcTopology::add_arc(const PathBuffer& thePaths,
+                          const std::vector<std::size_t>& theGroups,
+                          const std::vector<std::size_t>& theVertices,
+                          bool theClosed)
+{
+  const int n = static_cast<int>(theVertices.size());
+  auto g = [&](int k) { return theGroups[theVertices[k]]; };
+
+  // Canonical start and direction
+  int start = 0;
+  bool reversed = false;
+  if (theClosed)
+  {
+    for (int k = 1; k < n; k++)
+      if (g(k) < g(start))
+        start = k;
+    reversed = (g((start + n - 1) % n) < g((start + 1) % n));
+  }
+  else
+  {
+    for (int k = 0; k < n / 2; k++)
+      if (g(k) != g(n - 1 - k))
+      {
+        reversed = (g(n - 1 - k) < g(k));
+        break;
+      }
+  }
+
+  // The k'th vertex in canonical order
+  auto vertex = [&](int k)
+  {
+    if (theClosed)
+      return theVertices[(reversed ? start - k % n + n : start + k) % n];
+    return theVertices[reversed ? n - 1 - k : k];
+  };
+
+  std::size_t hash = Fmi::hash_value(n);
+  Fmi::hash_combine(hash, Fmi::hash_value(theClosed));
+  for (int k = 0; k < n; k++)
+    Fmi::hash_combine(hash, theGroups[vertex(k)]);
+
+  // Reuse an existing identical arc
+  const auto range = m_index.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    const auto& arc = m_arcs.paths[it->second];
+    if (arc.closed != theClosed || arc.size != (theClosed ? n + 1 : n))
+      continue;
+    bool same = true;
+    for (int k = 0; k < n && same; k++)
+    {
+      const auto v = vertex(k);
+      same = (m_arcs.x[arc.offset + k] == thePaths.x[v] &&
+              m_arcs.y[arc.offset + k] == thePaths.y[v]);
+    }
+    if (same)
+    {
+      ++m_uses[it->second];
+      m_refs.push_back(ArcRef{it->second, reversed});
+      return;
+    }
+  }
+
+  // New arc. Closed arcs get the first vertex duplicated at the end just like rings.
+  PathBuffer::Path arc;
+  arc.offset = m_arcs.x.size();
+  arc.size = (theClosed ? n + 1 : n);
+  arc.closed = theClosed;
+  arc.wrap = theClosed;
+
+  for (int k = 0; k < arc.size; k++)
+  {
+    const auto v = vertex(k % n);
+    m_arcs.x.push_back(thePaths.x[v]);
+    m_arcs.y.push_back(thePaths.y[v]);
+  }
+
+  const auto id = m_arcs.paths.size();
+  m_arcs.paths.push_back(arc);
+  m_ends.push_back(m_arcs.x[arc.offset]);
+  m_ends.push_back(m_arcs.y[arc.offset]);
+  m_ends.push_back(m_arcs.x[arc.offset + arc.size - 1]);
+  m_ends.push_back(m_arcs.y[arc.offset + arc.size - 1]);
+
+  m_uses.push_back(1);
+  m_index.emplace(hash, id);
+  m_refs.push_back(ArcRef{id, reversed});
+}
+
+std::vector<int> ArcTopology::counts() const
+{
+  std::vector<int> result(m_arcs.x.size());
+  for (std::size_t i = 0; i < m_arcs.paths.size(); i++)
+  {
+    const auto& arc = m_arcs.paths[i];
+    std::fill(result.begin() + arc.offset, result.begin() + arc.offset + arc.size, m_uses[i]);
+  }
+  return result;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Rebuild the linestrings and rings from the arcs
+ *
+ * Consecutive arcs share their end points, hence the first vertex of
+ * each arc but the first one is skipped. The end points of open arcs are
+ * restored to their original values so that filters cannot move the
+ * junctions. The filters never add vertices, so the rebuilt paths fit
+ * into their original places in the path buffers.
+ */
+// ----------------------------------------------------------------------
+
+void ArcTopology::store(std::vector<OGRGeometryPtr>& theGeoms)
+{
+  try
+  {
+    for (std::size_t c = 0; c < m_paths.paths.size(); c++)
+    {
+      if (m_first[c] == m_first[c + 1])
+        continue;
+
+      auto& path = m_paths.paths[c];
+      double* x = m_paths.x.data() + path.offset;
+      double* y = m_paths.y.data() + path.offset;
+      int pos = 0;
+
+      for (auto r = m_first[c]; r < m_first[c + 1]; r++)
+      {
+        const auto& ref = m_refs[r];
+        const auto& arc = m_arcs.paths[ref.arc];
+        const double* ax = m_arcs.x.data() + arc.offset;
+        const double* ay = m_arcs.y.data() + arc.offset;
+        const double* ends = m_ends.data() + 4 * ref.arc;
+        const int n = arc.size;
+
+        for (int k = (r == m_first[c] ? 0 : 1); k < n; k++, pos++)
+        {
+          const int j = (ref.reversed ? n - 1 - k : k);
+          if (!arc.closed && j == 0)
+          {
+            x[pos] = ends[0];
+            y[pos] = ends[1];
+          }
+          else if (!arc.closed && j == n - 1)
+          {
+            x[pos] = ends[2];
+            y[pos] = ends[3];
+          }
+          else
+          {
+            x[pos] = ax[j];
+            y[pos] = ay[j];
+          }
+        }
+      }
+      path.size = pos;
+    }
+
+    m_paths.store(theGeoms);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace Fmi
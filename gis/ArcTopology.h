@@ -0,0 +1,74 @@
+// ======================================================================
+/*!
+ * \brief Decomposition of linestrings and rings into shared arcs
+ *
+ * Adjacent isobands share their boundaries. Instead of freezing the
+ * shared vertices, the boundaries can be split into arcs at junctions,
+ * which are vertices whose neighbours differ between the paths using
+ * them, as in TopoJSON. Identical arcs are stored only once regardless
+ * of direction, so each shared boundary is filtered once and the
+ * geometries are rebuilt from arc references afterwards:
+ *
+ *   ArcTopology topology(geoms);
+ *   ... filter topology.arcs() in place ...
+ *   topology.store(geoms);
+ *
+ * Open arcs start and end at junctions, which are restored exactly when
+ * the geometries are rebuilt. Rings without any junctions become closed
+ * arcs starting from a canonical vertex.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "PathBuffer.h"
+#include "Types.h"
+#include <unordered_map>
+#include <vector>
+
+namespace Fmi
+{
+class ArcTopology
+{
+ public:
+  explicit ArcTopology(const std::vector<OGRGeometryPtr>& theGeoms);
+
+  // The unique arcs. The filters may modify the coordinates and reduce the arc sizes.
+  PathBuffer& arcs() { return m_arcs; }
+
+  // Minimum number of vertices each arc must keep so that no ring collapses
+  const std::vector<int>& minimumSizes() const { return m_minimum; }
+
+  // Occurrence counts of the arc vertices in the same sense as for the vertices of the
+  // paths: 1 for arcs used once, 2 for arcs shared by two paths
+  std::vector<int> counts() const;
+
+  // Rebuild copies of the geometries from the arcs and replace the originals
+  void store(std::vector<OGRGeometryPtr>& theGeoms);
+
+ private:
+  // Reference to an arc from a linestring or a ring
+  struct ArcRef
+  {
+    std::size_t arc;
+    bool reversed;
+  };
+
+  void add_arc(const PathBuffer& thePaths,
+               const std::vector<std::size_t>& theGroups,
+               const std::vector<std::size_t>& theVertices,
+               bool theClosed);
+
+  PathBuffer m_paths;                 // copies of the input paths
+  std::vector<std::size_t> m_first;  // first reference of each path
+  std::vector<ArcRef> m_refs;
+
+  PathBuffer m_arcs;
+  std::vector<int> m_uses;  // number of references to each arc
+  std::vector<int> m_minimum;
+  std::vector<double> m_ends;  // original end points x1,y1,x2,y2 of each arc
+
+  std::unordered_multimap<std::size_t, std::size_t> m_index;  // arc hash to arc, while building
+};
+
+}  // namespace Fmi
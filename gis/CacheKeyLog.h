@@ -0,0 +1,52 @@
+// ======================================================================
+/*!
+ * \brief Bounded log of recently inserted cache keys
+ *
+ * The macgyver caches cannot be enumerated, hence the caches which can be
+ * saved to a snapshot log the keys they insert. The oldest keys are
+ * forgotten first, keys evicted from the cache are skipped when saving.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Fmi
+{
+class CacheKeyLog
+{
+ public:
+  explicit CacheKeyLog(std::size_t theMaxSize) : m_maxSize(theMaxSize) {}
+
+  void add(const std::string& theKey)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_keys.insert(theKey).second)
+      return;
+    m_order.push_back(theKey);
+    if (m_order.size() > m_maxSize)
+    {
+      m_keys.erase(m_order.front());
+      m_order.pop_front();
+    }
+  }
+
+  std::vector<std::string> keys() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return {m_order.begin(), m_order.end()};
+  }
+
+ private:
+  mutable std::mutex m_mutex;
+  std::size_t m_maxSize;
+  std::deque<std::string> m_order;
+  std::unordered_set<std::string> m_keys;
+};
+
+}  // namespace Fmi
@@ -291,7 +291,8 @@ OGRGeometry* CoordinateTransformation::transformGeometry(const OGRGeometry& geom
     OGREnvelope shape_envelope;
     geom.getEnvelope(&shape_envelope);
 
-    Interrupt interrupt = interruptGeometry(impl->m_target);
+    const auto interrupt_ptr = sharedInterruptGeometry(impl->m_target);
+    const auto& interrupt = *interrupt_ptr;
 
     if (interrupt.empty())
     {
@@ -299,27 +300,17 @@ OGRGeometry* CoordinateTransformation::transformGeometry(const OGRGeometry& geom
       return result.release();
     }
 
-    auto g = make_geometry_ptr(geom.clone());
-
     const double densifyKm = projector.getDensifyResolutionKm();
 
-    for (const auto& box : interrupt.cuts)
-    {
-      g = make_geometry_ptr(OGR::polycut(*g, box, densifyKm));
-      if (!g || g->IsEmpty())
-        return nullptr;
-    }
-
-    for (auto& shape : interrupt.shapeCuts)
-    {
-      g = make_geometry_ptr(OGR::polycut(*g, shape, densifyKm));
-      if (!g || g->IsEmpty())
-        return nullptr;
-    }
+    // Only the parts of the geometry which cross the cuts are processed
+    auto g = make_geometry_ptr(interruptCut(geom, interrupt, densifyKm));
+    if (!g || g->IsEmpty())
+      return nullptr;
 
     if (!interrupt.shapeClips.empty())
     {
-      for (auto& shape : interrupt.shapeClips)
+      // Only the pointers are copied, the clipping API takes a non-const shared_ptr reference
+      for (auto shape : interrupt.shapeClips)
       {
         g = make_geometry_ptr(OGR::polyclip(*g, shape, densifyKm));
         if (!g || g->IsEmpty())
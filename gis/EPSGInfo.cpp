@@ -10,6 +10,8 @@
 #include <sqlite3pp/sqlite3pp.h>
 #include <sqlite3pp/sqlite3ppext.h>
 #include <sqlite3.h>
+#include <algorithm>
+#include <vector>
 
 namespace Fmi
 {
@@ -28,54 +30,48 @@ double area(const BBox& bbox)
   return (bbox.east - bbox.west) * (bbox.north - bbox.south);
 }
 
-}  // namespace
+// All EPSG projected and geodetic CRS sorted by code, without the projected bounds
+using EPSGTable = std::vector<EPSG>;
 
-// Is the EPSG code valid?
-bool isValid(int code)
-{
-  return !!getInfo(code);
-}
+// ----------------------------------------------------------------------
+/*!
+ * \brief Read the EPSG table from the PROJ database with a single query
+ *
+ * A projected CRS takes precedence over a geodetic one with the same code,
+ * and of several usages the one with the largest valid area is chosen.
+ */
+// ----------------------------------------------------------------------
 
-// Get all EPSG information
-std::optional<EPSG> getInfo(int code)
+EPSGTable read_table()
 {
-  // Get EPSG information from the cache, getting the information from PROJ first if necessary
-  const auto& obj = g_epsg_cache.find(code);
-  if (obj)
-    return obj;
-
-  auto db_context = NS_PROJ::io::DatabaseContext::create().as_nullable();
-  auto* sqlite_handle = reinterpret_cast<sqlite3*>(db_context->getSqliteHandle());
-  auto projdb = sqlite3pp::ext::borrow(sqlite_handle);
-
-  // At least these tables have commonly needed extent information
-  const std::vector<std::string> tables = {"projected_crs", "geodetic_crs"};
-  std::optional<EPSG> ret;
-
-  for (const auto& object_table_name : tables)
+  try
   {
-    std::string sql = fmt::format(
+    auto db_context = NS_PROJ::io::DatabaseContext::create().as_nullable();
+    auto* sqlite_handle = reinterpret_cast<sqlite3*>(db_context->getSqliteHandle());
+    auto projdb = sqlite3pp::ext::borrow(sqlite_handle);
+
+    // At least these tables have commonly needed extent information
+    const char* sql =
         "select usage.object_code, "
         "extent.west_lon, extent.east_lon, extent.south_lat, extent.north_lat, "
-        "{1}.name, scope.scope, {1}.deprecated "
-        "from {1},extent,scope,usage "
+        "crs.name, scope.scope, crs.deprecated, crs.geodetic "
+        "from (select code, name, deprecated, 0 as geodetic, 'projected_crs' as table_name "
+        "from projected_crs where auth_name='EPSG' "
+        "union all "
+        "select code, name, deprecated, 1 as geodetic, 'geodetic_crs' as table_name "
+        "from geodetic_crs where auth_name='EPSG') as crs, "
+        "extent,scope,usage "
         "where extent.code=usage.extent_code "
         "and scope.code=usage.scope_code "
-        "and {1}.code=usage.object_code "
+        "and crs.code=usage.object_code "
         "and usage.object_auth_name='EPSG' "
-        "and usage.object_table_name='{1}' "
-        "and {1}.auth_name='EPSG' "
+        "and usage.object_table_name=crs.table_name "
         "and scope.auth_name='EPSG' "
-        "and extent.auth_name='EPSG' "
-        "and usage.object_code='{0}'",
-        code,
-        object_table_name);
-
-    bool geodetic = (object_table_name == "geodetic_crs");
+        "and extent.auth_name='EPSG'";
 
-    sqlite3pp::query qry(projdb, sql.c_str());
+    sqlite3pp::query qry(projdb, sql);
 
-    // Look for the largest valid area
+    EPSGTable table;
     for (const auto& row : qry)
     {
       EPSG epsg;
@@ -87,22 +83,88 @@ std::optional<EPSG> getInfo(int code)
       epsg.name = row.get<std::string>(5);
       epsg.scope = row.get<std::string>(6);
       epsg.deprecated = row.get<bool>(7);
-      epsg.geodetic = geodetic;
+      epsg.geodetic = row.get<bool>(8);
 
       // If longitude_east < longitude_west, add 360.0 to logitude_east
       if (epsg.bbox.east < epsg.bbox.west)
         epsg.bbox.east += 360.0;
 
-      if (!ret || area(epsg.bbox) > area(ret->bbox))
-        ret = epsg;
+      table.push_back(std::move(epsg));
     }
 
-    if (ret)
-      break;
+    // Sort the preferred usage of each code first and drop the rest
+    std::stable_sort(table.begin(),
+                     table.end(),
+                     [](const EPSG& a, const EPSG& b)
+                     {
+                       if (a.number != b.number)
+                         return a.number < b.number;
+                       if (a.geodetic != b.geodetic)
+                         return !a.geodetic;
+                       return area(a.bbox) > area(b.bbox);
+                     });
+
+    auto last = std::unique(table.begin(),
+                            table.end(),
+                            [](const EPSG& a, const EPSG& b) { return a.number == b.number; });
+    table.erase(last, table.end());
+    table.shrink_to_fit();
+
+    return table;
   }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Failed to read the EPSG table from the PROJ database");
+  }
+}
+
+// The table is read on first use. If reading fails, the next call tries again.
+const EPSGTable& get_table()
+{
+  static const EPSGTable table = read_table();
+  return table;
+}
+
+// Binary search for the code, nullptr if it is not valid
+const EPSG* find(int code)
+{
+  const auto& table = get_table();
+  auto pos = std::lower_bound(table.begin(),
+                              table.end(),
+                              code,
+                              [](const EPSG& epsg, int value) { return epsg.number < value; });
+  if (pos == table.end() || pos->number != code)
+    return nullptr;
+  return &*pos;
+}
+
+}  // namespace
+
+// Read the EPSG table now instead of on first use
+void preload()
+{
+  get_table();
+}
+
+// Is the EPSG code valid?
+bool isValid(int code)
+{
+  return find(code) != nullptr;
+}
+
+// Get all EPSG information
+std::optional<EPSG> getInfo(int code)
+{
+  // Get EPSG information from the cache, calculating the projected bounds first if necessary
+  const auto& obj = g_epsg_cache.find(code);
+  if (obj)
+    return obj;
+
+  const auto* epsg = find(code);
+  if (epsg == nullptr)
+    return {};
 
-  if (!ret)
-    return ret;
+  std::optional<EPSG> ret = *epsg;
 
   // Calculate projected bounds
 
@@ -26,6 +26,10 @@ struct EPSG
 bool isValid(int code);                 // Is the EPSG code valid?
 std::optional<EPSG> getInfo(int code);  // Get all EPSG information
 
+// The EPSG table is read from the PROJ database on first use, the projected bounds are
+// calculated on demand and cached. Call preload to read the table at startup.
+void preload();
+
 void setCacheSize(std::size_t newMaxSize);
 Cache::CacheStats getCacheStats();
 
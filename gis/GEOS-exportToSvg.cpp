@@ -1,10 +1,10 @@
 #include "GEOS.h"
+#include "NumberFormat.h"
+#include "OutputSink.h"
 
 // GEOS does not seem to include <memory> as it should for Point.h
 #include <memory>
 
-#include <fmt/format.h>
-#include <fmt/printf.h>
 #include <geos/geom/Coordinate.h>
 #include <geos/geom/CoordinateSequence.h>
 #include <geos/geom/LineString.h>
@@ -17,11 +17,14 @@
 #include <geos/geom/PrecisionModel.h>
 #include <geos/version.h>
 #include <macgyver/Exception.h>
-#include <macgyver/NumericCast.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 #define GEOS_VERSION_ID (100 * GEOS_VERSION_MAJOR + GEOS_VERSION_MINOR)
 
 // using geos::geom::Coordinate;
+using geos::geom::CoordinateSequence;
 using geos::geom::Geometry;
 using geos::geom::GeometryCollection;
 using geos::geom::LinearRing;
@@ -42,52 +45,86 @@ namespace
 {
 // ----------------------------------------------------------------------
 /*!
- * \brief Pretty print a number
+ * \brief GEOS to SVG path writer
+ *
+ * The coordinates of each linestring are copied out of the coordinate
+ * sequence in bulk and formatted with Fmi::NumberFormat directly into
+ * blocks reserved from the sink, the same way as in the OGR writer.
+ * Unlike in the OGR writer the coordinates are not transformed and
+ * duplicate vertices are not skipped.
  */
 // ----------------------------------------------------------------------
 
-std::string pretty(double num, const char* format)
+class SvgWriter
 {
-  try
+ public:
+  SvgWriter(Fmi::OutputSink& theSink, int theDecimals)
+      : m_cursor(theSink), m_decimals(std::max(theDecimals, 0))
   {
-    if (strcmp(format, "%.0f") == 0)
-      return fmt::sprintf("%d", static_cast<long>(round(num)));
+  }
 
-    std::string ret = fmt::sprintf(format, num);
-    std::size_t pos = ret.size();
-    while (pos > 0 && ret[pos - 1] == '0')
-      --pos;
+  void write(const Geometry& theGeom);
+
+ private:
+  void writeGeometry(const Geometry* geom);
+  void writePoint(const Coordinate* geom);
+  void writeLinearRing(const LinearRing* geom);
+  void writeLineString(const LineString* geom);
+  void writePolygon(const Polygon* geom);
+  void writeMultiPoint(const MultiPoint* geom);
+  void writeMultiLineString(const MultiLineString* geom);
+  void writeMultiPolygon(const MultiPolygon* geom);
+  void writeGeometryCollection(const GeometryCollection* geom);
+
+  void load(const CoordinateSequence* coords);
+  void writeVertices(char command, std::size_t first, std::size_t last);
+
+  // Like printf, but integral values are written without the decimal point and decimals
+  // and -0 as 0. Other values keep all the decimals, including trailing zeros.
+  char* number(char* p, double value) const
+  {
+    char* end = (m_decimals <= 16 ? Fmi::NumberFormat::writeRounded(p, value, m_decimals)
+                                  : Fmi::NumberFormat::writeDouble(p, value, m_decimals));
+    const auto* dot = static_cast<const char*>(std::memchr(p, '.', end - p));
+    if (dot == nullptr)
+      return end;
+    const auto decimals = end - dot - 1;
+    if (decimals < m_decimals)
+    {
+      std::memset(end, '0', m_decimals - decimals);
+      end += m_decimals - decimals;
+    }
+    return end;
+  }
 
-    if (pos == 0 || (ret[pos - 1] != ',' && ret[pos - 1] != '.'))
-      return ret;
+  Fmi::OutputCursor m_cursor;
+  int m_decimals;
 
-    ret.resize(pos - 1);
+  std::vector<double> m_x;  // coordinates of the current linestring
+  std::vector<double> m_y;
+#if GEOS_VERSION_ID >= 308 && GEOS_VERSION_ID < 312
+  std::vector<Coordinate> m_coords;
+#endif
+};
 
-    if (ret != "-0")
-      return ret;
-    return "0";
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
-}
+// Space needed for a vertex and its command or separator
+const std::size_t max_vertex_length = 2 * Fmi::NumberFormat::MaxDoubleLength + 2;
 
-// Needed since two functions call each other
-void writeSVG(std::string& out, const Geometry* geom, const char* format);
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle a coordinate
+ * \brief Write the geometry as a SVG path
  */
 // ----------------------------------------------------------------------
 
-void writeCoordinateSVG(std::string& out, const Coordinate& geom, const char* format)
+void SvgWriter::write(const Geometry& theGeom)
 {
   try
   {
-    out += pretty(geom.x, format);
-    out += ' ';
-    out += pretty(geom.y, format);
+    // Sign, 7 integer digits, decimal point and decimals per coordinate plus separators
+    const auto bytes = 2 * (static_cast<std::size_t>(std::min(m_decimals, 16)) + 10);
+    m_cursor.expect(bytes * theGeom.getNumPoints() + 1);
+    writeGeometry(&theGeom);
+    m_cursor.finish();
   }
   catch (...)
   {
@@ -97,92 +134,127 @@ void writeCoordinateSVG(std::string& out, const Coordinate& geom, const char* fo
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle a Point
+ * \brief Copy the coordinates of a linestring in bulk
+ *
+ * Since GEOS 3.12 the coordinates are stored contiguously and getX/getY
+ * are inline reads, older versions are copied with a single virtual call
+ * where available.
  */
 // ----------------------------------------------------------------------
 
-void writePointSVG(std::string& out, const Coordinate* geom, const char* format)
+void SvgWriter::load(const CoordinateSequence* coords)
 {
-  try
+  const std::size_t n = coords->size();
+  m_x.resize(n);
+  m_y.resize(n);
+#if GEOS_VERSION_ID >= 312
+  for (std::size_t i = 0; i < n; ++i)
   {
-    if (geom != nullptr)
-    {
-      out += 'M';
-      out += pretty(geom->x, format);
-      out += ' ';
-      out += pretty(geom->y, format);
-    }
+    m_x[i] = coords->getX(i);
+    m_y[i] = coords->getY(i);
   }
-  catch (...)
+#elif GEOS_VERSION_ID >= 308
+  coords->toVector(m_coords);
+  for (std::size_t i = 0; i < n; ++i)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    m_x[i] = m_coords[i].x;
+    m_y[i] = m_coords[i].y;
+  }
+#else
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto& c = coords->getAt(i);
+    m_x[i] = c.x;
+    m_y[i] = c.y;
   }
+#endif
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle LinearRing
+ * \brief Write vertices first...last-1 of the current linestring
+ *
+ * The first vertex is preceded by the given command, the rest by a space
+ * since lineto is implicit.
  */
 // ----------------------------------------------------------------------
 
-void writeLinearRingSVG(std::string& out, const LinearRing* geom, const char* format)
+void SvgWriter::writeVertices(char command, std::size_t first, std::size_t last)
 {
-  try
+  for (std::size_t i = first; i < last; ++i)
   {
-    if (geom == nullptr || geom->isEmpty())
-      return;
-    // Bizarre: n is unsigned long but getting coordinate uses int
-    for (unsigned long i = 0, n = geom->getNumPoints(); i < n - 1; ++i)
-    {
-      if (i == 0)
-        out += 'M';
-      else
-        out += ' ';  // No need to write an 'L', lineto is implicit for i>0
-      writeCoordinateSVG(out, geom->getCoordinateN(Fmi::numeric_cast<int>(i)), format);
-    }
-    out += 'Z';
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    char* p = m_cursor.reserve(max_vertex_length);
+    *p++ = (i == first ? command : ' ');
+    p = number(p, m_x[i]);
+    *p++ = ' ';
+    p = number(p, m_y[i]);
+    m_cursor.advance(p);
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Handle a Point
+ */
+// ----------------------------------------------------------------------
+
+void SvgWriter::writePoint(const Coordinate* geom)
+{
+  if (geom == nullptr)
+    return;
+
+  char* p = m_cursor.reserve(max_vertex_length);
+  *p++ = 'M';
+  p = number(p, geom->x);
+  *p++ = ' ';
+  p = number(p, geom->y);
+  m_cursor.advance(p);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Handle LinearRing
+ *
+ * The closing vertex is replaced by Z.
+ */
+// ----------------------------------------------------------------------
+
+void SvgWriter::writeLinearRing(const LinearRing* geom)
+{
+  if (geom == nullptr || geom->isEmpty())
+    return;
+
+  load(geom->getCoordinatesRO());
+  writeVertices('M', 0, m_x.size() - 1);
+
+  char* p = m_cursor.reserve(1);
+  *p++ = 'Z';
+  m_cursor.advance(p);
+}
+
 // ----------------------------------------------------------------------
 /*!
  * \brief Handle LineString
  */
 // ----------------------------------------------------------------------
 
-void writeLineStringSVG(std::string& out, const LineString* geom, const char* format)
+void SvgWriter::writeLineString(const LineString* geom)
 {
-  try
-  {
-    if (geom == nullptr || geom->isEmpty())
-      return;
+  if (geom == nullptr || geom->isEmpty())
+    return;
 
-    unsigned long n = geom->getNumPoints();
-    for (unsigned long i = 0; i < n - 1; ++i)
-    {
-      if (i == 0)
-        out += 'M';
-      else
-        out += ' ';  // No need to write an 'L', lineto is implicit for i>0
-      writeCoordinateSVG(out, geom->getCoordinateN(Fmi::numeric_cast<int>(i)), format);
-    }
+  load(geom->getCoordinatesRO());
+  const std::size_t n = m_x.size();
 
-    if (geom->isClosed())
-      out += 'Z';
-    else
-    {
-      out += (n == 1 ? 'M' : ' ');
-      writeCoordinateSVG(out, geom->getCoordinateN(Fmi::numeric_cast<int>(n - 1)), format);
-    }
-  }
-  catch (...)
+  if (geom->isClosed())
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    writeVertices('M', 0, n - 1);
+    char* p = m_cursor.reserve(1);
+    *p++ = 'Z';
+    m_cursor.advance(p);
   }
+  else
+    writeVertices('M', 0, n);
 }
 
 // ----------------------------------------------------------------------
@@ -191,23 +263,14 @@ void writeLineStringSVG(std::string& out, const LineString* geom, const char* fo
  */
 // ----------------------------------------------------------------------
 
-void writePolygonSVG(std::string& out, const Polygon* geom, const char* format)
+void SvgWriter::writePolygon(const Polygon* geom)
 {
-  try
-  {
-    if (geom == nullptr || geom->isEmpty())
-      return;
+  if (geom == nullptr || geom->isEmpty())
+    return;
 
-    writeLineStringSVG(out, geom->getExteriorRing(), format);
-    for (size_t i = 0, n = geom->getNumInteriorRing(); i < n; ++i)
-    {
-      writeLineStringSVG(out, geom->getInteriorRingN(i), format);
-    }
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  writeLineString(geom->getExteriorRing());
+  for (size_t i = 0, n = geom->getNumInteriorRing(); i < n; ++i)
+    writeLineString(geom->getInteriorRingN(i));
 }
 
 // ----------------------------------------------------------------------
@@ -216,23 +279,13 @@ void writePolygonSVG(std::string& out, const Polygon* geom, const char* format)
  */
 // ----------------------------------------------------------------------
 
-void writeMultiPointSVG(std::string& out, const MultiPoint* geom, const char* format)
+void SvgWriter::writeMultiPoint(const MultiPoint* geom)
 {
-  try
-  {
-    if (geom == nullptr || geom->isEmpty())
-      return;
+  if (geom == nullptr || geom->isEmpty())
+    return;
 
-    for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
-    {
-      out += 'M';
-      writeCoordinateSVG(out, *geom->getGeometryN(i)->getCoordinate(), format);
-    }
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
+    writePoint(geom->getGeometryN(i)->getCoordinate());
 }
 
 // ----------------------------------------------------------------------
@@ -241,19 +294,12 @@ void writeMultiPointSVG(std::string& out, const MultiPoint* geom, const char* fo
  */
 // ----------------------------------------------------------------------
 
-void writeMultiLineStringSVG(std::string& out, const MultiLineString* geom, const char* format)
+void SvgWriter::writeMultiLineString(const MultiLineString* geom)
 {
-  try
-  {
-    if (geom == nullptr || geom->isEmpty())
-      return;
-    for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
-      writeLineStringSVG(out, dynamic_cast<const LineString*>(geom->getGeometryN(i)), format);
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  if (geom == nullptr || geom->isEmpty())
+    return;
+  for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
+    writeLineString(dynamic_cast<const LineString*>(geom->getGeometryN(i)));
 }
 
 // ----------------------------------------------------------------------
@@ -262,19 +308,12 @@ void writeMultiLineStringSVG(std::string& out, const MultiLineString* geom, cons
  */
 // ----------------------------------------------------------------------
 
-void writeMultiPolygonSVG(std::string& out, const MultiPolygon* geom, const char* format)
+void SvgWriter::writeMultiPolygon(const MultiPolygon* geom)
 {
-  try
-  {
-    if (geom == nullptr || geom->isEmpty())
-      return;
-    for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
-      writePolygonSVG(out, dynamic_cast<const Polygon*>(geom->getGeometryN(i)), format);
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  if (geom == nullptr || geom->isEmpty())
+    return;
+  for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
+    writePolygon(dynamic_cast<const Polygon*>(geom->getGeometryN(i)));
 }
 
 // ----------------------------------------------------------------------
@@ -283,52 +322,43 @@ void writeMultiPolygonSVG(std::string& out, const MultiPolygon* geom, const char
  */
 // ----------------------------------------------------------------------
 
-void writeGeometryCollectionSVG(std::string& out,
-                                const GeometryCollection* geom,
-                                const char* format)
+void SvgWriter::writeGeometryCollection(const GeometryCollection* geom)
 {
-  try
-  {
-    if (geom == nullptr || geom->isEmpty())
-      return;
-    for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
-      writeSVG(out, geom->getGeometryN(i), format);
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  if (geom == nullptr || geom->isEmpty())
+    return;
+  for (size_t i = 0, n = geom->getNumGeometries(); i < n; ++i)
+    writeGeometry(geom->getGeometryN(i));
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Write the geometry as a SVG path
+ * \brief Handle a single geometry component
  *
  * This could be more efficiently done if the geometries supported
  * a visitor.
  */
 // ----------------------------------------------------------------------
 
-void writeSVG(std::string& out, const Geometry* geom, const char* format)
+void SvgWriter::writeGeometry(const Geometry* geom)
 {
   try
   {
     if (const auto* point = dynamic_cast<const Point*>(geom))
-      writePointSVG(out, point->getCoordinate(), format);
+      writePoint(point->getCoordinate());
     else if (const auto* lr = dynamic_cast<const LinearRing*>(geom))
-      writeLinearRingSVG(out, lr, format);
+      writeLinearRing(lr);
     else if (const auto* ls = dynamic_cast<const LineString*>(geom))
-      writeLineStringSVG(out, ls, format);
+      writeLineString(ls);
     else if (const auto* p = dynamic_cast<const Polygon*>(geom))
-      writePolygonSVG(out, p, format);
+      writePolygon(p);
     else if (const auto* mp = dynamic_cast<const MultiPoint*>(geom))
-      writeMultiPointSVG(out, mp, format);
+      writeMultiPoint(mp);
     else if (const auto* ml = dynamic_cast<const MultiLineString*>(geom))
-      writeMultiLineStringSVG(out, ml, format);
+      writeMultiLineString(ml);
     else if (const auto* mpg = dynamic_cast<const MultiPolygon*>(geom))
-      writeMultiPolygonSVG(out, mpg, format);
+      writeMultiPolygon(mpg);
     else if (const auto* g = dynamic_cast<const GeometryCollection*>(geom))
-      writeGeometryCollectionSVG(out, g, format);
+      writeGeometryCollection(g);
     else
       throw Fmi::Exception::Trace(BCP, "Encountered an unsupported GEOS geometry component");
   }
@@ -342,11 +372,11 @@ void writeSVG(std::string& out, const Geometry* geom, const char* format)
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Convert the geometry to a SVG string
+ * \brief Stream the geometry as a SVG path into a sink
  */
 // ----------------------------------------------------------------------
 
-std::string Fmi::GEOS::exportToSvg(const Geometry& theGeom, int thePrecision)
+void Fmi::GEOS::exportToSvg(OutputSink& theSink, const Geometry& theGeom, int thePrecision)
 {
   try
   {
@@ -357,10 +387,28 @@ std::string Fmi::GEOS::exportToSvg(const Geometry& theGeom, int thePrecision)
     int decimals = (thePrecision < 0 ? theGeom.getPrecisionModel()->getMaximumSignificantDigits()
                                      : thePrecision);
 
-    std::string format = "%." + fmt::sprintf("%d", decimals) + "f";
+    SvgWriter writer(theSink, decimals);
+    writer.write(theGeom);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Convert the geometry to a SVG string
+ */
+// ----------------------------------------------------------------------
+
+std::string Fmi::GEOS::exportToSvg(const Geometry& theGeom, int thePrecision)
+{
+  try
+  {
     std::string out;
-    writeSVG(out, &theGeom, format.c_str());
+    BufferSink<std::string> sink(out);
+    exportToSvg(sink, theGeom, thePrecision);
     return out;
   }
   catch (...)
@@ -12,11 +12,14 @@ class Geometry;
 
 namespace Fmi
 {
+class OutputSink;
+
 namespace GEOS
 {
 std::string exportToWkb(const geos::geom::Geometry& theGeom);
 
 std::string exportToSvg(const geos::geom::Geometry& theGeom, int thePrecision = -1);
+void exportToSvg(OutputSink& theSink, const geos::geom::Geometry& theGeom, int thePrecision = -1);
 
 }  // namespace GEOS
 }  // namespace Fmi
@@ -0,0 +1,374 @@
+#include "Geodesy.h"
+#include <boost/math/constants/constants.hpp>
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <cmath>
+#include <ogr_geometry.h>
+#include <vector>
+
+namespace Fmi
+{
+namespace Geodesy
+{
+namespace
+{
+constexpr double degree = boost::math::double_constants::degree;
+
+// Metres per degree of latitude, the same approximation qdless uses
+constexpr double MetresPerDegree = 111320.0;
+
+// Length of a parallel at the equator for pole traversals
+constexpr double EarthCircumference = 40075.0 * 1000;
+
+// WGS84 flattening and derived constants for the authalic sphere
+constexpr double Flattening = 1.0 / 298.257223563;
+constexpr double E2 = Flattening * (2.0 - Flattening);
+
+const double E = std::sqrt(E2);
+
+// q-function of the authalic latitude
+double authalic_q(double sinphi)
+{
+  const double esinphi = E * sinphi;
+  return (1.0 - E2) * (sinphi / (1.0 - esinphi * esinphi) -
+                       0.5 / E * std::log((1.0 - esinphi) / (1.0 + esinphi)));
+}
+
+const double QPole = authalic_q(1.0);
+const double AuthalicRadius2 = EarthRadius * EarthRadius * QPole / 2.0;
+
+// Copy the coordinates of a curve into contiguous arrays
+void extract(const OGRSimpleCurve& theCurve,
+             std::vector<double>& theLon,
+             std::vector<double>& theLat)
+{
+  const int n = theCurve.getNumPoints();
+  theLon.resize(n);
+  theLat.resize(n);
+  if (n > 0)
+    theCurve.getPoints(theLon.data(), sizeof(double), theLat.data(), sizeof(double));
+}
+
+// Green's theorem for sin(latitude) values, without the radius factor
+double ring_area(const double* theLon, const double* theSin, std::size_t theCount)
+{
+  double area = 0;
+  for (std::size_t i = 0; i + 1 < theCount; i++)
+    area += (theLon[i + 1] - theLon[i]) * (2.0 + theSin[i] + theSin[i + 1]);
+  return std::abs(area) * degree / 2.0;
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Area of a closed ring on the sphere
+ *
+ * Each vertex contributes sin(latitude) to both adjacent edges, hence the
+ * sines are computed once into a buffer before the summation.
+ */
+// ----------------------------------------------------------------------
+
+double sphericalArea(const double* theLon, const double* theLat, std::size_t theCount)
+{
+  try
+  {
+    if (theCount < 2)
+      return 0;
+
+    std::vector<double> sines(theCount);
+    for (std::size_t i = 0; i < theCount; i++)
+      sines[i] = std::sin(theLat[i] * degree);
+
+    return EarthRadius * EarthRadius * ring_area(theLon, sines.data(), theCount);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+double sphericalArea(const OGRSimpleCurve& theRing)
+{
+  try
+  {
+    std::vector<double> lon;
+    std::vector<double> lat;
+    extract(theRing, lon, lat);
+    return sphericalArea(lon.data(), lat.data(), lon.size());
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Area of a closed ring on the WGS84 ellipsoid
+ *
+ * The sine of the authalic latitude is q(phi)/q(90), no inverse
+ * trigonometry is needed.
+ */
+// ----------------------------------------------------------------------
+
+double ellipsoidalArea(const double* theLon, const double* theLat, std::size_t theCount)
+{
+  try
+  {
+    if (theCount < 2)
+      return 0;
+
+    std::vector<double> sines(theCount);
+    for (std::size_t i = 0; i < theCount; i++)
+      sines[i] = authalic_q(std::sin(theLat[i] * degree)) / QPole;
+
+    return AuthalicRadius2 * ring_area(theLon, sines.data(), theCount);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+double ellipsoidalArea(const OGRSimpleCurve& theRing)
+{
+  try
+  {
+    std::vector<double> lon;
+    std::vector<double> lat;
+    extract(theRing, lon, lat);
+    return ellipsoidalArea(lon.data(), lat.data(), lon.size());
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Great circle length using the haversine formula
+ */
+// ----------------------------------------------------------------------
+
+double sphericalLength(const double* theLon, const double* theLat, std::size_t theCount)
+{
+  try
+  {
+    if (theCount < 2)
+      return 0;
+
+    std::vector<double> cosines(theCount);
+    for (std::size_t i = 0; i < theCount; i++)
+      cosines[i] = std::cos(theLat[i] * degree);
+
+    double total = 0;
+    for (std::size_t i = 0; i + 1 < theCount; i++)
+    {
+      const double sdlat2 = std::sin(0.5 * (theLat[i + 1] - theLat[i]) * degree);
+      const double sdlon2 = std::sin(0.5 * (theLon[i + 1] - theLon[i]) * degree);
+      const double a = sdlat2 * sdlat2 + cosines[i] * cosines[i + 1] * sdlon2 * sdlon2;
+      total += std::asin(std::min(1.0, std::sqrt(a)));
+    }
+    return 2.0 * EarthRadius * total;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+double sphericalLength(const OGRSimpleCurve& theLine)
+{
+  try
+  {
+    std::vector<double> lon;
+    std::vector<double> lat;
+    extract(theLine, lon, lat);
+    return sphericalLength(lon.data(), lat.data(), lon.size());
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Great circle distances between point pairs
+ */
+// ----------------------------------------------------------------------
+
+void haversine(const double* theLon1,
+               const double* theLat1,
+               const double* theLon2,
+               const double* theLat2,
+               double* theResult,
+               std::size_t theCount)
+{
+  try
+  {
+    for (std::size_t i = 0; i < theCount; i++)
+    {
+      const double sdlat2 = std::sin(0.5 * (theLat2[i] - theLat1[i]) * degree);
+      const double sdlon2 = std::sin(0.5 * (theLon2[i] - theLon1[i]) * degree);
+      const double a = sdlat2 * sdlat2 + std::cos(theLat1[i] * degree) *
+                                             std::cos(theLat2[i] * degree) * sdlon2 * sdlon2;
+      theResult[i] = 2.0 * EarthRadius * std::asin(std::min(1.0, std::sqrt(a)));
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Initial great circle bearings between point pairs
+ */
+// ----------------------------------------------------------------------
+
+void azimuth(const double* theLon1,
+             const double* theLat1,
+             const double* theLon2,
+             const double* theLat2,
+             double* theResult,
+             std::size_t theCount)
+{
+  try
+  {
+    for (std::size_t i = 0; i < theCount; i++)
+    {
+      const double dlon = (theLon2[i] - theLon1[i]) * degree;
+      const double sinlat1 = std::sin(theLat1[i] * degree);
+      const double coslat1 = std::cos(theLat1[i] * degree);
+      const double sinlat2 = std::sin(theLat2[i] * degree);
+      const double coslat2 = std::cos(theLat2[i] * degree);
+      const double y = std::sin(dlon) * coslat2;
+      const double x = coslat1 * sinlat2 - sinlat1 * coslat2 * std::cos(dlon);
+      const double angle = std::atan2(y, x) / degree;
+      theResult[i] = (angle < 0 ? angle + 360.0 : angle);
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Equirectangular distance approximation
+ */
+// ----------------------------------------------------------------------
+
+double approximateDistance(double theLon1, double theLat1, double theLon2, double theLat2)
+{
+  const double phi = 0.5 * (theLat1 + theLat2) * degree;
+  const double dx = (theLon2 - theLon1) * (MetresPerDegree * std::cos(phi));
+  const double dy = (theLat2 - theLat1) * MetresPerDegree;
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Densify linearly in longitude/latitude
+ *
+ * The output is collected into arrays and set in one go instead of
+ * growing the linestring point by point.
+ */
+// ----------------------------------------------------------------------
+
+void densify(OGRLineString& theLine, double theMaxLength)
+{
+  try
+  {
+    const int n = theLine.getNumPoints();
+    if (n < 2 || theMaxLength <= 0)
+      return;
+
+    std::vector<double> lon;
+    std::vector<double> lat;
+    extract(theLine, lon, lat);
+
+    // Z and M values are interpolated linearly too
+    const bool has_z = (theLine.Is3D() != 0);
+    const bool has_m = (theLine.IsMeasured() != 0);
+    std::vector<double> z(has_z ? n : 0);
+    std::vector<double> m(has_m ? n : 0);
+    for (int i = 0; i < n; ++i)
+    {
+      if (has_z)
+        z[i] = theLine.getZ(i);
+      if (has_m)
+        m[i] = theLine.getM(i);
+    }
+
+    std::vector<double> outlon;
+    std::vector<double> outlat;
+    std::vector<double> outz;
+    std::vector<double> outm;
+    outlon.reserve(n);
+    outlat.reserve(n);
+
+    for (int i = 0; i < n - 1; ++i)
+    {
+      const double lon0 = lon[i];
+      const double lat0 = lat[i];
+      const double lon1 = lon[i + 1];
+      const double lat1 = lat[i + 1];
+
+      outlon.push_back(lon0);
+      outlat.push_back(lat0);
+      if (has_z)
+        outz.push_back(z[i]);
+      if (has_m)
+        outm.push_back(m[i]);
+
+      double d = 0;
+      if (std::abs(lat0) == 90 && lat0 == lat1)
+        d = std::abs(lon1 - lon0) / 360.0 * EarthCircumference;  // pole traversal
+      else
+        d = approximateDistance(lon0, lat0, lon1, lat1);
+
+      if (d <= theMaxLength)
+        continue;
+
+      const int nseg = static_cast<int>(std::ceil(d / theMaxLength));
+      for (int s = 1; s < nseg; ++s)
+      {
+        const double t = static_cast<double>(s) / static_cast<double>(nseg);
+        outlon.push_back(lon0 + t * (lon1 - lon0));
+        outlat.push_back(lat0 + t * (lat1 - lat0));
+        if (has_z)
+          outz.push_back(z[i] + t * (z[i + 1] - z[i]));
+        if (has_m)
+          outm.push_back(m[i] + t * (m[i + 1] - m[i]));
+      }
+    }
+
+    if (outlon.size() + 1 == static_cast<std::size_t>(n))
+      return;  // nothing was added
+
+    outlon.push_back(lon[n - 1]);
+    outlat.push_back(lat[n - 1]);
+    if (has_z)
+      outz.push_back(z[n - 1]);
+    if (has_m)
+      outm.push_back(m[n - 1]);
+    theLine.setPoints(static_cast<int>(outlon.size()),
+                      outlon.data(),
+                      outlat.data(),
+                      has_z ? outz.data() : nullptr,
+                      has_m ? outm.data() : nullptr);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace Geodesy
+}  // namespace Fmi
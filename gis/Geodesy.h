@@ -0,0 +1,68 @@
+// ======================================================================
+/*!
+ * \brief Measurement kernels for geographic coordinates
+ *
+ * Areas, lengths and distances for longitude/latitude coordinates in
+ * degrees. The kernels work on raw coordinate arrays so that the
+ * trigonometry for each vertex is evaluated only once instead of once
+ * per adjacent edge. The OGR overloads copy the coordinates out in bulk
+ * before calling the kernels.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cstddef>
+
+class OGRLineString;
+class OGRSimpleCurve;
+
+namespace Fmi
+{
+namespace Geodesy
+{
+// WGS84 semi-major axis, used as the radius of the sphere
+constexpr double EarthRadius = 6378137.0;
+
+// Absolute area of a closed ring on the sphere in m^2
+double sphericalArea(const double* theLon, const double* theLat, std::size_t theCount);
+double sphericalArea(const OGRSimpleCurve& theRing);
+
+// Absolute area of a closed ring on the WGS84 ellipsoid in m^2. The ring is mapped
+// to the authalic sphere, which preserves areas, hence the only error comes from
+// treating the edges as straight lines in longitude/latitude.
+double ellipsoidalArea(const double* theLon, const double* theLat, std::size_t theCount);
+double ellipsoidalArea(const OGRSimpleCurve& theRing);
+
+// Great circle length of a linestring on the sphere in m
+double sphericalLength(const double* theLon, const double* theLat, std::size_t theCount);
+double sphericalLength(const OGRSimpleCurve& theLine);
+
+// Great circle distances in m between point pairs: theResult[i] = |p1[i]-p2[i]|
+void haversine(const double* theLon1,
+               const double* theLat1,
+               const double* theLon2,
+               const double* theLat2,
+               double* theResult,
+               std::size_t theCount);
+
+// Initial great circle bearings in degrees clockwise from north in the range [0,360)
+// from p1[i] towards p2[i]. Coincident points have bearing 0.
+void azimuth(const double* theLon1,
+             const double* theLat1,
+             const double* theLon2,
+             const double* theLat2,
+             double* theResult,
+             std::size_t theCount);
+
+// Equirectangular approximation of a distance in m (111.32 km per degree, longitudes
+// scaled by the cosine of the mean latitude). Fast and accurate for short segments.
+double approximateDistance(double theLon1, double theLat1, double theLon2, double theLat2);
+
+// Add points linearly in longitude/latitude so that no segment is longer than the
+// given limit in metres according to approximateDistance. Segments along a pole are
+// measured along the parallel. Z and M values are interpolated linearly.
+void densify(OGRLineString& theLine, double theMaxLength);
+
+}  // namespace Geodesy
+}  // namespace Fmi
@@ -1,4 +1,6 @@
 #include "GeometryAmalgamator.h"
+#include "Geodesy.h"
+#include "Parallel.h"
 #include "VertexCounter.h"
 #include <ankerl/unordered_dense.h>
 #include <boost/geometry.hpp>
@@ -8,6 +10,7 @@
 #include <algorithm>
 #include <cmath>
 #include <map>
+#include <numeric>
 #include <ogr_geometry.h>
 #include <vector>
 
@@ -151,8 +154,7 @@ void flatten(const OGRGeometry* g, std::vector<FlatPoly>& out)
 }
 
 // Geographic area of a closed ring in m^2 (Green's theorem on the sphere).
-// Mirrors the implementation in OGR-despeckle.cpp; returns absolute value so it
-// works for both CW and CCW rings.
+// Returns the absolute value so it works for both CW and CCW rings.
 double geographic_ring_area_m2(const OGRLineString* ring)
 {
   if (ring == nullptr)
@@ -161,18 +163,7 @@ double geographic_ring_area_m2(const OGRLineString* ring)
   if (n < 4)
     return 0.0;
 
-  constexpr double deg_to_rad = M_PI / 180.0;
-  double area = 0.0;
-  for (int i = 0; i < n - 1; i++)
-  {
-    double x1 = ring->getX(i) * deg_to_rad;
-    double y1 = ring->getY(i) * deg_to_rad;
-    double x2 = ring->getX(i + 1) * deg_to_rad;
-    double y2 = ring->getY(i + 1) * deg_to_rad;
-    area += (x2 - x1) * (2 + std::sin(y1) + std::sin(y2));
-  }
-  area *= 6378137.0 * 6378137.0 / 2.0;
-  return std::abs(area);
+  return Geodesy::sphericalArea(*ring);
 }
 
 // km^2 area of a polygon, geographic if the SR is geographic, otherwise planar.
@@ -583,6 +574,46 @@ void amalgamate_cluster(const std::vector<const OGRPolygon*>& cluster,
   }
 }
 
+// A cluster waiting for triangulation
+struct ClusterJob
+{
+  std::vector<const OGRPolygon*> polygons;
+  std::size_t slot = 0;    // index of the output the results go to
+  std::size_t weight = 0;  // vertex count, the largest clusters are scheduled first
+};
+
+std::size_t vertex_count(const OGRPolygon* poly)
+{
+  std::size_t n = poly->getExteriorRing()->getNumPoints();
+  for (int i = 0, h = poly->getNumInteriorRings(); i < h; ++i)
+    n += poly->getInteriorRing(i)->getNumPoints();
+  return n;
+}
+
+// Triangulate the clusters using the given number of threads (0 = hardware concurrency),
+// largest clusters first.
+void run_jobs(const std::vector<ClusterJob>& jobs,
+              double lengthLimit,
+              double areaLimit,
+              unsigned int nthreads,
+              std::vector<std::vector<OGRGeometryPtr>>& outputs)
+{
+  std::vector<std::size_t> order(jobs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(),
+                   order.end(),
+                   [&jobs](std::size_t a, std::size_t b)
+                   { return jobs[a].weight > jobs[b].weight; });
+
+  Parallel::run(order.size(),
+                nthreads,
+                [&](std::size_t k)
+                {
+                  const auto& job = jobs[order[k]];
+                  amalgamate_cluster(job.polygons, lengthLimit, areaLimit, outputs[job.slot]);
+                });
+}
+
 }  // namespace
 
 void GeometryAmalgamator::apply(std::vector<OGRGeometryPtr>& geoms) const
@@ -687,7 +718,12 @@ void GeometryAmalgamator::apply(std::vector<OGRGeometryPtr>& geoms) const
     // downstream km^2 minarea filter cannot contribute anything that will survive that
     // filter — skipping avoids the per-cluster CDT and UnaryUnion. On dense archipelago
     // data this drops thousands of small clusters that would otherwise dominate the cost.
-    std::vector<OGRGeometryPtr> result;
+    //
+    // The multi-member clusters are independent of each other and are triangulated in
+    // parallel. Each cluster writes to its own output slot, and the slots are concatenated
+    // in the std::map order afterwards so that the result does not depend on the threads.
+    std::vector<std::vector<OGRGeometryPtr>> outputs;
+    std::vector<ClusterJob> jobs;
     for (const auto& [_, members] : clusters)
     {
       if (m_minTotalArea > 0)
@@ -699,19 +735,25 @@ void GeometryAmalgamator::apply(std::vector<OGRGeometryPtr>& geoms) const
           continue;
       }
 
+      outputs.emplace_back();
+
       if (members.size() == 1)
       {
         const auto* p = polys[members[0]].poly;
         if (m_areaLimit <= 0 || p->get_Area() >= m_areaLimit)
-          result.push_back(OGRGeometryPtr(p->clone()));
+          outputs.back().push_back(OGRGeometryPtr(p->clone()));
       }
       else
       {
-        std::vector<const OGRPolygon*> cluster_polys;
-        cluster_polys.reserve(members.size());
+        ClusterJob job;
+        job.slot = outputs.size() - 1;
+        job.polygons.reserve(members.size());
         for (auto i : members)
-          cluster_polys.push_back(polys[i].poly);
-        amalgamate_cluster(cluster_polys, m_lengthLimit, m_areaLimit, result);
+        {
+          job.polygons.push_back(polys[i].poly);
+          job.weight += vertex_count(polys[i].poly);
+        }
+        jobs.push_back(std::move(job));
       }
     }
 
@@ -726,15 +768,26 @@ void GeometryAmalgamator::apply(std::vector<OGRGeometryPtr>& geoms) const
       if (!is_mainland[i])
         continue;
       const auto* p = polys[i].poly;
+      outputs.emplace_back();
       if (m_mainlandAmalgamate)
       {
-        std::vector<const OGRPolygon*> single = {p};
-        amalgamate_cluster(single, m_lengthLimit, m_areaLimit, result);
+        ClusterJob job;
+        job.slot = outputs.size() - 1;
+        job.polygons.push_back(p);
+        job.weight = vertex_count(p);
+        jobs.push_back(std::move(job));
       }
       else if (m_areaLimit <= 0 || p->get_Area() >= m_areaLimit)
-        result.push_back(OGRGeometryPtr(p->clone()));
+        outputs.back().push_back(OGRGeometryPtr(p->clone()));
     }
 
+    run_jobs(jobs, m_lengthLimit, m_areaLimit, m_threads, outputs);
+
+    std::vector<OGRGeometryPtr> result;
+    for (auto& output : outputs)
+      for (auto& geom : output)
+        result.push_back(std::move(geom));
+
     geoms = std::move(result);
   }
   catch (...)
@@ -52,6 +52,12 @@ class GeometryAmalgamator
   // unchanged-bypass path. Has no effect unless mainlandArea() is set.
   void mainlandAmalgamate(bool flag) { m_mainlandAmalgamate = flag; }
 
+  // Number of threads used to triangulate independent clusters. Clusters are
+  // scheduled largest first and the results are gathered back in the serial
+  // order, so the output does not depend on the thread count. 1 (default)
+  // disables threading, 0 uses one thread per hardware core.
+  void threads(unsigned int n) { m_threads = n; }
+
   std::size_t hash_value() const;
   void apply(std::vector<OGRGeometryPtr>& geoms) const;
 
@@ -61,6 +67,7 @@ class GeometryAmalgamator
   double m_minTotalArea = 0;    // optional pre-CDT cluster total-area filter (km^2)
   double m_mainlandArea = 0;    // optional pre-CDT mainland-bypass threshold (km^2)
   bool m_mainlandAmalgamate = false;  // run isolated CDT on bypassed mainland
+  unsigned int m_threads = 1;         // worker threads for the cluster CDTs, 0 = automatic
 };
 
 }  // namespace Fmi
@@ -0,0 +1,160 @@
+#include "GeometryCache.h"
+#include "Box.h"
+#include <macgyver/Exception.h>
+#include <macgyver/Hash.h>
+#include <ogr_geometry.h>
+#include <string_view>
+
+namespace Fmi
+{
+namespace
+{
+// Estimated bookkeeping overhead of a single OGR geometry object in addition to its WKB size
+const std::size_t geometry_overhead = 128;
+
+// Default size is 100 MB
+const std::size_t default_cache_size = 100 * 1024 * 1024;
+
+struct ResultSize
+{
+  static std::size_t getSize(const GeometryCache::Result& theResult)
+  {
+    if (!theResult)
+      return 0;
+    return GeometryCache::byteSize(*theResult);
+  }
+};
+
+using GlobalCache = Cache::Cache<std::size_t,
+                                 GeometryCache::Result,
+                                 Cache::LRUEviction,
+                                 int,
+                                 Cache::InstantExpire,
+                                 ResultSize>;
+
+GlobalCache g_geometryCache{default_cache_size};
+
+}  // namespace
+
+namespace GeometryCache
+{
+// ----------------------------------------------------------------------
+/*!
+ * \brief Hash the WKB representation of a geometry
+ *
+ * WKB covers the geometry types, the ring structure and the exact
+ * coordinates, and is produced with a single bulk copy per ring.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t fingerprint(const OGRGeometry& theGeom)
+{
+  try
+  {
+    std::string wkb(theGeom.WkbSize(), '\0');
+    if (theGeom.exportToWkb(wkbNDR, reinterpret_cast<unsigned char*>(wkb.data())) != OGRERR_NONE)
+      throw Fmi::Exception(BCP, "Failed to export geometry to WKB for hashing");
+    return std::hash<std::string_view>()(wkb);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t fingerprint(const std::vector<OGRGeometryPtr>& theGeoms)
+{
+  try
+  {
+    auto hash = Fmi::hash_value(theGeoms.size());
+    for (const auto& geom : theGeoms)
+      Fmi::hash_combine(hash, geom ? fingerprint(*geom) : 0);
+    return hash;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t key(std::size_t theFingerprint, std::size_t theChainHash, const Box& theBox)
+{
+  auto hash = theFingerprint;
+  Fmi::hash_combine(hash, theChainHash);
+  Fmi::hash_combine(hash, theBox.hashValue());
+  return hash;
+}
+
+// Return cached result or empty shared_ptr
+Result Find(std::size_t theKey)
+{
+  try
+  {
+    const auto& obj = g_geometryCache.find(theKey);
+    if (!obj)
+      return {};
+    return *obj;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// Insert new result into the cache
+void Insert(std::size_t theKey, const Result& theResult)
+{
+  try
+  {
+    if (theResult)
+      g_geometryCache.insert(theKey, theResult);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+Result Insert(std::size_t theKey, std::vector<OGRGeometryPtr>&& theGeoms)
+{
+  try
+  {
+    auto result = std::make_shared<const std::vector<OGRGeometryPtr>>(std::move(theGeoms));
+    Insert(theKey, result);
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t byteSize(const std::vector<OGRGeometryPtr>& theGeoms)
+{
+  std::size_t bytes = sizeof(theGeoms) + theGeoms.size() * sizeof(OGRGeometryPtr);
+  for (const auto& geom : theGeoms)
+    if (geom)
+      bytes += geometry_overhead + geom->WkbSize();
+  return bytes;
+}
+
+// Resize the cache from the default
+void SetCacheSize(std::size_t newMaxSize)
+{
+  try
+  {
+    g_geometryCache.resize(newMaxSize);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+Cache::CacheStats getCacheStats()
+{
+  return g_geometryCache.statistics();
+}
+
+}  // namespace GeometryCache
+}  // namespace Fmi
@@ -0,0 +1,64 @@
+// ======================================================================
+/*!
+ * \brief Cache for the results of geometry filter chains
+ *
+ * Static layers such as coastlines and lakes are amalgamated, simplified
+ * and smoothed identically for every map rendered with the same
+ * settings. The results can be cached using a key built from a
+ * fingerprint of the input geometries, the hash values of the filters
+ * applied and the target bounding box:
+ *
+ *   auto key = GeometryCache::key(GeometryCache::fingerprint(geoms), chain, box);
+ *   auto result = GeometryCache::Find(key);
+ *   if (!result)
+ *   {
+ *     simplifier.apply(geoms, true);
+ *     smoother.apply(geoms, true);
+ *     result = GeometryCache::Insert(key, std::move(geoms));
+ *   }
+ *
+ * The cached geometries are shared between all users and must not be
+ * modified. The cache size is measured in bytes.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Types.h"
+#include <macgyver/Cache.h>
+#include <memory>
+#include <vector>
+
+namespace Fmi
+{
+class Box;
+
+namespace GeometryCache
+{
+using Result = std::shared_ptr<const std::vector<OGRGeometryPtr>>;
+
+// Hash of the coordinates and structure of the input
+std::size_t fingerprint(const OGRGeometry& theGeom);
+std::size_t fingerprint(const std::vector<OGRGeometryPtr>& theGeoms);
+
+// Combine the input fingerprint, the hash of the filter chain and the bbox into a cache key
+std::size_t key(std::size_t theFingerprint, std::size_t theChainHash, const Box& theBox);
+
+// Return cached result or empty shared_ptr
+Result Find(std::size_t theKey);
+
+// Insert new result into the cache, returns the shared result
+Result Insert(std::size_t theKey, std::vector<OGRGeometryPtr>&& theGeoms);
+void Insert(std::size_t theKey, const Result& theResult);
+
+// Approximate memory use of a result in bytes
+std::size_t byteSize(const std::vector<OGRGeometryPtr>& theGeoms);
+
+// Set the maximum size of the cache in bytes
+void SetCacheSize(std::size_t newMaxSize);
+
+// Get cache statistics
+Cache::CacheStats getCacheStats();
+
+}  // namespace GeometryCache
+}  // namespace Fmi
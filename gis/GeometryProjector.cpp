@@ -2,7 +2,9 @@
 
 #include "GeometryProjector.h"
 #include "GeometryBuilder.h"
+#include "Geodesy.h"
 #include "OGR.h"
+#include "Parallel.h"
 #include "RectClipper.h"
 #include <algorithm>
 #include <array>
@@ -12,11 +14,14 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <ogr_api.h>
 #include <ogr_geometry.h>
 #include <ogr_spatialref.h>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -29,8 +34,6 @@ namespace Fmi
 
 namespace
 {
-constexpr double kDegToRad = M_PI / 180.0;
-
 inline bool nearlyEqual(double a, double b, double tol)
 {
   return std::abs(a - b) <= tol;
@@ -54,71 +57,6 @@ inline bool pointInBounds(
   return (x >= minX - tol && x <= maxX + tol && y >= minY - tol && y <= maxY + tol);
 }
 
-// ------------------------------ geographic densification ------------------------------
-
-double metersPerDegLat(double /*phiRad*/)
-{
-  return 111320.0;
-}
-
-double metersPerDegLon(double phiRad)
-{
-  return 111320.0 * std::cos(phiRad);
-}
-
-double approxSegmentMeters(double lon0, double lat0, double lon1, double lat1)
-{
-  const double phi = 0.5 * (lat0 + lat1) * kDegToRad;
-  const double dx = (lon1 - lon0) * metersPerDegLon(phi);
-  const double dy = (lat1 - lat0) * metersPerDegLat(phi);
-  return std::sqrt(dx * dx + dy * dy);
-}
-
-// Densify in geographic CRS using km step (preserves curvature after projection)
-
-void densifyGeographicKm(OGRLineString* line, double stepKm)
-{
-  if (!line || line->getNumPoints() < 2)
-    return;
-  if (stepKm <= 0.0)
-    return;
-
-  const double stepM = stepKm * 1000.0;
-
-  OGRLineString out;
-  for (int i = 0; i < line->getNumPoints() - 1; ++i)
-  {
-    const double lon0 = line->getX(i);
-    const double lat0 = line->getY(i);
-    const double lon1 = line->getX(i + 1);
-    const double lat1 = line->getY(i + 1);
-
-    out.addPoint(lon0, lat0);
-
-    const double earth_circumference_m = 40075 * 1000;
-    double d = 0;
-    if (std::abs(lat0) == 90 && lat0 == lat1)
-      d = std::abs(lon1 - lon0) / 360.0 * earth_circumference_m;  // pole traversal
-    else
-      d = approxSegmentMeters(lon0, lat0, lon1, lat1);  // non pole traversal as non zero distance
-
-    if (d <= stepM)
-      continue;
-
-    const int nseg = static_cast<int>(std::ceil(d / stepM));
-    for (int s = 1; s < nseg; ++s)
-    {
-      const double t = static_cast<double>(s) / static_cast<double>(nseg);
-      out.addPoint(lon0 + t * (lon1 - lon0), lat0 + t * (lat1 - lat0));
-    }
-  }
-  out.addPoint(line->getX(line->getNumPoints() - 1), line->getY(line->getNumPoints() - 1));
-
-  line->empty();
-  for (int i = 0; i < out.getNumPoints(); ++i)
-    line->addPoint(out.getX(i), out.getY(i));
-}
-
 // ------------------------------ ring helpers ------------------------------
 
 // ---- boundary classification ----
@@ -490,8 +428,181 @@ std::unique_ptr<OGRLineString> ringToLineStringPreserveClosure(const OGRLinearRi
   return ls;
 }
 
+// ---- batched projection ----
+
+// Below this many vertices per thread the batch is projected in the calling thread
+const std::size_t parallel_limit = 20000;
+
+// Densified source coordinates of the points, linestrings and rings of a geometry in the
+// order the components are processed. Depends only on the densification resolution and the
+// ring closure tolerance, hence can be shared by projectors into different CRSs.
+struct DensifiedPaths
+{
+  std::vector<const OGRGeometry*> sources;           // the components the paths were made of
+  std::vector<std::unique_ptr<OGRLineString>> geos;  // densified source coordinates
+
+  void add(const OGRGeometry* theSource, std::unique_ptr<OGRLineString> theGeo)
+  {
+    sources.push_back(theSource);
+    geos.push_back(std::move(theGeo));
+  }
+};
+
+// The densified source coordinates of all components of a geometry are copied into one
+// buffer and projected with a single batched call. The components are then processed in the
+// same order they were collected.
+struct ProjectionBatch
+{
+  struct Path
+  {
+    const OGRGeometry* source = nullptr;  // the component the path was made of
+    const OGRLineString* geo = nullptr;   // densified source coordinates
+    std::size_t offset = 0;               // position of the first vertex in the buffers
+  };
+
+  std::shared_ptr<const DensifiedPaths> densified;  // owner of the paths
+  std::vector<Path> paths;
+  std::vector<double> x;  // source coordinates, projected in place
+  std::vector<double> y;
+  std::vector<int> ok;    // projection succeeded and the result is plausible
+  std::size_t next = 0;   // next path to be processed
+
+  explicit ProjectionBatch(std::shared_ptr<const DensifiedPaths> theDensified)
+      : densified(std::move(theDensified))
+  {
+    std::size_t n = 0;
+    for (const auto& geo : densified->geos)
+      n += geo->getNumPoints();
+    x.resize(n);
+    y.resize(n);
+
+    paths.resize(densified->geos.size());
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < paths.size(); i++)
+    {
+      const auto* geo = densified->geos[i].get();
+      paths[i].source = densified->sources[i];
+      paths[i].geo = geo;
+      paths[i].offset = offset;
+      if (geo->getNumPoints() > 0)
+        geo->getPoints(x.data() + offset, sizeof(double), y.data() + offset, sizeof(double));
+      offset += geo->getNumPoints();
+    }
+  }
+
+  const Path& take(const OGRGeometry* theSource)
+  {
+    if (next >= paths.size() || paths[next].source != theSource)
+      throw std::runtime_error("GeometryProjector: geometry components projected out of order");
+    return paths[next++];
+  }
+};
+
 }  // namespace
 
+// ------------------------------ densification cache ------------------------------
+
+namespace
+{
+// Gaps between the first and last vertices of the polygon rings which are not exactly closed.
+// The densified rings are closed by snapping when the gap is within the ring closure tolerance.
+void collectRingGaps(const OGRGeometry* geom, std::vector<double>& gaps)
+{
+  if (!geom)
+    return;
+
+  switch (wkbFlatten(geom->getGeometryType()))
+  {
+    case wkbPolygon:
+    {
+      const auto* polygon = geom->toPolygon();
+      for (int i = -1; i < polygon->getNumInteriorRings(); ++i)
+      {
+        const auto* ring = (i < 0 ? polygon->getExteriorRing() : polygon->getInteriorRing(i));
+        const int n = (ring ? ring->getNumPoints() : 0);
+        if (n < 2)
+          continue;
+        const double gap = std::max(std::abs(ring->getX(0) - ring->getX(n - 1)),
+                                    std::abs(ring->getY(0) - ring->getY(n - 1)));
+        if (gap > 0)
+          gaps.push_back(gap);
+      }
+      return;
+    }
+    case wkbMultiPolygon:
+    case wkbGeometryCollection:
+    {
+      const auto* collection = geom->toGeometryCollection();
+      for (int i = 0; i < collection->getNumGeometries(); ++i)
+        collectRingGaps(collection->getGeometryRef(i), gaps);
+      return;
+    }
+    default:
+      return;
+  }
+}
+}  // namespace
+
+class DensifiedGeometry::Impl
+{
+ public:
+  // Densification resolution and the number of ring gaps within the ring closure tolerance.
+  // The tolerance depends on the projected bounds, but the densified paths change only when a
+  // gap crosses it. Valid geometries have no gaps, and are densified once per resolution.
+  using Key = std::pair<double, std::size_t>;
+
+  explicit Impl(const OGRGeometry& geom) : m_geom(geom.clone())
+  {
+    collectRingGaps(m_geom.get(), m_gaps);
+    std::sort(m_gaps.begin(), m_gaps.end());
+  }
+
+  const OGRGeometry& geometry() const { return *m_geom; }
+
+  Key key(double densifyKm, double ringEps) const
+  {
+    const auto closed = std::upper_bound(m_gaps.begin(), m_gaps.end(), ringEps) - m_gaps.begin();
+    return {densifyKm, static_cast<std::size_t>(closed)};
+  }
+
+  // Cached paths, or paths made by the callback. The lock is not held while densifying,
+  // if two threads densify simultaneously the first result is kept.
+  std::shared_ptr<const DensifiedPaths> find(
+      const Key& key, const std::function<void(DensifiedPaths&)>& densify)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto pos = m_paths.find(key);
+      if (pos != m_paths.end())
+        return pos->second;
+    }
+
+    auto paths = std::make_shared<DensifiedPaths>();
+    densify(*paths);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_paths.emplace(key, std::move(paths)).first->second;
+  }
+
+ private:
+  std::unique_ptr<OGRGeometry> m_geom;
+  std::vector<double> m_gaps;  // sorted ring closure gaps
+  std::mutex m_mutex;
+  std::map<Key, std::shared_ptr<const DensifiedPaths>> m_paths;
+};
+
+DensifiedGeometry::DensifiedGeometry(const OGRGeometry& geom)
+    : m_impl(std::make_unique<Impl>(geom))
+{
+}
+
+DensifiedGeometry::~DensifiedGeometry() = default;
+
+const OGRGeometry& DensifiedGeometry::geometry() const
+{
+  return m_impl->geometry();
+}
+
 // ------------------------------ PIMPL ------------------------------
 
 class GeometryProjector::Impl
@@ -510,8 +621,10 @@ class GeometryProjector::Impl
   }
   void setDensifyResolutionKm(double km);
   double getDensifyResolutionKm() const;
-  std::unique_ptr<OGRGeometry> projectGeometry(const OGRGeometry* geom);
+  std::unique_ptr<OGRGeometry> projectGeometry(const OGRGeometry* geom,
+                                               DensifiedGeometry::Impl* cache = nullptr);
   void setJumpThreshold(double threshold);
+  void setThreads(unsigned int threads) { m_threads = threads; }
 
  private:
   struct SRSDeleter
@@ -548,25 +661,38 @@ class GeometryProjector::Impl
 
   double m_densifyKm = 50.0;  // default densification is to 50 km
 
+  unsigned int m_threads = 1;             // threads for projecting large batches, 0 = auto
+  std::vector<CtPtr> m_threadTransforms;  // clones of m_transform for the worker threads
+
+  // ---- batching ----
+  std::shared_ptr<const DensifiedPaths> densify(const OGRGeometry* geom,
+                                                DensifiedGeometry::Impl* cache) const;
+  void collect(const OGRGeometry* geom, DensifiedPaths& paths) const;
+  std::unique_ptr<OGRLineString> densifiedRing(const OGRLinearRing* ring, bool isExterior) const;
+  void transform(ProjectionBatch& batch);
+
   // ---- core dispatch ----
-  std::unique_ptr<OGRGeometry> projectPoint(const OGRPoint* point);
-  std::unique_ptr<OGRGeometry> projectLineString(const OGRLineString* line);
-  std::unique_ptr<OGRGeometry> projectPolygon(const OGRPolygon* polygon);
-  std::unique_ptr<OGRGeometry> projectMultiGeometry(const OGRGeometryCollection* collection);
+  std::unique_ptr<OGRGeometry> projectComponent(const OGRGeometry* geom, ProjectionBatch& batch);
+  std::unique_ptr<OGRGeometry> projectPoint(const OGRPoint* point, ProjectionBatch& batch);
+  std::unique_ptr<OGRGeometry> projectLineString(const OGRLineString* line,
+                                                 ProjectionBatch& batch);
+  std::unique_ptr<OGRGeometry> projectPolygon(const OGRPolygon* polygon, ProjectionBatch& batch);
+  std::unique_ptr<OGRGeometry> projectMultiGeometry(const OGRGeometryCollection* collection,
+                                                    ProjectionBatch& batch);
 
   // ---- helpers ----
   ProjectionBoundary getProjectionBoundary() const;
   bool isInsideBounds(double x, double y) const;
-
-  std::unique_ptr<OGRPoint> projectSinglePoint(double x, double y, bool* success = nullptr) const;
+  bool isPlausible(double x, double y) const;
 
   // Polygon splitting: exterior runs => polygon pieces; hole runs => interior rings or boundary
   // cuts
-  std::unique_ptr<OGRGeometry> splitPolygonWithHolesFast(const OGRPolygon* polygon) const;
+  std::unique_ptr<OGRGeometry> splitPolygonWithHolesFast(const OGRPolygon* polygon,
+                                                         ProjectionBatch& batch) const;
 
   // ---- best-effort projection helpers ----
   std::vector<std::unique_ptr<OGRLineString>> projectToProjectedRunsBestEffort(
-      const OGRLineString& geo, bool splitAtFailures) const;
+      const ProjectionBatch& batch, const ProjectionBatch::Path& path, bool splitAtFailures) const;
 };
 
 // ------------------------------ ctor/dtor ------------------------------
@@ -615,7 +741,8 @@ double GeometryProjector::Impl::getDensifyResolutionKm() const
   return m_densifyKm;
 }
 
-std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectGeometry(const OGRGeometry* geom)
+std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectGeometry(
+    const OGRGeometry* geom, DensifiedGeometry::Impl* cache)
 {
   if (!geom)
     return nullptr;
@@ -623,63 +750,224 @@ std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectGeometry(const OGRG
     throw std::runtime_error(
         "GeometryProjector: setProjectedBounds must be called before projectGeometry");
 
-  const auto gt = wkbFlatten(geom->getGeometryType());
+  // Project all vertices first, then split and clip the components using the results
+  ProjectionBatch batch(densify(geom, cache));
+  transform(batch);
+  return projectComponent(geom, batch);
+}
 
-  switch (gt)
+void GeometryProjector::Impl::setJumpThreshold(double threshold)
+{
+  m_jumpThreshold = threshold;
+}
+
+// ------------------------------ batching ------------------------------
+
+// Densified source coordinates of the geometry, from the cache if one is given. The ring
+// closure tolerance depends on the projected bounds, the key depends on it only if the
+// geometry has rings which are not exactly closed.
+std::shared_ptr<const DensifiedPaths> GeometryProjector::Impl::densify(
+    const OGRGeometry* geom, DensifiedGeometry::Impl* cache) const
+{
+  if (!cache)
+  {
+    auto paths = std::make_shared<DensifiedPaths>();
+    collect(geom, *paths);
+    return paths;
+  }
+
+  ProjectionBoundary b = getProjectionBoundary();
+  const double eps = ringEps(b.minX, b.minY, b.maxX, b.maxY);
+  const auto key = cache->key(std::max(m_densifyKm, 0.0), eps);
+  return cache->find(key, [&](DensifiedPaths& paths) { collect(geom, paths); });
+}
+
+// Collect the densified source coordinates in the same order projectComponent processes the
+// components. Components projectComponent skips without projecting are not collected.
+void GeometryProjector::Impl::collect(const OGRGeometry* geom, DensifiedPaths& paths) const
+{
+  if (!geom)
+    return;
+
+  switch (wkbFlatten(geom->getGeometryType()))
   {
     case wkbPoint:
-      return projectPoint(dynamic_cast<const OGRPoint*>(geom));
+    {
+      const auto* point = dynamic_cast<const OGRPoint*>(geom);
+      if (!point || point->IsEmpty())
+        return;
+      auto geo = std::make_unique<OGRLineString>();
+      geo->addPoint(point->getX(), point->getY());
+      paths.add(geom, std::move(geo));
+      return;
+    }
     case wkbLineString:
     case wkbLinearRing:
-      return projectLineString(dynamic_cast<const OGRLineString*>(geom));
+    {
+      const auto* line = dynamic_cast<const OGRLineString*>(geom);
+      if (!line || line->IsEmpty())
+        return;
+      std::unique_ptr<OGRLineString> geo(line->clone());
+      if (m_densifyKm > 0.0)
+        Geodesy::densify(*geo, m_densifyKm * 1000.0);
+      paths.add(geom, std::move(geo));
+      return;
+    }
     case wkbPolygon:
-      return projectPolygon(dynamic_cast<const OGRPolygon*>(geom));
+    {
+      const auto* polygon = dynamic_cast<const OGRPolygon*>(geom);
+      if (!polygon || polygon->IsEmpty())
+        return;
+      const OGRLinearRing* ext = polygon->getExteriorRing();
+      if (!ext || ext->getNumPoints() < 4)
+        return;
+      paths.add(ext, densifiedRing(ext, /*isExterior=*/true));
+      for (int i = 0; i < polygon->getNumInteriorRings(); ++i)
+      {
+        const OGRLinearRing* hole = polygon->getInteriorRing(i);
+        if (hole && hole->getNumPoints() >= 4)
+          paths.add(hole, densifiedRing(hole, /*isExterior=*/false));
+      }
+      return;
+    }
     case wkbMultiPoint:
     case wkbMultiLineString:
     case wkbMultiPolygon:
     case wkbGeometryCollection:
-      return projectMultiGeometry(geom->toGeometryCollection());
+    {
+      const auto* collection = geom->toGeometryCollection();
+      if (!collection || collection->IsEmpty())
+        return;
+      for (int i = 0; i < collection->getNumGeometries(); ++i)
+        collect(collection->getGeometryRef(i), paths);
+      return;
+    }
     default:
-      return std::unique_ptr<OGRGeometry>(
-          OGRGeometryFactory::createGeometry(wkbGeometryCollection));
+      return;
   }
 }
 
-void GeometryProjector::Impl::setJumpThreshold(double threshold)
+// Closed, consistently oriented and densified copy of a ring
+std::unique_ptr<OGRLineString> GeometryProjector::Impl::densifiedRing(const OGRLinearRing* ring,
+                                                                      bool isExterior) const
 {
-  m_jumpThreshold = threshold;
+  ProjectionBoundary b = getProjectionBoundary();
+  const double eps = ringEps(b.minX, b.minY, b.maxX, b.maxY);
+
+  auto geo = ringToLineStringPreserveClosure(ring, /*forceClose=*/true, eps);
+
+  // Normalize winding before densification so that jump-detection runs are produced
+  // in the order the CCW reconnection algorithm (connectLines/search_ccw) expects.
+  // For exterior rings: CCW so the bottom edge is traversed first, seeding Run 1 at
+  // the bottom-right corner and Run 2 at the top-left corner.
+  // For interior rings: CW (the opposite).
+  // OGRLinearRing::isClockwise()==1 means CW (negative signed area in y-up coordinates).
+  {
+    int cw = ring->isClockwise();
+    bool doReverse = isExterior ? (cw != 0) : (cw == 0);
+    if (doReverse)
+      geo->reversePoints();
+  }
+
+  if (m_densifyKm > 0.0)
+    Geodesy::densify(*geo, m_densifyKm * 1000.0);
+
+  return geo;
+}
+
+// Project all collected vertices with one batched call per thread. The coordinate
+// transformations are not thread safe, hence each worker thread uses its own clone.
+void GeometryProjector::Impl::transform(ProjectionBatch& batch)
+{
+  const std::size_t n = batch.x.size();
+  batch.ok.assign(n, 0);
+  if (n == 0)
+    return;
+
+  std::size_t nthreads = (m_threads > 0 ? m_threads : std::thread::hardware_concurrency());
+  nthreads = std::max<std::size_t>(1, std::min(nthreads, n / parallel_limit));
+
+  while (m_threadTransforms.size() + 1 < nthreads)
+  {
+    CtPtr clone(m_transform->Clone());
+    if (!clone)
+      break;
+    m_threadTransforms.push_back(std::move(clone));
+  }
+  nthreads = std::min(nthreads, m_threadTransforms.size() + 1);
+
+  const std::size_t chunk = (n + nthreads - 1) / nthreads;
+  Parallel::run(nthreads,
+                static_cast<unsigned int>(nthreads),
+                [&](std::size_t k)
+                {
+                  const std::size_t first = k * chunk;
+                  const std::size_t count = std::min(chunk, n - first);
+                  auto* ct = (k == 0 ? m_transform.get() : m_threadTransforms[k - 1].get());
+                  double* x = batch.x.data() + first;
+                  double* y = batch.y.data() + first;
+                  int* ok = batch.ok.data() + first;
+                  ct->Transform(count, x, y, nullptr, ok);
+                  for (std::size_t i = 0; i < count; i++)
+                    ok[i] = (ok[i] != 0 && isPlausible(x[i], y[i]));
+                });
 }
 
 // ------------------------------ core dispatch helpers ------------------------------
 
-std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectPoint(const OGRPoint* point)
+std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectComponent(const OGRGeometry* geom,
+                                                                       ProjectionBatch& batch)
+{
+  const auto gt = wkbFlatten(geom->getGeometryType());
+
+  switch (gt)
+  {
+    case wkbPoint:
+      return projectPoint(dynamic_cast<const OGRPoint*>(geom), batch);
+    case wkbLineString:
+    case wkbLinearRing:
+      return projectLineString(dynamic_cast<const OGRLineString*>(geom), batch);
+    case wkbPolygon:
+      return projectPolygon(dynamic_cast<const OGRPolygon*>(geom), batch);
+    case wkbMultiPoint:
+    case wkbMultiLineString:
+    case wkbMultiPolygon:
+    case wkbGeometryCollection:
+      return projectMultiGeometry(geom->toGeometryCollection(), batch);
+    default:
+      return std::unique_ptr<OGRGeometry>(
+          OGRGeometryFactory::createGeometry(wkbGeometryCollection));
+  }
+}
+
+std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectPoint(const OGRPoint* point,
+                                                                   ProjectionBatch& batch)
 {
   if (!point || point->IsEmpty())
     return nullptr;
 
-  bool ok = false;
-  auto p = projectSinglePoint(point->getX(), point->getY(), &ok);
-  if (!ok || !p)
+  const auto& path = batch.take(point);
+  if (!batch.ok[path.offset])
     return nullptr;
 
-  if (!isInsideBounds(p->getX(), p->getY()))
+  const double x = batch.x[path.offset];
+  const double y = batch.y[path.offset];
+  if (!isInsideBounds(x, y))
     return nullptr;
 
-  return std::unique_ptr<OGRGeometry>(p.release());
+  return std::make_unique<OGRPoint>(x, y);
 }
 
-std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectLineString(const OGRLineString* line)
+std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectLineString(const OGRLineString* line,
+                                                                        ProjectionBatch& batch)
 {
   if (!line || line->IsEmpty())
     return nullptr;
 
   ProjectionBoundary b = getProjectionBoundary();
 
-  std::unique_ptr<OGRLineString> geo(line->clone());
-  if (geo && m_densifyKm > 0.0)
-    densifyGeographicKm(geo.get(), m_densifyKm);
-
-  auto projRuns = projectToProjectedRunsBestEffort(*geo, /*splitAtFailures=*/true);
+  const auto& path = batch.take(line);
+  auto projRuns = projectToProjectedRunsBestEffort(batch, path, /*splitAtFailures=*/true);
   const double maxJumpMeters =
       (m_densifyKm > 0.0) ? (m_densifyKm * 1000 * 10) : std::max(m_jumpThreshold, 1000 * 1e3);
   auto clippedRuns =
@@ -697,16 +985,17 @@ std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectLineString(const OG
   return std::unique_ptr<OGRGeometry>(ml);
 }
 
-std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectPolygon(const OGRPolygon* polygon)
+std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectPolygon(const OGRPolygon* polygon,
+                                                                     ProjectionBatch& batch)
 {
   if (!polygon || polygon->IsEmpty())
     return nullptr;
 
-  return splitPolygonWithHolesFast(polygon);
+  return splitPolygonWithHolesFast(polygon, batch);
 }
 
 std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectMultiGeometry(
-    const OGRGeometryCollection* collection)
+    const OGRGeometryCollection* collection, ProjectionBatch& batch)
 {
   if (!collection || collection->IsEmpty())
     return nullptr;
@@ -748,7 +1037,7 @@ std::unique_ptr<OGRGeometry> GeometryProjector::Impl::projectMultiGeometry(
     const OGRGeometry* g = collection->getGeometryRef(i);
     if (!g)
       continue;
-    auto pg = projectGeometry(g);
+    auto pg = projectComponent(g, batch);
     if (!pg || pg->IsEmpty())
       continue;
     // if (!pg->IsValid())  continue;  // drop invalid pieces before they can corrupt the collection
@@ -777,18 +1066,10 @@ bool GeometryProjector::Impl::isInsideBounds(double x, double y) const
   return pointInBounds(x, y, b.minX, b.minY, b.maxX, b.maxY);
 }
 
-std::unique_ptr<OGRPoint> GeometryProjector::Impl::projectSinglePoint(double x,
-                                                                      double y,
-                                                                      bool* success) const
+bool GeometryProjector::Impl::isPlausible(double px, double py) const
 {
-  double px = x;
-  double py = y;
-  if (m_transform->Transform(1, &px, &py) == FALSE || !std::isfinite(px) || !std::isfinite(py))
-  {
-    if (success)
-      *success = false;
-    return nullptr;
-  }
+  if (!std::isfinite(px) || !std::isfinite(py))
+    return false;
 
   // Reject points that are implausibly far outside the bounding box —
   // these are PROJ sentinel values or degenerate projections that would
@@ -799,20 +1080,12 @@ std::unique_ptr<OGRPoint> GeometryProjector::Impl::projectSinglePoint(double x,
   const double margin = 10.0 * std::max(boxW, boxH);
   const double centerX = 0.5 * (m_projectedBounds[0] + m_projectedBounds[2]);
   const double centerY = 0.5 * (m_projectedBounds[1] + m_projectedBounds[3]);
-  if (std::abs(px - centerX) > margin || std::abs(py - centerY) > margin)
-  {
-    if (success)
-      *success = false;
-    return nullptr;
-  }
-
-  if (success)
-    *success = true;
-  return std::make_unique<OGRPoint>(px, py);
+  return (std::abs(px - centerX) <= margin && std::abs(py - centerY) <= margin);
 }
 
 std::vector<std::unique_ptr<OGRLineString>>
-GeometryProjector::Impl::projectToProjectedRunsBestEffort(const OGRLineString& geo,
+GeometryProjector::Impl::projectToProjectedRunsBestEffort(const ProjectionBatch& batch,
+                                                          const ProjectionBatch::Path& path,
                                                           bool splitAtFailures) const
 {
   std::vector<std::unique_ptr<OGRLineString>> runs;
@@ -825,17 +1098,16 @@ GeometryProjector::Impl::projectToProjectedRunsBestEffort(const OGRLineString& g
     cur = std::make_unique<OGRLineString>();
   };
 
-  for (int i = 0; i < geo.getNumPoints(); ++i)
+  for (int i = 0, n = path.geo->getNumPoints(); i < n; ++i)
   {
-    bool ok = false;
-    auto p = projectSinglePoint(geo.getX(i), geo.getY(i), &ok);
-    if (!ok || !p)
+    const auto v = path.offset + i;
+    if (!batch.ok[v])
     {
       if (splitAtFailures)
         flush();
       continue;
     }
-    cur->addPoint(p->getX(), p->getY());
+    cur->addPoint(batch.x[v], batch.y[v]);
   }
   flush();  // always flush at end regardless of splitAtFailures
   return runs;
@@ -844,7 +1116,7 @@ GeometryProjector::Impl::projectToProjectedRunsBestEffort(const OGRLineString& g
 // ------------------------------ splitPolygonWithHolesFast ------------------------------
 
 std::unique_ptr<OGRGeometry> GeometryProjector::Impl::splitPolygonWithHolesFast(
-    const OGRPolygon* polygon) const
+    const OGRPolygon* polygon, ProjectionBatch& batch) const
 {
   ProjectionBoundary b = getProjectionBoundary();
   const double eps = ringEps(b.minX, b.minY, b.maxX, b.maxY);
@@ -857,23 +1129,9 @@ std::unique_ptr<OGRGeometry> GeometryProjector::Impl::splitPolygonWithHolesFast(
     if (!ring || ring->getNumPoints() < 4)
       return false;
 
-    auto geo = ringToLineStringPreserveClosure(ring, /*forceClose=*/true, eps);
-
-    // Normalize winding before densification so that jump-detection runs are produced
-    // in the order the CCW reconnection algorithm (connectLines/search_ccw) expects.
-    // For exterior rings: CCW so the bottom edge is traversed first, seeding Run 1 at
-    // the bottom-right corner and Run 2 at the top-left corner.
-    // For interior rings: CW (the opposite).
-    // OGRLinearRing::isClockwise()==1 means CW (negative signed area in y-up coordinates).
-    {
-      int cw = ring->isClockwise();
-      bool doReverse = isExterior ? (cw != 0) : (cw == 0);
-      if (doReverse)
-        geo->reversePoints();
-    }
-
-    if (m_densifyKm > 0.0)
-      densifyGeographicKm(geo.get(), m_densifyKm);
+    // The ring was oriented, densified and projected by collect() and transform()
+    const auto& path = batch.take(ring);
+    const OGRLineString* geo = path.geo;
 
     // Jump threshold: the larger of 20× the densification step and 35% of the box height.
     //
@@ -893,7 +1151,7 @@ std::unique_ptr<OGRGeometry> GeometryProjector::Impl::splitPolygonWithHolesFast(
         (m_densifyKm > 0.0) ? std::max(m_densifyKm * 1000.0 * 20.0, (b.maxY - b.minY) * 0.35)
                             : m_jumpThreshold;
 
-    auto projRuns = projectToProjectedRunsBestEffort(*geo, /*splitAtFailures=*/false);
+    auto projRuns = projectToProjectedRunsBestEffort(batch, path, /*splitAtFailures=*/false);
 
 #if 0
     std::cerr << "  projRuns=" << projRuns.size();
@@ -1257,9 +1515,19 @@ std::unique_ptr<OGRGeometry> GeometryProjector::projectGeometry(const OGRGeometr
   return m_impl->projectGeometry(geom);
 }
 
+std::unique_ptr<OGRGeometry> GeometryProjector::projectGeometry(const DensifiedGeometry& geom) const
+{
+  return m_impl->projectGeometry(&geom.geometry(), geom.m_impl.get());
+}
+
 void GeometryProjector::setJumpThreshold(double threshold)
 {
   m_impl->setJumpThreshold(threshold);
 }
 
+void GeometryProjector::setThreads(unsigned int threads)
+{
+  m_impl->setThreads(threads);
+}
+
 }  // namespace Fmi
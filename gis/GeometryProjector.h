@@ -8,6 +8,30 @@ class OGRGeometry;
 
 namespace Fmi
 {
+class GeometryProjector;
+
+// A geometry whose densified copies are cached for projecting the same geometry into several
+// target CRSs. The geometry is densified once per densification resolution, which the
+// projectors then share. Densification often multiplies the vertex count by ten, hence the
+// handle should be kept for example with a layer which is drawn in many projections.
+// Thread safe.
+class DensifiedGeometry
+{
+ public:
+  explicit DensifiedGeometry(const OGRGeometry& geom);
+  ~DensifiedGeometry();
+
+  DensifiedGeometry(const DensifiedGeometry&) = delete;
+  DensifiedGeometry& operator=(const DensifiedGeometry&) = delete;
+
+  // A copy of the original geometry
+  const OGRGeometry& geometry() const;
+
+ private:
+  friend class GeometryProjector;
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+};
 
 class GeometryProjector
 {
@@ -32,8 +56,18 @@ class GeometryProjector
   // Project + clip to bounds. Returns nullptr only if input geom is nullptr.
   std::unique_ptr<OGRGeometry> projectGeometry(const OGRGeometry* geom) const;
 
+  // Same as above, but reuses the densified coordinates cached by projectors with the same
+  // densification resolution
+  std::unique_ptr<OGRGeometry> projectGeometry(const DensifiedGeometry& geom) const;
+
   void setJumpThreshold(double threshold);
 
+  // All vertices of a geometry are projected with one batched call. Number of threads used to
+  // project batches of more than 20000 vertices per thread with separate transformations.
+  // The output does not depend on the thread count. 1 (default) disables threading, 0 uses
+  // one thread per hardware core.
+  void setThreads(unsigned int threads);
+
  private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
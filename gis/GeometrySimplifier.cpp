@@ -1,11 +1,16 @@
 #include "GeometrySimplifier.h"
+#include "ArcTopology.h"
 #include "Box.h"
-#include "VertexCounter.h"
+#include "Parallel.h"
+#include "PathBuffer.h"
 #include <macgyver/Exception.h>
 #include <macgyver/Hash.h>
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <ogr_geometry.h>
-#include <queue>
 #include <vector>
 
 namespace Fmi
@@ -13,34 +18,169 @@ namespace Fmi
 
 namespace
 {
+// Below this many vertices simplification is not worth distributing to threads
+const std::size_t parallel_limit = 20000;
+
+using Path = PathBuffer::Path;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Indexed 4-ary min-heap of vertices ordered by effective area
+ *
+ * The position of each vertex in the heap is tracked, so the areas of
+ * the neighbours of a removed vertex can be updated in place instead of
+ * pushing new entries and skipping the stale ones later. Ties are broken
+ * by the vertex index for deterministic results.
+ */
+// ----------------------------------------------------------------------
+
+class VertexHeap
+{
+ public:
+  // Heapify vertices 1..n-2
+  void init(const double* theAreas, int theCount)
+  {
+    m_areas = theAreas;
+    m_heap.clear();
+    m_position.assign(theCount, -1);
+    for (int i = 1; i < theCount - 1; i++)
+    {
+      m_position[i] = static_cast<int>(m_heap.size());
+      m_heap.push_back(i);
+    }
+    for (int pos = (static_cast<int>(m_heap.size()) - 2) / arity; pos >= 0; pos--)
+      sift_down(pos);
+  }
 
-// Triangle area using the shoelace formula
-double triangle_area(const OGRPoint& a, const OGRPoint& b, const OGRPoint& c)
+  bool empty() const { return m_heap.empty(); }
+  int top() const { return m_heap.front(); }
+
+  void pop()
+  {
+    m_position[m_heap.front()] = -1;
+    m_heap.front() = m_heap.back();
+    m_heap.pop_back();
+    if (!m_heap.empty())
+    {
+      m_position[m_heap.front()] = 0;
+      sift_down(0);
+    }
+  }
+
+  // Restore the heap order after the area of the vertex has changed
+  void update(int theVertex)
+  {
+    const int pos = m_position[theVertex];
+    if (pos < 0)
+      return;
+    if (pos > 0 && less(theVertex, m_heap[(pos - 1) / arity]))
+      sift_up(pos);
+    else
+      sift_down(pos);
+  }
+
+ private:
+  static constexpr int arity = 4;
+
+  bool less(int a, int b) const
+  {
+    return m_areas[a] < m_areas[b] || (m_areas[a] == m_areas[b] && a < b);
+  }
+
+  void place(int thePos, int theVertex)
+  {
+    m_heap[thePos] = theVertex;
+    m_position[theVertex] = thePos;
+  }
+
+  void sift_up(int thePos)
+  {
+    const int v = m_heap[thePos];
+    while (thePos > 0)
+    {
+      const int parent = (thePos - 1) / arity;
+      if (!less(v, m_heap[parent]))
+        break;
+      place(thePos, m_heap[parent]);
+      thePos = parent;
+    }
+    place(thePos, v);
+  }
+
+  void sift_down(int thePos)
+  {
+    const int v = m_heap[thePos];
+    const int n = static_cast<int>(m_heap.size());
+    while (true)
+    {
+      const int first = arity * thePos + 1;
+      if (first >= n)
+        break;
+      int best = first;
+      const int last = std::min(first + arity, n);
+      for (int child = first + 1; child < last; child++)
+        if (less(m_heap[child], m_heap[best]))
+          best = child;
+      if (!less(m_heap[best], v))
+        break;
+      place(thePos, m_heap[best]);
+      thePos = best;
+    }
+    place(thePos, v);
+  }
+
+  const double* m_areas = nullptr;
+  std::vector<int> m_heap;      // vertices in heap order
+  std::vector<int> m_position;  // position of each vertex in the heap, or -1
+};
+
+const double infinity = std::numeric_limits<double>::infinity();
+
+// Scratch buffers for simplifying a single path, reused by each thread
+struct Scratch
 {
-  return 0.5 * std::abs((b.getX() - a.getX()) * (c.getY() - a.getY()) -
-                        (c.getX() - a.getX()) * (b.getY() - a.getY()));
-}
+  std::vector<double> x;  // coordinates of the segment being simplified
+  std::vector<double> y;
+  std::vector<double> areas;      // current areas of the active vertices
+  std::vector<double> effective;  // areas of the removed vertices, infinity if kept
+  std::vector<int> prev;          // linked list of active neighbours
+  std::vector<int> next;
+  std::vector<int> anchors;
+  VertexHeap heap;
+};
 
-// Compare two OGRPoints lexicographically (x first, then y)
-bool point_less(const OGRPoint& a, const OGRPoint& b)
+// Triangle area using the shoelace formula
+double triangle_area(const double* x, const double* y, int a, int b, int c)
 {
-  if (a.getX() != b.getX())
-    return a.getX() < b.getX();
-  return a.getY() < b.getY();
+  return 0.5 * std::abs((x[b] - x[a]) * (y[c] - y[a]) - (x[c] - x[a]) * (y[b] - y[a]));
 }
 
-// Visvalingam-Whyatt on a segment of points. Returns indices to keep.
-std::vector<bool> simplify_vw(const std::vector<OGRPoint>& pts, double tolerance)
+// ----------------------------------------------------------------------
+/*!
+ * \brief Visvalingam-Whyatt on the n points in the scratch buffers
+ *
+ * The effective areas of the removed vertices are stored in
+ * scratch.effective, the kept ones get infinity. The first and last
+ * vertices are always kept. The effective areas never decrease in the
+ * order of elimination, hence the vertices removed for any smaller
+ * tolerance are exactly those whose effective area is below it.
+ */
+// ----------------------------------------------------------------------
+
+void simplify_vw(Scratch& scratch, int n, double tolerance)
 {
-  const int n = pts.size();
-  std::vector<bool> keep(n, true);
-
+  scratch.effective.assign(n, infinity);
   if (n < 3)
-    return keep;
+    return;
+
+  const double* x = scratch.x.data();
+  const double* y = scratch.y.data();
 
-  // Linked list of active neighbors
-  std::vector<int> prev(n);
-  std::vector<int> next(n);
+  scratch.prev.resize(n);
+  scratch.next.resize(n);
+  int* prev = scratch.prev.data();
+  int* next = scratch.next.data();
+  double* effective = scratch.effective.data();
   for (int i = 0; i < n; i++)
   {
     prev[i] = i - 1;
@@ -48,426 +188,380 @@ std::vector<bool> simplify_vw(const std::vector<OGRPoint>& pts, double tolerance
   }
 
   // Current effective areas
-  std::vector<double> areas(n, std::numeric_limits<double>::max());
-  for (int i = 1; i < n - 1; i++)
-    areas[i] = triangle_area(pts[prev[i]], pts[i], pts[next[i]]);
-
-  // Min-heap: (area, index)
-  using Entry = std::pair<double, int>;
-  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
-
+  scratch.areas.assign(n, std::numeric_limits<double>::max());
+  double* areas = scratch.areas.data();
   for (int i = 1; i < n - 1; i++)
-    heap.push({areas[i], i});
+    areas[i] = triangle_area(x, y, i - 1, i, i + 1);
 
-  double last_removed_area = 0;
+  auto& heap = scratch.heap;
+  heap.init(areas, n);
 
   while (!heap.empty())
   {
-    auto [area, idx] = heap.top();
-    heap.pop();
-
-    if (!keep[idx])
-      continue;
-
-    // Stale entry — area was updated after this entry was pushed
-    if (area != areas[idx])
-      continue;
-
+    const int idx = heap.top();
+    const double area = areas[idx];
     if (area >= tolerance)
       break;
 
     // Remove this vertex
-    keep[idx] = false;
-    last_removed_area = area;
+    heap.pop();
+    effective[idx] = area;
 
     // Update neighbors
-    int p = prev[idx];
-    int nx = next[idx];
+    const int p = prev[idx];
+    const int nx = next[idx];
 
     next[p] = nx;
     prev[nx] = p;
 
-    // Update area of previous neighbor (if it's an interior point)
-    if (p > 0 && p < n - 1 && keep[p])
+    // Update the areas of the neighbours if they are interior points. The monotonicity
+    // rule prevents cascade removal of dependent points.
+    if (p > 0)
     {
-      double new_area = triangle_area(pts[prev[p]], pts[p], pts[next[p]]);
-      areas[p] = std::max(new_area, last_removed_area);  // monotonicity rule
-      heap.push({areas[p], p});
+      areas[p] = std::max(triangle_area(x, y, prev[p], p, next[p]), area);
+      heap.update(p);
     }
-
-    // Update area of next neighbor (if it's an interior point)
-    if (nx > 0 && nx < n - 1 && keep[nx])
+    if (nx < n - 1)
     {
-      double new_area = triangle_area(pts[prev[nx]], pts[nx], pts[next[nx]]);
-      areas[nx] = std::max(new_area, last_removed_area);  // monotonicity rule
-      heap.push({areas[nx], nx});
+      areas[nx] = std::max(triangle_area(x, y, prev[nx], nx, next[nx]), area);
+      heap.update(nx);
     }
   }
-
-  return keep;
 }
 
-// Utility class to handle topology-aware simplification
-class LineSimplifier
+// ----------------------------------------------------------------------
+/*!
+ * \brief Simplification of linestrings and rings in flat buffers
+ *
+ * The vertices are grouped by their coordinates to find the anchors, and
+ * the effective areas of the vertices of each path are then calculated
+ * independently of the other paths, possibly in parallel. Shared edges
+ * are simplified in a canonical direction, so the result does not depend
+ * on which path sees the edge first and is the same for any number of
+ * threads. The areas are either used once to compact the kept vertices
+ * of each path in place, or stored for extracting any tolerance later.
+ *
+ * The paths may also be the arcs of an ArcTopology, in which case each
+ * arc may be required to keep a minimum number of vertices so that the
+ * rings rebuilt from the arcs do not collapse.
+ */
+// ----------------------------------------------------------------------
+
+class PathSimplifier
 {
- private:
-  VertexCounter m_counter;
-  double m_tolerance;
-  std::vector<int> m_counts;
-
  public:
-  explicit LineSimplifier(double tol) : m_tolerance(tol) {}
+  PathSimplifier(PathBuffer& theBuffer, bool thePreserveTopology);
 
-  void count(const OGRGeometry* geom) { m_counter.add(geom); }
+  // Simplify with the given vertex counts, keeping a minimum number of vertices per path
+  PathSimplifier(PathBuffer& theBuffer, std::vector<int> theCounts, std::vector<int> theKeep);
 
-  void init_counts(const OGRLineString* geom)
-  {
-    const int n = geom->getNumPoints();
-    m_counts.clear();
-    m_counts.reserve(n);
+  // Simplify the paths in the buffer in place
+  void run(double theTolerance, unsigned int theThreads);
 
-    OGRPoint pt;
-    for (int i = 0; i < n; i++)
-    {
-      geom->getPoint(i, &pt);
-      m_counts.push_back(m_counter.getCount(pt));
-    }
-  }
+  // Calculate the effective areas of all vertices and extract simplifications from them
+  void rank(unsigned int theThreads);
+  std::vector<OGRGeometryPtr> extract(double theTolerance) const;
 
-  // An anchor point must not be removed. Inverse of smoother's allowed():
-  // count 0 = isoline (counting disabled) -> not an anchor, can remove
-  // count 1 = unshared edge -> anchor, must keep
-  // count 2 = shared edge -> not an anchor, can remove
-  // count 4 = shared corner -> anchor, must keep
-  bool is_anchor(int j) const
+ private:
+  void simplify(std::size_t thePath, double theTolerance);
+  void simplify_segment(
+      Scratch& theScratch, const Path& thePath, int theStart, int theEnd, double theTolerance);
+  int filter(std::size_t thePath, double theTolerance, double* theX, double* theY) const;
+
+  PathBuffer& m_buffer;
+  std::vector<int> m_counts;      // occurrence counts of the vertices, 0 if topology is ignored
+  std::vector<int> m_keep;        // minimum number of vertices to keep in each path, if any
+  std::vector<double> m_areas;    // effective areas of the vertices
+  std::vector<double> m_minimum;  // smallest effective area of each path
+};
+
+PathSimplifier::PathSimplifier(PathBuffer& theBuffer, bool thePreserveTopology)
+    : m_buffer(theBuffer)
+{
+  m_counts.resize(m_buffer.x.size(), 0);
+  if (thePreserveTopology)
   {
-    auto n = m_counts[j];
-    return (n != 0 && n != 2);
+    const auto groups = m_buffer.groups();
+    for (std::size_t v = 0; v < m_counts.size(); v++)
+      m_counts[v] = groups.count[groups.group[v]];
   }
 
-  // Simplify a segment of points between two anchors using Visvalingam-Whyatt.
-  // First and last points are always kept.
-  void simplify_segment(std::vector<OGRPoint>& pts, std::vector<bool>& keep) const
-  {
-    if (pts.size() < 3)
-      return;
+  m_areas.resize(m_buffer.x.size());
+  m_minimum.resize(m_buffer.paths.size());
+}
 
-    // Canonicalize segment direction for deterministic results on shared edges
-    bool reversed = point_less(pts.back(), pts.front());
-    if (reversed)
-      std::reverse(pts.begin(), pts.end());
+PathSimplifier::PathSimplifier(PathBuffer& theBuffer,
+                               std::vector<int> theCounts,
+                               std::vector<int> theKeep)
+    : PathSimplifier(theBuffer, false)
+{
+  m_counts = std::move(theCounts);
+  m_keep = std::move(theKeep);
+}
 
-    auto seg_keep = simplify_vw(pts, m_tolerance);
+// Simplify the vertices from theStart to theEnd, wrapping around for closed paths. The
+// effective areas are stored for the path vertices. Segments are canonicalized to start
+// from the smaller end point for deterministic results on shared edges.
+void PathSimplifier::simplify_segment(
+    Scratch& theScratch, const Path& thePath, int theStart, int theEnd, double theTolerance)
+{
+  const double* x = m_buffer.x.data() + thePath.offset;
+  const double* y = m_buffer.y.data() + thePath.offset;
+  double* areas = m_areas.data() + thePath.offset;
+  const int period = (thePath.closed ? thePath.size - 1 : thePath.size);
 
-    if (reversed)
-      std::reverse(seg_keep.begin(), seg_keep.end());
+  const int n = (theEnd - theStart + period) % period + 1;
+  if (n < 3)
+    return;
 
-    keep.insert(keep.end(), seg_keep.begin(), seg_keep.end());
-  }
+  const bool reversed = (x[theEnd] < x[theStart] ||
+                         (x[theEnd] == x[theStart] && y[theEnd] < y[theStart]));
 
-  // Simplify a linestring, respecting anchor points
-  OGRLineString* simplify(const OGRLineString* geom) const
+  theScratch.x.resize(n);
+  theScratch.y.resize(n);
+  for (int i = 0, j = theStart; i < n; i++, j = (j + 1) % period)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    const int n = geom->getNumPoints();
-    if (n < 3)
-      return dynamic_cast<OGRLineString*>(geom->clone());
-
-    const bool closed = geom->get_IsClosed();
+    const int k = (reversed ? n - 1 - i : i);
+    theScratch.x[k] = x[j];
+    theScratch.y[k] = y[j];
+  }
 
-    // Build list of all points
-    std::vector<OGRPoint> all_pts(n);
-    for (int i = 0; i < n; i++)
-      geom->getPoint(i, &all_pts[i]);
+  simplify_vw(theScratch, n, theTolerance);
 
-    // Identify anchor indices. For open linestrings, first and last are always anchors.
-    std::vector<bool> anchor(n, false);
-    if (!m_counts.empty())
-    {
-      for (int i = 0; i < n; i++)
-        anchor[i] = is_anchor(i);
-    }
-
-    if (!closed)
-    {
-      anchor[0] = true;
-      anchor[n - 1] = true;
-    }
+  for (int i = 0, j = theStart; i < n; i++, j = (j + 1) % period)
+    areas[j] = theScratch.effective[reversed ? n - 1 - i : i];
+}
 
-    // For closed rings: work with indices 0..n-2 (last point is duplicate of first)
-    const int effective_n = closed ? n - 1 : n;
+// ----------------------------------------------------------------------
+/*!
+ * \brief Calculate the effective areas of the vertices of a single path
+ *
+ * Vertices which are not shared by exactly two paths are anchors which
+ * must be kept, and so are the end points of open linestrings. The
+ * segments between consecutive anchors are simplified independently.
+ * Closed rings without any anchors are simplified as a whole with the
+ * first vertex pinned. A ring with a single anchor has no segments, its
+ * other vertices get -infinity and the ring is left untouched by the
+ * filter below.
+ */
+// ----------------------------------------------------------------------
+
+void PathSimplifier::simplify(std::size_t thePath, double theTolerance)
+{
+  thread_local Scratch scratch;
 
-    // Collect anchor indices
-    std::vector<int> anchor_indices;
-    for (int i = 0; i < effective_n; i++)
-      if (anchor[i])
-        anchor_indices.push_back(i);
+  const auto& path = m_buffer.paths[thePath];
+  const int n = path.size;
+  const double* x = m_buffer.x.data() + path.offset;
+  const double* y = m_buffer.y.data() + path.offset;
+  const int* counts = m_counts.data() + path.offset;
+  double* areas = m_areas.data() + path.offset;
 
-    // If no anchors at all (e.g. standalone ring with no topology), simplify the whole ring.
-    if (anchor_indices.empty())
-    {
-      std::vector<OGRPoint> pts(all_pts.begin(), all_pts.begin() + effective_n);
-
-      // Visvalingam-Whyatt on a closed ring: process as linear sequence with wraparound.
-      auto keep = simplify_vw(pts, m_tolerance);
-
-      // Ensure at least 3 vertices survive
-      int kept = 0;
-      for (bool k : keep)
-        if (k)
-          kept++;
-      if (kept < 3)
-        keep.assign(effective_n, true);  // keep all
-
-      // Build output
-      auto* out = closed ? static_cast<OGRLineString*>(new OGRLinearRing) : new OGRLineString;
-      for (int i = 0; i < effective_n; i++)
-        if (keep[i])
-          out->addPoint(all_pts[i].getX(), all_pts[i].getY());
-
-      if (closed)
-      {
-        out->closeRings();
-        if (out->getNumPoints() < 4)
-        {
-          delete out;
-          return dynamic_cast<OGRLineString*>(geom->clone());
-        }
-      }
-      return out;
-    }
+  std::fill(areas, areas + n, infinity);
+  m_minimum[thePath] = infinity;
+  if (n < 3)
+    return;
 
-    // Segment-based simplification between consecutive anchors
-    std::vector<bool> keep(effective_n, false);
+  // For closed paths work with vertices 0..n-2, the last one duplicates the first
+  const bool closed = path.closed;
+  const int period = (closed ? n - 1 : n);
 
-    // Mark all anchors as kept
-    for (int idx : anchor_indices)
-      keep[idx] = true;
+  // count 0 = isoline or topology not preserved -> not an anchor, can remove
+  // count 1 = unshared edge -> anchor, must keep
+  // count 2 = shared edge -> not an anchor, can remove
+  // count 4 = shared corner -> anchor, must keep
+  auto& anchors = scratch.anchors;
+  anchors.clear();
+  for (int i = 0; i < period; i++)
+    if ((!closed && (i == 0 || i == n - 1)) || (counts[i] != 0 && counts[i] != 2))
+      anchors.push_back(i);
 
-    const int num_anchors = anchor_indices.size();
+  if (anchors.empty())
+  {
+    // Visvalingam-Whyatt on a closed ring without topology: process as linear sequence
+    scratch.x.assign(x, x + period);
+    scratch.y.assign(y, y + period);
+    simplify_vw(scratch, period, theTolerance);
+    std::copy(scratch.effective.begin(), scratch.effective.end(), areas);
+  }
+  else
+  {
+    std::fill(areas, areas + period, -infinity);
+    for (int i : anchors)
+      areas[i] = infinity;
 
+    const int num_anchors = anchors.size();
     if (closed)
     {
-      // Process segments between consecutive anchors, wrapping around
       for (int a = 0; a < num_anchors; a++)
-      {
-        int start = anchor_indices[a];
-        int end = anchor_indices[(a + 1) % num_anchors];
-
-        // Collect segment points
-        std::vector<OGRPoint> seg;
-        std::vector<int> seg_indices;
-
-        for (int i = start;; i = (i + 1) % effective_n)
-        {
-          seg.push_back(all_pts[i]);
-          seg_indices.push_back(i);
-          if (i == end)
-            break;
-        }
-
-        if (seg.size() < 3)
-          continue;
-
-        std::vector<bool> seg_keep;
-        // Use a temporary copy so simplify_segment can canonicalize
-        auto seg_pts = seg;
-        simplify_segment(seg_pts, seg_keep);
-
-        for (std::size_t i = 0; i < seg_keep.size(); i++)
-          if (seg_keep[i])
-            keep[seg_indices[i]] = true;
-      }
+        simplify_segment(scratch, path, anchors[a], anchors[(a + 1) % num_anchors], theTolerance);
     }
     else
     {
-      // Process segments between consecutive anchors
       for (int a = 0; a + 1 < num_anchors; a++)
-      {
-        int start = anchor_indices[a];
-        int end = anchor_indices[a + 1];
-
-        if (end - start < 2)
-          continue;
-
-        std::vector<OGRPoint> seg(all_pts.begin() + start, all_pts.begin() + end + 1);
-        std::vector<bool> seg_keep;
-        simplify_segment(seg, seg_keep);
-
-        for (int i = 0; i < static_cast<int>(seg_keep.size()); i++)
-          if (seg_keep[i])
-            keep[start + i] = true;
-      }
-    }
-
-    // Build output
-    auto* out = closed ? static_cast<OGRLineString*>(new OGRLinearRing) : new OGRLineString;
-    for (int i = 0; i < effective_n; i++)
-      if (keep[i])
-        out->addPoint(all_pts[i].getX(), all_pts[i].getY());
-
-    if (closed)
-    {
-      out->closeRings();
-      if (out->getNumPoints() < 4)
-      {
-        delete out;
-        return dynamic_cast<OGRLineString*>(geom->clone());
-      }
+        simplify_segment(scratch, path, anchors[a], anchors[a + 1], theTolerance);
     }
-
-    return out;
   }
-};
-
-// Forward declaration
-OGRGeometry* apply_simplify(const OGRGeometry* theGeom, LineSimplifier& simplifier);
 
-OGRLineString* apply_simplify(const OGRLineString* geom, LineSimplifier& simplifier)
-{
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    simplifier.init_counts(geom);
-    return simplifier.simplify(geom);
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  m_minimum[thePath] = *std::min_element(areas, areas + period);
 }
 
-OGRLinearRing* apply_simplify(const OGRLinearRing* geom, LineSimplifier& simplifier)
+// ----------------------------------------------------------------------
+/*!
+ * \brief Copy the vertices kept for the given tolerance
+ *
+ * Returns the number of vertices in the output, which may overlap the
+ * input. Rings are closed with the first kept vertex. Returns -1 if the
+ * path should not be modified, since nothing is removed or a ring would
+ * be left with fewer than three distinct vertices. If the path must keep
+ * a minimum number of vertices, the tolerance is lowered to keep the
+ * vertices with the largest effective areas, which are the ones the
+ * elimination would have stopped at.
+ */
+// ----------------------------------------------------------------------
+
+int PathSimplifier::filter(std::size_t thePath,
+                           double theTolerance,
+                           double* theX,
+                           double* theY) const
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    simplifier.init_counts(geom);
-    auto* result = simplifier.simplify(geom);
-    if (result == nullptr)
-      return nullptr;
-
-    // The simplify method returns the correct type (OGRLinearRing) for closed input
-    return dynamic_cast<OGRLinearRing*>(result);
-  }
-  catch (...)
+  if (theTolerance <= 0 || m_minimum[thePath] >= theTolerance)
+    return -1;
+
+  const auto& path = m_buffer.paths[thePath];
+  const double* x = m_buffer.x.data() + path.offset;
+  const double* y = m_buffer.y.data() + path.offset;
+  const double* areas = m_areas.data() + path.offset;
+  const bool closed = path.closed;
+  const int period = (closed ? path.size - 1 : path.size);
+
+  const int kept = std::count_if(
+      areas, areas + period, [theTolerance](double area) { return area >= theTolerance; });
+  if (closed && kept < 3)
+    return -1;
+
+  // Effective areas are often equal due to the monotonicity rule, hence vertices with an area
+  // equal to a lowered tolerance are kept in path order only until the minimum is reached
+  int ties = period;
+  const int keep = (m_keep.empty() ? 0 : m_keep[thePath]);
+  if (kept < keep)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    if (period <= keep)
+      return -1;
+    std::vector<double> largest(areas, areas + period);
+    std::nth_element(
+        largest.begin(), largest.begin() + keep - 1, largest.end(), std::greater<double>());
+    theTolerance = largest[keep - 1];
+    ties = keep - std::count_if(areas,
+                                areas + period,
+                                [theTolerance](double area) { return area > theTolerance; });
   }
-}
 
-OGRPolygon* apply_simplify(const OGRPolygon* geom, LineSimplifier& simplifier)
-{
-  try
+  int m = 0;
+  for (int j = 0; j < period; j++)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    auto* out = new OGRPolygon();
-    const auto* exterior = geom->getExteriorRing();
-    auto* new_exterior = apply_simplify(exterior, simplifier);
-    if (new_exterior == nullptr)
+    if (areas[j] > theTolerance || (areas[j] == theTolerance && ties-- > 0))
     {
-      delete out;
-      return nullptr;
+      theX[m] = x[j];
+      theY[m] = y[j];
+      ++m;
     }
-    out->addRingDirectly(new_exterior);
-
-    for (int i = 0, n = geom->getNumInteriorRings(); i < n; ++i)
-    {
-      const auto* hole = geom->getInteriorRing(i);
-      auto* new_hole = apply_simplify(hole, simplifier);
-      if (new_hole != nullptr)
-        out->addRingDirectly(new_hole);
-    }
-
-    return out;
   }
-  catch (...)
+  if (closed)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    theX[m] = theX[0];
+    theY[m] = theY[0];
+    ++m;
   }
+  return m;
 }
 
-OGRMultiPolygon* apply_simplify(const OGRMultiPolygon* geom, LineSimplifier& simplifier)
+void PathSimplifier::run(double theTolerance, unsigned int theThreads)
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    auto* out = new OGRMultiPolygon();
+  if (m_buffer.x.size() < parallel_limit)
+    theThreads = 1;
+
+  const auto order = m_buffer.order();
+  Parallel::run(order.size(),
+                theThreads,
+                [&](std::size_t k)
+                {
+                  const auto i = order[k];
+                  auto& path = m_buffer.paths[i];
+                  simplify(i, theTolerance);
+                  const int n = filter(i,
+                                       theTolerance,
+                                       m_buffer.x.data() + path.offset,
+                                       m_buffer.y.data() + path.offset);
+                  if (n >= 0)
+                    path.size = n;
+                });
+}
 
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
-    {
-      const auto* g = geom->getGeometryRef(i);
-      auto* new_g = apply_simplify(g, simplifier);
-      if (new_g != nullptr)
-        out->addGeometryDirectly(new_g);
-    }
+// Run the elimination to completion
+void PathSimplifier::rank(unsigned int theThreads)
+{
+  if (m_buffer.x.size() < parallel_limit)
+    theThreads = 1;
 
-    return out;
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+  const auto order = m_buffer.order();
+  Parallel::run(
+      order.size(), theThreads, [&](std::size_t k) { simplify(order[k], infinity); });
 }
 
-OGRGeometryCollection* apply_simplify(const OGRGeometryCollection* geom, LineSimplifier& simplifier)
+// Clone the ranked geometries and set the vertices kept for the tolerance. The curves of
+// the clones are visited in the same order as those of the originals.
+std::vector<OGRGeometryPtr> PathSimplifier::extract(double theTolerance) const
 {
-  try
+  const auto& geoms = m_buffer.geometries();
+  std::vector<OGRSimpleCurve*> curves;
+  std::vector<OGRGeometryPtr> result(geoms.size());
+  for (std::size_t i = 0; i < geoms.size(); i++)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    auto* out = new OGRGeometryCollection();
-
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
-    {
-      const auto* g = geom->getGeometryRef(i);
-      auto* new_g = apply_simplify(g, simplifier);
-      if (new_g != nullptr)
-        out->addGeometryDirectly(new_g);
-    }
-
-    return out;
+    if (!geoms[i])
+      continue;
+    result[i].reset(geoms[i]->clone());
+    PathBuffer::visit(result[i].get(),
+                      [&curves](OGRSimpleCurve* theCurve, bool /* theRing */)
+                      { curves.push_back(theCurve); });
   }
-  catch (...)
+
+  std::vector<double> x;
+  std::vector<double> y;
+  for (std::size_t i = 0; i < m_buffer.paths.size(); i++)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    x.resize(m_buffer.paths[i].size);
+    y.resize(m_buffer.paths[i].size);
+    const int n = filter(i, theTolerance, x.data(), y.data());
+    if (n >= 0)
+      PathBuffer::setPoints(curves[i], n, x.data(), y.data());
   }
+
+  return result;
 }
 
-OGRGeometry* apply_simplify(const OGRGeometry* geom, LineSimplifier& simplifier)
+}  // namespace
+
+void GeometrySimplifier::apply(std::vector<OGRGeometryPtr>& geoms, bool preserve_topology) const
 {
   try
   {
-    OGRwkbGeometryType id = geom->getGeometryType();
+    if (m_type == Type::None || m_tolerance <= 0)
+      return;
 
-    switch (id)
+    if (preserve_topology && m_arcs)
     {
-      case wkbMultiLineString:
-        return apply_simplify(dynamic_cast<const OGRMultiLineString*>(geom), simplifier);
-      case wkbLineString:
-        return apply_simplify(dynamic_cast<const OGRLineString*>(geom), simplifier);
-      case wkbLinearRing:
-        return apply_simplify(dynamic_cast<const OGRLinearRing*>(geom), simplifier);
-      case wkbPolygon:
-        return apply_simplify(dynamic_cast<const OGRPolygon*>(geom), simplifier);
-      case wkbMultiPolygon:
-        return apply_simplify(dynamic_cast<const OGRMultiPolygon*>(geom), simplifier);
-      case wkbGeometryCollection:
-        return apply_simplify(dynamic_cast<const OGRGeometryCollection*>(geom), simplifier);
-      default:
-        throw Fmi::Exception::Trace(
-            BCP, "Encountered an unknown geometry component while simplifying an isoline/isoband");
+      ArcTopology topology(geoms);
+      PathSimplifier simplifier(topology.arcs(), topology.counts(), topology.minimumSizes());
+      simplifier.run(m_tolerance, m_threads);
+      topology.store(geoms);
+    }
+    else
+    {
+      PathBuffer buffer(geoms);
+      PathSimplifier simplifier(buffer, preserve_topology);
+      simplifier.run(m_tolerance, m_threads);
+      buffer.store(geoms);
     }
   }
   catch (...)
@@ -476,37 +570,41 @@ OGRGeometry* apply_simplify(const OGRGeometry* geom, LineSimplifier& simplifier)
   }
 }
 
-void apply_simplify(OGRGeometryPtr& geom_ptr, LineSimplifier& simplifier)
+class ProgressiveSimplifier::Impl
 {
-  try
-  {
-    geom_ptr.reset(apply_simplify(geom_ptr.get(), simplifier));
-  }
-  catch (...)
+ public:
+  Impl(const std::vector<OGRGeometryPtr>& theGeoms,
+       bool thePreserveTopology,
+       unsigned int theThreads)
+      : buffer(theGeoms), simplifier(buffer, thePreserveTopology)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    simplifier.rank(theThreads);
   }
+
+  PathBuffer buffer;
+  PathSimplifier simplifier;
+};
+
+ProgressiveSimplifier::~ProgressiveSimplifier() = default;
+
+ProgressiveSimplifier::ProgressiveSimplifier(const std::vector<OGRGeometryPtr>& geoms,
+                                             bool preserve_topology,
+                                             unsigned int threads)
+    : impl(new Impl(geoms, preserve_topology, threads))
+{
 }
 
-}  // namespace
+std::vector<OGRGeometryPtr> ProgressiveSimplifier::extract(
+    const GeometrySimplifier& simplifier) const
+{
+  return extract(simplifier.active() ? simplifier.tolerance() : 0.0);
+}
 
-void GeometrySimplifier::apply(std::vector<OGRGeometryPtr>& geoms, bool preserve_topology) const
+std::vector<OGRGeometryPtr> ProgressiveSimplifier::extract(double tolerance) const
 {
   try
   {
-    if (m_type == Type::None || m_tolerance <= 0)
-      return;
-
-    LineSimplifier simplifier(m_tolerance);
-
-    if (preserve_topology)
-      for (const auto& geom_ptr : geoms)
-        if (geom_ptr && !geom_ptr->IsEmpty())
-          simplifier.count(geom_ptr.get());
-
-    for (auto& geom_ptr : geoms)
-      if (geom_ptr && !geom_ptr->IsEmpty())
-        apply_simplify(geom_ptr, simplifier);
+    return impl->simplifier.extract(tolerance);
   }
   catch (...)
   {
@@ -534,6 +632,8 @@ std::size_t GeometrySimplifier::hash_value() const
   {
     auto hash = Fmi::hash_value(static_cast<unsigned int>(m_type));
     Fmi::hash_combine(hash, Fmi::hash_value(m_tolerance));
+    if (m_arcs)
+      Fmi::hash_combine(hash, Fmi::hash_value(m_arcs));
     return hash;
   }
   catch (...)
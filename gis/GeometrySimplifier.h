@@ -14,6 +14,7 @@
 #pragma once
 
 #include "Types.h"
+#include <memory>
 #include <vector>
 
 namespace Fmi
@@ -32,16 +33,73 @@ class GeometrySimplifier
   std::size_t hash_value() const;
 
   void tolerance(double t) { m_tolerance = t; }
+  double tolerance() const { return m_tolerance; }
   void type(Type t) { m_type = t; }
 
   bool active() const { return m_type != Type::None && m_tolerance > 0; }
 
+  // Number of threads used to simplify the linestrings and rings of large inputs. The
+  // output does not depend on the thread count. 1 (default) disables threading, 0
+  // uses one thread per hardware core.
+  void threads(unsigned int n) { m_threads = n; }
+
+  // Simplify shared boundaries as arcs between junctions instead of freezing the vertices
+  // shared by three or more isobands. Only used when topology is preserved.
+  void arcs(bool enable) { m_arcs = enable; }
+
   void bbox(const Box& box);
   void apply(std::vector<OGRGeometryPtr>& geoms, bool preserve_topology) const;
 
  private:
   Type m_type = Type::None;
-  double m_tolerance = 0;  // pixel-area threshold (in pixel units before bbox conversion)
+  double m_tolerance = 0;      // pixel-area threshold (in pixel units before bbox conversion)
+  unsigned int m_threads = 1;  // worker threads, 0 = automatic
+  bool m_arcs = false;         // simplify arcs of the ArcTopology
+};
+
+// ======================================================================
+/*!
+ * \brief Visvalingam-Whyatt effective areas for extracting any tolerance
+ *
+ * The elimination is run to completion once and the effective area of
+ * every vertex is stored with a copy of the geometries. The effective
+ * areas never decrease in the order of elimination, hence the result for
+ * any tolerance is extracted with a linear filter, and is identical to
+ * the output of GeometrySimplifier::apply. A tile pyramid needs only one
+ * elimination pass for all zoom levels:
+ *
+ *   Fmi::ProgressiveSimplifier ranked(geoms, true);
+ *   for (const auto& box : boxes)
+ *   {
+ *     auto simplifier = base;  // pixel tolerance
+ *     simplifier.bbox(box);
+ *     auto layer = ranked.extract(simplifier);
+ *   }
+ */
+// ======================================================================
+
+class ProgressiveSimplifier
+{
+ public:
+  ~ProgressiveSimplifier();
+  ProgressiveSimplifier(const std::vector<OGRGeometryPtr>& geoms,
+                        bool preserve_topology,
+                        unsigned int threads = 1);
+  ProgressiveSimplifier() = delete;
+  ProgressiveSimplifier(const ProgressiveSimplifier& other) = delete;
+  ProgressiveSimplifier& operator=(const ProgressiveSimplifier& other) = delete;
+  ProgressiveSimplifier(ProgressiveSimplifier&& other) = delete;
+  ProgressiveSimplifier& operator=(ProgressiveSimplifier&& other) = delete;
+
+  // Simplified copies of the geometries using the tolerance of the simplifier
+  std::vector<OGRGeometryPtr> extract(const GeometrySimplifier& simplifier) const;
+
+  // Simplified copies of the geometries, tolerance in CRS coordinate units squared
+  std::vector<OGRGeometryPtr> extract(double tolerance) const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl;
 };
 
 }  // namespace Fmi
@@ -1,10 +1,16 @@
 #include "GeometrySmoother.h"
+#include "ArcTopology.h"
 #include "Box.h"
-#include "VertexCounter.h"
+#include "Parallel.h"
+#include "PathBuffer.h"
 #include <macgyver/Exception.h>
 #include <macgyver/Hash.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
 #include <ogr_geometry.h>
-#include <string>
+#include <vector>
 
 namespace Fmi
 {
@@ -12,573 +18,542 @@ namespace Fmi
 namespace
 {
 
-using Weight = std::function<double(double dist)>;
-
-// Factory method to generate a lambda function for the chosen weighting function
-Weight create_weight_lambda(GeometrySmoother::Type type, double radius)
+// ----------------------------------------------------------------------
+/*!
+ * \brief Weighting functions
+ *
+ * The weights depend on the path distance d from the vertex being
+ * smoothed and are zero for d >= radius. The vertices inside the radius
+ * are found with two pointers moving along the path, hence the kernels
+ * never see distances outside the radius. Average and Linear weights are
+ * evaluated with running window sums in O(1) per vertex, the Gaussian
+ * and Tukey weights are summed over the window with inlined functors.
+ */
+// ----------------------------------------------------------------------
+
+// Running sums over the vertices on one side of the vertex being smoothed
+struct WindowSums
 {
-  switch (type)
+  double n = 0;   // number of vertices
+  double x = 0;   // sum of coordinates
+  double y = 0;
+  double d = 0;   // sum of distances
+  double dx = 0;  // sum of distance * coordinate
+  double dy = 0;
+
+  void add(double theDistance, double theX, double theY)
   {
-    case GeometrySmoother::Type::Tukey:
-      return [radius](double dist)
-      {
-        if (dist >= radius)
-          return 0.0;
-
-        double normalizedDistance = dist / radius;
-        double t = (1.0 - (normalizedDistance * normalizedDistance));
-        return t * t;
-      };
-
-    case GeometrySmoother::Type::Linear:
-      return [radius](double dist)
-      {
-        if (dist >= radius)
-          return 0.0;
-        return (radius - dist) / radius;
-      };
-
-    case GeometrySmoother::Type::Average:
-      return [radius](double dist)
-      {
-        if (dist >= radius)
-          return 0.0;
-        return 1.0;
-      };
-
-    case GeometrySmoother::Type::Gaussian:
-    case GeometrySmoother::Type::Taubin:  // Taubin uses a Gaussian kernel for each pass
-    default:
-      return [radius](double dist)
-      {
-        if (dist >= radius)
-          return 0.0;
-
-        double sigma = 1.5 * radius;
-        return std::exp(-(dist * dist) / (2 * sigma * sigma));
-      };
+    n += 1;
+    x += theX;
+    y += theY;
+    d += theDistance;
+    dx += theDistance * theX;
+    dy += theDistance * theY;
   }
-}
 
-// Utility class to handle weighting by a distance based filter
-class LineFilter
-{
- private:
-  std::unordered_map<OGRPoint, OGRPoint, OGRPointHash, OGRPointEqual> m_cache;  // cached results
-  VertexCounter m_counter;          // how many times a vertex appears in the full geometry
-  Weight m_filter;                  // filterer
-  std::vector<double> m_distances;  // distances between adjacent vertices in current polyline
-  std::vector<int> m_counts;        // occurrance counts for current polyline
-  OGRPoint m_first_point{0, 0};
-  OGRPoint m_prev_point{0, 0};
-  int m_first_pos = 0;
-  double m_path_length = 0;
-  double m_sum_x = 0;
-  double m_sum_y = 0;
-  double m_total_weight = 0;
-  double m_relax = 1.0;  // relaxation factor: new = orig + relax*(avg - orig)
-  bool m_from_cache = false;
-  bool m_closed = false;
-  bool m_debug = false;
-
- public:
-  // relax = 1 moves each vertex all the way to the weighted average (the plain
-  // moving-average smoother). A smaller positive relax is a partial (shrinking)
-  // move; a negative relax inflates. Taubin smoothing alternates a positive and
-  // a negative relax pass to smooth without shrinking.
-  LineFilter(GeometrySmoother::Type t, double r, double relax = 1.0)
-      : m_filter(create_weight_lambda(t, r)), m_relax(relax)
+  void remove(double theDistance, double theX, double theY)
   {
+    n -= 1;
+    x -= theX;
+    y -= theY;
+    d -= theDistance;
+    dx -= theDistance * theX;
+    dy -= theDistance * theY;
   }
 
-  void init(const OGRLineString* geom)
+  // All distances change by the same amount when the centre vertex moves
+  void shift(double theDelta)
   {
-    m_closed = geom->get_IsClosed();
-    init_counts(geom);
-    init_distances(geom);
+    d += theDelta * n;
+    dx += theDelta * x;
+    dy += theDelta * y;
   }
+};
 
-  // Start filtering from a point. Returns false if smoothing at the vertex is disabled
-  bool reset(const OGRPoint* point, int i)
-  {
-    // Indicate filtering not accepted atleast yet for append()
-    m_total_weight = 0;
-    m_from_cache = false;
-    m_debug = false;
-    m_first_pos = i;
-    m_first_point = *point;
-
-    if (!allowed(i))
-      return false;
-
-    // Cannot smoothen a point if when adjacent points are not allowed either or there would
-    // be a gap beetween isobands where they diverge
-    long n = m_counts.size();
-    if (m_closed)
-    {
-      int prev = (i > 0 ? i - 1 : n - 2);  // yes, n-2 since first vertex is duplicated
-      int next = (i < n - 2 ? i + 1 : 0);
-      if (!allowed(prev) || !allowed(next))
-        return false;
-    }
-    else
-    {
-      if (i > 0 && !allowed(i - 1))
-        return false;
-      if (i < n - 1 && !allowed(i + 1))
-        return false;
-    }
-
-    // Caching guarantees there are no gaps between isobands simply due to the different winding
-    // order of the polygons
-    auto pos = m_cache.find(*point);
-    if (pos != m_cache.end())
-    {
-      m_sum_x = pos->second.getX();  // Set result to be the cached (already relaxed) value
-      m_sum_y = pos->second.getY();
-      m_total_weight = 1;
-      m_from_cache = true;
-      return false;
-    }
-
-    m_prev_point = *point;
-    m_path_length = 0;
-    m_sum_x = 0;
-    m_sum_y = 0;
-
-    return true;
-  }
+// Weighted sums for the smoothed position
+struct Sums
+{
+  double w = 0;
+  double x = 0;
+  double y = 0;
+};
 
-  void append(OGRLineString* geom)
-  {
-    if (m_total_weight == 0)
-      geom->addPoint(m_first_point.getX(), m_first_point.getY());  // filtering was not allowed
-    else if (m_from_cache)
-      geom->addPoint(m_sum_x, m_sum_y);  // already relaxed and cached, do not relax again
-    else
-    {
-      // Weighted average position, then a relaxed move towards it from the
-      // original vertex. relax==1 reproduces the plain moving average.
-      const auto avg_x = m_sum_x / m_total_weight;
-      const auto avg_y = m_sum_y / m_total_weight;
-      const auto x = m_first_point.getX() + m_relax * (avg_x - m_first_point.getX());
-      const auto y = m_first_point.getY() + m_relax * (avg_y - m_first_point.getY());
-      geom->addPoint(x, y);
-
-      m_cache.insert(std::make_pair(m_first_point, OGRPoint(x, y)));
-    }
-  }
+// Uniform weights
+struct AverageKernel
+{
+  static constexpr bool windowed = true;
 
-  // Reset accumulated path length
-  void resetPathLength()
+  Sums operator()(const WindowSums& theLeft, const WindowSums& theRight) const
   {
-    m_path_length = 0;
-    m_prev_point = m_first_point;
+    return Sums{theLeft.n + theRight.n, theLeft.x + theRight.x, theLeft.y + theRight.y};
   }
+};
 
-  // Add a point
-  bool add(const OGRLineString* geom, int j, int dist_pos)
-  {
-    const auto n = geom->getNumPoints();
-    if (j < 0)
-      j = n + j - 1;  // j=-1 becomes n-2, the last point is skipped as a duplicate of the 1st one
-    else if (j >= n)
-      j = j - n + 1;  // j=n becomes 1, 1st point is skipped as a duplicate of the last one
-
-    OGRPoint pt;
-    geom->getPoint(j, &pt);
-    if (!allowed(j))
-      return false;
-
-    if (dist_pos < 0)
-      dist_pos = n + dist_pos - 1;
-    else if (dist_pos >= n)
-      dist_pos = dist_pos - n + 1;
-
-    double dist = 0.0;
-    if (j != m_first_pos)
-      dist = distance(dist_pos);
-
-    double weight = m_filter(dist);
-    if (weight == 0)
-      return false;
-
-    m_sum_x += weight * pt.getX();
-    m_sum_y += weight * pt.getY();
-    m_total_weight += weight;
-    m_path_length = dist;
-    m_prev_point = pt;
-
-    return true;
-  }
+// Weight = (radius-d)/radius = 1 - d/radius
+struct LinearKernel
+{
+  static constexpr bool windowed = true;
+  double radius;
 
-  // Test whether the vertex is allowed in smoothing
-  bool allowed(int j)
+  Sums operator()(const WindowSums& theLeft, const WindowSums& theRight) const
   {
-    // n=0: isoline, since counting is then disabled
-    // n=1: unshared isoband edge, in practise grid edges or etc
-    // n=2: shared isoband edge
-    // n=4: shared isoband corner at a grid cell vertex
-    auto n = m_counts[j];
-    return (n == 0 || n == 2);
+    return Sums{theLeft.n + theRight.n - (theLeft.d + theRight.d) / radius,
+                theLeft.x + theRight.x - (theLeft.dx + theRight.dx) / radius,
+                theLeft.y + theRight.y - (theLeft.dy + theRight.dy) / radius};
   }
+};
 
-  // Distance metric
-  double distance(int dist_pos) const { return m_path_length + m_distances[dist_pos]; }
+// Tukey's biweight (1-(d/radius)^2)^2
+struct TukeyKernel
+{
+  static constexpr bool windowed = false;
+  double radius;
 
-  // Function to calculate the Euclidean distance between two 2D vertices
-  static double distance(const OGRPoint& v1, const OGRPoint& v2)
+  double operator()(double theDistance) const
   {
-    double x = v1.getX() - v2.getX();
-    double y = v1.getY() - v2.getY();
-    return std::hypot(x, y);
+    const double normalizedDistance = theDistance / radius;
+    const double t = (1.0 - (normalizedDistance * normalizedDistance));
+    return t * t;
   }
+};
 
-  void count(const OGRGeometry* geom) { m_counter.add(geom); }
+// Gaussian with stdev = 1.5 * radius
+struct GaussianKernel
+{
+  static constexpr bool windowed = false;
+  double denominator;  // 2 * sigma^2
 
-  // Initialize occurrance counts
-  void init_counts(const OGRLineString* geom)
+  explicit GaussianKernel(double theRadius)
   {
-    const auto n = geom->getNumPoints();
-    m_counts.clear();
-    m_counts.reserve(n);
-
-    OGRPoint pt;
-    for (int i = 0; i < n; i++)
-    {
-      geom->getPoint(i, &pt);
-      auto count = m_counter.getCount(pt);
-      m_counts.push_back(count);
-    }
+    const double sigma = 1.5 * theRadius;
+    denominator = 2 * sigma * sigma;
   }
 
-  // Calculate distances between vertices in OGRLineString/OGRLinearRing
-  void init_distances(const OGRLineString* geom)
+  double operator()(double theDistance) const
   {
-    const auto n = geom->getNumPoints();
+    return std::exp(-(theDistance * theDistance) / denominator);
+  }
+};
 
-    m_distances.clear();
-    m_distances.reserve(n);
+// Scratch buffers for a single path, reused by each thread
+struct Scratch
+{
+  std::vector<double> x;      // coordinates relative to the first vertex
+  std::vector<double> y;
+  std::vector<double> s;      // cumulative path length
+  std::vector<int> prev_bad;  // last vertex at or before this one which is frozen, or -1
+  std::vector<int> next_bad;  // first vertex at or after this one which is frozen, or size
+};
 
-    for (int i = 0; i < n - 1; i++)
-    {
-      OGRPoint v1;
-      OGRPoint v2;
-      geom->getPoint(i, &v1);
-      geom->getPoint(i + 1, &v2);
-      m_distances.push_back(LineFilter::distance(v1, v2));
-    }
+// Below this many vertices the smoothing passes are not worth distributing to threads
+const std::size_t parallel_limit = 20000;
 
-    // To simplify subsequent processing
-    if (geom->get_IsClosed())
-      m_distances.push_back(m_distances.front());
-  }
-};
+const std::size_t npos = std::numeric_limits<std::size_t>::max();
 
-// Forward declaration needed since two functions call each other
-OGRGeometry* apply_filter(const OGRGeometry* theGeom, LineFilter& filter, uint iterations);
+using Path = PathBuffer::Path;
 
-// Linestrings may be closed, in which case we handle them like linearrings
-OGRLineString* apply_filter(const OGRLineString* geom, LineFilter& filter, uint iterations)
+// A vertex whose coordinates appear more than once in the input
+struct SharedVertex
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
+  std::size_t vertex;  // position in the buffers
+  std::size_t group;   // index of the distinct coordinate among the shared ones
+};
 
-    const bool closed = (geom->get_IsClosed() == 1);
+// Smoothing is done in two phases. First all linestrings and rings are copied into
+// flat coordinate buffers, or split into arcs, and vertices with equal coordinates are
+// grouped using an open addressing hash table. The groups give the vertex counts used to
+// freeze the non-shared isoband edges. Then each pass smooths the paths independently of
+// each other into a second buffer, possibly in parallel. Shared vertices are finally
+// replaced by the value calculated for the first occurrence of the same vertex, which
+// keeps shared isoband edges bit-identical just like caching the results in a serial
+// pass would do.
+class PathSmoother
+{
+ public:
+  PathSmoother(PathBuffer& theBuffer, bool thePreserveTopology);
+  PathSmoother(PathBuffer& theBuffer, std::vector<int> theCounts);
 
-    // To avoid repeated recalculation and unordered_map fetches
-    filter.init(geom);
+  void measure();
+  void pass(GeometrySmoother::Type theType,
+            double theRadius,
+            double theRelax,
+            unsigned int theThreads);
 
-    const OGRLineString* g = geom;
-    OGRLineString* out = nullptr;
+ private:
+  void group(bool thePreserveTopology);
+  template <typename Kernel>
+  void run(const Kernel& theKernel, double theRadius, double theRelax, unsigned int theThreads);
+  template <typename Kernel>
+  void smooth(const Path& thePath, const Kernel& theKernel, double theRadius, double theRelax);
+  void reconcile();
+
+  PathBuffer& m_buffer;               // input coordinates of the current pass
+  std::vector<std::size_t> m_order;  // paths, largest first
+
+  std::vector<double> m_new_x;            // output coordinates of the current pass
+  std::vector<double> m_new_y;
+  std::vector<double> m_distances;        // distance to the next vertex
+  std::vector<int> m_counts;              // occurrence counts of the vertices
+  std::vector<unsigned char> m_smoothed;  // vertex was eligible for smoothing in this pass
+  std::vector<SharedVertex> m_shared;     // shared vertices in input order
+  std::vector<std::size_t> m_owners;      // first smoothed vertex of each shared group
+};
 
-    OGRPoint v1;
+PathSmoother::PathSmoother(PathBuffer& theBuffer, bool thePreserveTopology)
+    : m_buffer(theBuffer)
+{
+  const auto n = m_buffer.x.size();
+  m_new_x.resize(n);
+  m_new_y.resize(n);
+  m_distances.resize(n);
+  m_smoothed.resize(n, 0);
 
-    for (uint iter = 0; iter < iterations; iter++)
-    {
-      if (iter > 0)
-        g = out;                // replace geom with filtered linestring
-      out = new OGRLineString;  // new filtered result
-
-      const int n = g->getNumPoints();
-      const int max_closed_length = n / 4;  // do not process closed rings too much
-      const int imax = (closed ? n - 2 : n - 1);
-      for (int i = 0; i <= imax; i++)
-      {
-        g->getPoint(i, &v1);
+  m_order = m_buffer.order();
 
-        if (filter.reset(&v1, i))
-        {
-          // Make sure the filter has a symmetric number of points to prevent excessive isoline
-          // shrinkage at the ends if the number of iterations is > 1. The effective smoothing
-          // radius thus shrinks when we get close to the isoline end points.
-
-          // Closed isoline stencil is always symmetric
-          int jmin = i - max_closed_length;
-          int jmax = i + max_closed_length;
-
-          if (!closed)
-          {
-            // Shorter of lengths to start (0) and end vertices (n-1)
-            auto max_offset = std::min(i - 0, n - 1 - i);
-
-            jmin = i - max_offset;  // symmetric stencil
-            jmax = i + max_offset;
-          }
-
-          // Iterate backwards until radius is reached
-          for (int j = i; j >= jmin; --j)
-            if (!filter.add(g, j, j))
-              break;
-
-          // Iterate forwards until maxdistance is reached
-          filter.resetPathLength();
-          for (int j = i + 1; j <= jmax; ++j)
-            if (!filter.add(g, j, j - 1))
-              break;
-        }
-        filter.append(out);
-      }
-      if (closed && out->getNumPoints() > 0)
-      {
-        // OGRLineString::closeRings() is a no-op (it only operates on
-        // polygon-related types). The smoothing loop processed indices
-        // 0..n-2 and wrote n-1 vertices, dropping the original closing
-        // duplicate v_{n-1}=v_0. For a closed polyline the caller still
-        // expects first==last, so explicitly append a copy of the first
-        // smoothed vertex.
-        OGRPoint first;
-        out->getPoint(0, &first);
-        out->addPoint(first.getX(), first.getY());
-      }
+  group(thePreserveTopology);
+}
 
-      if (iter > 1)
-        delete g;
-    }
+// Smooth with the given vertex counts instead of those of the coordinate groups
+PathSmoother::PathSmoother(PathBuffer& theBuffer, std::vector<int> theCounts)
+    : PathSmoother(theBuffer, false)
+{
+  m_counts = std::move(theCounts);
+}
 
-    return out;
-  }
-  catch (...)
+// Count the occurrences of the vertices and list the shared ones
+void PathSmoother::group(bool thePreserveTopology)
+{
+  const auto n = m_buffer.x.size();
+  const auto groups = m_buffer.groups();
+
+  // Counts are zero if topology is not preserved, which allows smoothing all vertices
+  m_counts.resize(n);
+  for (std::size_t v = 0; v < n; v++)
+    m_counts[v] = (thePreserveTopology ? groups.count[groups.group[v]] : 0);
+
+  // Number the shared groups in order of appearance
+  std::vector<std::size_t> shared_groups(groups.size.size(), npos);
+  std::size_t nshared = 0;
+  for (std::size_t g = 0; g < groups.size.size(); g++)
+    if (groups.size[g] > 1)
+      shared_groups[g] = nshared++;
+
+  m_owners.resize(nshared);
+  for (std::size_t v = 0; v < n; v++)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    const auto g = shared_groups[groups.group[v]];
+    if (g != npos)
+      m_shared.push_back(SharedVertex{v, g});
   }
 }
 
-// Linearrings must be filtered with wraparound. There is a risk that if the specified radius
-// is larger than the size of the ring, an averaging filter would transform all coordinates to
-// the same value.
-OGRLinearRing* apply_filter(const OGRLinearRing* geom, LineFilter& filter, uint iterations)
+// Calculate the distances between adjacent vertices. The distance from the last vertex of a
+// closed path is that of the first vertex to simplify the wraparound.
+void PathSmoother::measure()
 {
-  try
+  for (const auto& path : m_buffer.paths)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    // To avoid repeated recalculation and unordered_map fetches
-    filter.init(geom);
-
-    const OGRLinearRing* g = geom;
-    OGRLinearRing* out = nullptr;
-
-    OGRPoint v1;
-
-    for (uint iter = 0; iter < iterations; iter++)
-    {
-      if (iter > 0)
-        g = out;                // replace geom with filtered linestring
-      out = new OGRLinearRing;  // new filtered result
-
-      const int n = g->getNumPoints();
-      const int max_closed_length = n / 4;  // do not process closed rings too much
-      for (int i = 0; i < n - 1; i++)       // do not process the last point, duplicate it later
-      {
-        g->getPoint(i, &v1);
-
-        if (filter.reset(&v1, i))
-        {
-          // Iterate backwards until max radius is reached
-          const int jmin = i - max_closed_length;
-          for (int j = i; j >= jmin; --j)
-            if (!filter.add(g, j, j))
-              break;
-
-          // Iterate forwards until max radius is reached
-
-          filter.resetPathLength();
-          const int jmax = i + max_closed_length;
-          for (int j = i + 1; j <= jmax; ++j)
-            if (!filter.add(g, j, j - 1))
-              break;
-        }
-        filter.append(out);
-      }
-
-      out->closeRings();  // Make sure the ring is exactly closed, rounding errors may be present
-
-      if (iter > 1)
-        delete g;
-    }
-
-    return out;
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    const double* x = m_buffer.x.data() + path.offset;
+    const double* y = m_buffer.y.data() + path.offset;
+    double* dist = m_distances.data() + path.offset;
+    const int n = path.size;
+    for (int i = 0; i < n - 1; i++)
+      dist[i] = std::hypot(x[i + 1] - x[i], y[i + 1] - y[i]);
+    dist[n - 1] = (n > 1 ? dist[0] : 0.0);
   }
 }
 
-OGRMultiPolygon* apply_filter(const OGRMultiPolygon* geom, LineFilter& filter, uint iterations)
+// ----------------------------------------------------------------------
+/*!
+ * \brief Smooth a single path from the input buffers into the output buffers
+ *
+ * For closed paths the vertices are laid out in the scratch buffers with
+ * n/4 vertices of wraparound margin on both sides, so that the windows
+ * never need to wrap. The window of each vertex extends in both directions
+ * until the radius, a frozen vertex or the stencil limit is reached. All
+ * three limits move monotonously forward along the path, hence each vertex
+ * enters and leaves the running window sums only once.
+ */
+// ----------------------------------------------------------------------
+
+template <typename Kernel>
+void PathSmoother::smooth(const Path& thePath,
+                          const Kernel& theKernel,
+                          double theRadius,
+                          double theRelax)
 {
-  try
+  thread_local Scratch scratch;
+
+  const int n = thePath.size;
+  const double* x = m_buffer.x.data() + thePath.offset;
+  const double* y = m_buffer.y.data() + thePath.offset;
+  const double* dist = m_distances.data() + thePath.offset;
+  const int* counts = m_counts.data() + thePath.offset;
+  double* out_x = m_new_x.data() + thePath.offset;
+  double* out_y = m_new_y.data() + thePath.offset;
+  unsigned char* smoothed = m_smoothed.data() + thePath.offset;
+
+  // n=0: isoline, since counting is then disabled
+  // n=1: unshared isoband edge, in practise grid edges or etc
+  // n=2: shared isoband edge
+  // n=4: shared isoband corner at a grid cell vertex
+  auto allowed = [counts](int j) { return counts[j] == 0 || counts[j] == 2; };
+
+  // The last vertex of a closed path duplicates the first one
+  const int period = (thePath.wrap ? n - 1 : n);
+  if (period < 1)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
-
-    auto* out = new OGRMultiPolygon();
+    std::copy(x, x + n, out_x);
+    std::copy(y, y + n, out_y);
+    std::fill(smoothed, smoothed + n, 0);
+    return;
+  }
 
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
-    {
-      const auto* g = geom->getGeometryRef(i);
-      auto* new_g = apply_filter(g, filter, iterations);
-      if (new_g != nullptr)
-        out->addGeometryDirectly(new_g);
-    }
+  const int margin = (thePath.wrap ? n / 4 : 0);  // do not process closed rings too much
+  const int m = period + 2 * margin;
 
-    return out;
+  auto vertex = [&](int e)
+  {
+    if (!thePath.wrap)
+      return e;
+    const int v = (e - margin) % period;
+    return (v < 0 ? v + period : v);
+  };
+
+  scratch.x.resize(m);
+  scratch.y.resize(m);
+  scratch.s.resize(m);
+  scratch.prev_bad.resize(m);
+  scratch.next_bad.resize(m);
+
+  double* px = scratch.x.data();
+  double* py = scratch.y.data();
+  double* ps = scratch.s.data();
+  int* prev_bad = scratch.prev_bad.data();
+  int* next_bad = scratch.next_bad.data();
+
+  // Coordinates are stored relative to the first vertex to keep the running sums small
+  const double x0 = x[0];
+  const double y0 = y[0];
+
+  int bad = -1;
+  for (int e = 0; e < m; e++)
+  {
+    const int v = vertex(e);
+    px[e] = x[v] - x0;
+    py[e] = y[v] - y0;
+    ps[e] = (e == 0 ? 0.0 : ps[e - 1] + dist[vertex(e - 1)]);
+    if (!allowed(v))
+      bad = e;
+    prev_bad[e] = bad;
   }
-  catch (...)
+  bad = m;
+  for (int e = m - 1; e >= 0; e--)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    if (!allowed(vertex(e)))
+      bad = e;
+    next_bad[e] = bad;
   }
-}
 
-OGRGeometryCollection* apply_filter(const OGRGeometryCollection* geom,
-                                    LineFilter& filter,
-                                    uint iterations)
-{
-  try
+  WindowSums left;   // vertices [left_lo, left_hi] at or before the centre
+  WindowSums right;  // vertices [right_lo, right_hi] after the centre
+  int left_lo = 0;
+  int left_hi = -1;
+  int right_lo = 0;
+  int right_hi = -1;
+
+  int radius_lo = 0;  // first vertex within the radius behind the centre
+  int radius_hi = 0;  // last vertex within the radius ahead of the centre
+
+  const int imax = period - 1;
+  for (int i = 0; i <= imax; i++)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
+    const int c = i + margin;
 
-    auto* out = new OGRGeometryCollection();
+    // Make sure the filter has a symmetric number of points to prevent excessive isoline
+    // shrinkage at the ends if the number of iterations is > 1. The effective smoothing
+    // radius thus shrinks when we get close to the isoline end points. Closed isoline
+    // stencil is always symmetric.
+    const int max_offset = (thePath.wrap ? margin : std::min(i, n - 1 - i));
 
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
+    while (ps[c] - ps[radius_lo] >= theRadius)
+      ++radius_lo;
+    radius_hi = std::max(radius_hi, c);
+    while (radius_hi + 1 < m && ps[radius_hi + 1] - ps[c] < theRadius)
+      ++radius_hi;
+
+    const int lo = std::max({c - max_offset, prev_bad[c] + 1, radius_lo});
+    const int hi = std::min({c + max_offset, next_bad[c] - 1, radius_hi});
+
+    if constexpr (Kernel::windowed)
     {
-      const auto* g = geom->getGeometryRef(i);
-      auto* new_g = apply_filter(g, filter, iterations);
-      if (new_g != nullptr)
-        out->addGeometryDirectly(new_g);
-    }
+      // Move the left window to [lo,c]
+      if (lo > c || left_hi < lo)
+      {
+        left = WindowSums();
+        for (int e = lo; e <= c; e++)
+          left.add(ps[c] - ps[e], px[e], py[e]);
+      }
+      else
+      {
+        left.shift(ps[c] - ps[c - 1]);
+        for (int e = left_lo; e < lo; e++)
+          left.remove(ps[c] - ps[e], px[e], py[e]);
+        for (int e = left_hi + 1; e <= c; e++)
+          left.add(ps[c] - ps[e], px[e], py[e]);
+      }
+      left_lo = lo;
+      left_hi = c;
 
-    return out;
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
-}
+      // Move the right window to [c+1,hi]
+      if (hi <= c || right_hi <= c)
+      {
+        right = WindowSums();
+        for (int e = c + 1; e <= hi; e++)
+          right.add(ps[e] - ps[c], px[e], py[e]);
+      }
+      else
+      {
+        right.shift(ps[c - 1] - ps[c]);
+        for (int e = right_lo; e <= c; e++)
+          right.remove(ps[e] - ps[c], px[e], py[e]);
+        for (int e = right_hi + 1; e <= hi; e++)
+          right.add(ps[e] - ps[c], px[e], py[e]);
+      }
+      right_lo = c + 1;
+      right_hi = hi;
+    }
 
-OGRPolygon* apply_filter(const OGRPolygon* geom, LineFilter& filter, uint iterations)
-{
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return nullptr;
+    out_x[i] = x[i];
+    out_y[i] = y[i];
+    smoothed[i] = 0;
 
-    auto* out = new OGRPolygon();
-    const auto* exterior = geom->getExteriorRing();
-    auto* new_exterior = apply_filter(exterior, filter, iterations);
-    out->addRingDirectly(new_exterior);
+    // Cannot smoothen a point if when adjacent points are not allowed either or there would
+    // be a gap beetween isobands where they diverge
+    if (!allowed(i))
+      continue;
 
-    for (int i = 0, n = geom->getNumInteriorRings(); i < n; ++i)
+    if (thePath.closed)
     {
-      const auto* hole = geom->getInteriorRing(i);
-      auto* new_hole = apply_filter(hole, filter, iterations);
-      out->addRingDirectly(new_hole);
+      const int prev = (i > 0 ? i - 1 : n - 2);  // yes, n-2 since first vertex is duplicated
+      const int next = (i < n - 2 ? i + 1 : 0);
+      if (!allowed(prev) || !allowed(next))
+        continue;
+    }
+    else
+    {
+      if (i > 0 && !allowed(i - 1))
+        continue;
+      if (i < n - 1 && !allowed(i + 1))
+        continue;
     }
 
-    return out;
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
-}
+    smoothed[i] = 1;
 
-OGRGeometry* apply_filter(const OGRGeometry* geom, LineFilter& filter, uint iterations)
-{
-  try
-  {
-    OGRwkbGeometryType id = geom->getGeometryType();
+    Sums sums;
+    if constexpr (Kernel::windowed)
+      sums = theKernel(left, right);
+    else
+    {
+      for (int e = lo; e <= c; e++)
+      {
+        const double w = theKernel(ps[c] - ps[e]);
+        sums.w += w;
+        sums.x += w * px[e];
+        sums.y += w * py[e];
+      }
+      for (int e = c + 1; e <= hi; e++)
+      {
+        const double w = theKernel(ps[e] - ps[c]);
+        sums.w += w;
+        sums.x += w * px[e];
+        sums.y += w * py[e];
+      }
+    }
 
-    switch (id)
+    // Weighted average position, then a relaxed move towards it from the
+    // original vertex. relax==1 reproduces the plain moving average.
+    if (sums.w > 0)
     {
-      case wkbMultiLineString:
-        return apply_filter(dynamic_cast<const OGRMultiLineString*>(geom), filter, iterations);
-      case wkbLineString:
-        return apply_filter(dynamic_cast<const OGRLineString*>(geom), filter, iterations);
-      case wkbLinearRing:
-        return apply_filter(dynamic_cast<const OGRLinearRing*>(geom), filter, iterations);
-      case wkbPolygon:
-        return apply_filter(dynamic_cast<const OGRPolygon*>(geom), filter, iterations);
-      case wkbMultiPolygon:
-        return apply_filter(dynamic_cast<const OGRMultiPolygon*>(geom), filter, iterations);
-      case wkbGeometryCollection:
-        return apply_filter(dynamic_cast<const OGRGeometryCollection*>(geom), filter, iterations);
-      default:
-        throw Fmi::Exception::Trace(
-            BCP, "Encountered an unknown geometry component while filtering an isoline/isoband");
+      out_x[i] = x[i] + theRelax * (x0 + sums.x / sums.w - x[i]);
+      out_y[i] = y[i] + theRelax * (y0 + sums.y / sums.w - y[i]);
     }
   }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
+
+  if (thePath.wrap)
+    smoothed[n - 1] = 0;
 }
 
-// Apply the filter to a single geometry
-void apply_filter(OGRGeometryPtr& geom_ptr, LineFilter& filter, uint iterations)
+// Replace the smoothed shared vertices with the value of the first occurrence to keep
+// shared edges bit-identical regardless of the winding order of the polygons
+void PathSmoother::reconcile()
 {
-  try
-  {
-    geom_ptr.reset(apply_filter(geom_ptr.get(), filter, iterations));
-  }
-  catch (...)
+  std::fill(m_owners.begin(), m_owners.end(), npos);
+  for (const auto& shared : m_shared)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    const auto v = shared.vertex;
+    if (m_smoothed[v] == 0)
+      continue;
+    auto& owner = m_owners[shared.group];
+    if (owner == npos)
+      owner = v;
+    else
+    {
+      m_new_x[v] = m_new_x[owner];
+      m_new_y[v] = m_new_y[owner];
+    }
   }
+
+  // Close the paths only now since the first vertex may have been replaced
+  for (const auto& path : m_buffer.paths)
+    if (path.wrap)
+    {
+      m_new_x[path.offset + path.size - 1] = m_new_x[path.offset];
+      m_new_y[path.offset + path.size - 1] = m_new_y[path.offset];
+    }
 }
 
-// One smoothing pass over the whole set with a single relaxation factor. The
-// vertex counts are recomputed from the current (possibly already smoothed)
-// geometries so that shared isoband edges are detected by coordinate and stay
-// frozen together; the per-pass cache keeps shared edges bit-identical.
-void apply_pass(std::vector<OGRGeometryPtr>& geoms,
-                GeometrySmoother::Type kernel,
-                double radius,
-                double relax,
-                bool preserve_topology)
+template <typename Kernel>
+void PathSmoother::run(const Kernel& theKernel,
+                       double theRadius,
+                       double theRelax,
+                       unsigned int theThreads)
 {
-  try
-  {
-    LineFilter filter(kernel, radius, relax);
+  if (m_buffer.x.size() < parallel_limit)
+    theThreads = 1;
 
-    if (preserve_topology)
-      for (const auto& geom_ptr : geoms)
-        if (geom_ptr && !geom_ptr->IsEmpty())
-          filter.count(geom_ptr.get());
+  Parallel::run(m_order.size(),
+                theThreads,
+                [&](std::size_t k)
+                { smooth(m_buffer.paths[m_order[k]], theKernel, theRadius, theRelax); });
+}
 
-    for (auto& geom_ptr : geoms)
-      if (geom_ptr && !geom_ptr->IsEmpty())
-        apply_filter(geom_ptr, filter, 1);
-  }
-  catch (...)
+void PathSmoother::pass(GeometrySmoother::Type theType,
+                        double theRadius,
+                        double theRelax,
+                        unsigned int theThreads)
+{
+  switch (theType)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    case GeometrySmoother::Type::Average:
+      run(AverageKernel(), theRadius, theRelax, theThreads);
+      break;
+    case GeometrySmoother::Type::Linear:
+      run(LinearKernel{theRadius}, theRadius, theRelax, theThreads);
+      break;
+    case GeometrySmoother::Type::Tukey:
+      run(TukeyKernel{theRadius}, theRadius, theRelax, theThreads);
+      break;
+    case GeometrySmoother::Type::Gaussian:
+    case GeometrySmoother::Type::Taubin:  // Taubin uses a Gaussian kernel for each pass
+    default:
+      run(GaussianKernel(theRadius), theRadius, theRelax, theThreads);
+      break;
   }
+
+  reconcile();
+  std::swap(m_buffer.x, m_new_x);
+  std::swap(m_buffer.y, m_new_y);
 }
 
 }  // namespace
@@ -591,29 +566,49 @@ void GeometrySmoother::apply(std::vector<OGRGeometryPtr>& geoms, bool preserve_t
     if (m_type == GeometrySmoother::Type::None || m_iterations == 0 || m_radius <= 0)
       return;
 
-    if (m_type == GeometrySmoother::Type::Taubin)
+    auto smooth = [this](PathSmoother& smoother)
     {
-      // Each Taubin iteration is a shrinking (lambda) pass followed by an
-      // inflating (mu) pass, so low-frequency shape and feature sizes are
-      // preserved instead of collapsing.
-      for (uint iter = 0; iter < m_iterations; ++iter)
+      smoother.measure();
+
+      if (m_type == GeometrySmoother::Type::Taubin)
       {
-        apply_pass(geoms, GeometrySmoother::Type::Taubin, m_radius, m_lambda, preserve_topology);
-        apply_pass(geoms, GeometrySmoother::Type::Taubin, m_radius, m_mu, preserve_topology);
+        // Each Taubin iteration is a shrinking (lambda) pass followed by an
+        // inflating (mu) pass, so low-frequency shape and feature sizes are
+        // preserved instead of collapsing. The distances are measured again
+        // for each pass.
+        for (uint iter = 0; iter < m_iterations; ++iter)
+        {
+          if (iter > 0)
+            smoother.measure();
+          smoother.pass(m_type, m_radius, m_lambda, m_threads);
+          smoother.measure();
+          smoother.pass(m_type, m_radius, m_mu, m_threads);
+        }
       }
-      return;
-    }
-
-    LineFilter filter(m_type, m_radius);
-
-    if (preserve_topology)
-      for (const auto& geom_ptr : geoms)
-        if (geom_ptr && !geom_ptr->IsEmpty())
-          filter.count(geom_ptr.get());
+      else
+      {
+        // The distances of the original vertices are used for all iterations
+        for (uint iter = 0; iter < m_iterations; ++iter)
+          smoother.pass(m_type, m_radius, 1.0, m_threads);
+      }
+    };
 
-    for (auto& geom_ptr : geoms)
-      if (geom_ptr && !geom_ptr->IsEmpty())
-        apply_filter(geom_ptr, filter, m_iterations);
+    if (preserve_topology && m_arcs)
+    {
+      // Shared arcs are smoothed up to the junctions, which are restored when the
+      // paths are rebuilt
+      ArcTopology topology(geoms);
+      PathSmoother smoother(topology.arcs(), topology.counts());
+      smooth(smoother);
+      topology.store(geoms);
+    }
+    else
+    {
+      PathBuffer buffer(geoms);
+      PathSmoother smoother(buffer, preserve_topology);
+      smooth(smoother);
+      buffer.store(geoms);
+    }
   }
   catch (...)
   {
@@ -646,6 +641,8 @@ std::size_t GeometrySmoother::hash_value() const
       Fmi::hash_combine(hash, Fmi::hash_value(m_lambda));
       Fmi::hash_combine(hash, Fmi::hash_value(m_mu));
     }
+    if (m_arcs)
+      Fmi::hash_combine(hash, Fmi::hash_value(m_arcs));
     return hash;
   }
   catch (...)
@@ -37,6 +37,15 @@ class GeometrySmoother
   void lambda(double l) { m_lambda = l; }  // Taubin shrinking factor (0<lambda<1)
   void mu(double m) { m_mu = m; }          // Taubin inflating factor (mu < -lambda)
 
+  // Number of threads used to smooth the linestrings and rings of large inputs. The
+  // output does not depend on the thread count. 1 (default) disables threading, 0
+  // uses one thread per hardware core.
+  void threads(unsigned int n) { m_threads = n; }
+
+  // Smooth shared boundaries as arcs between junctions instead of freezing the vertices
+  // shared by three or more isobands. Only used when topology is preserved.
+  void arcs(bool enable) { m_arcs = enable; }
+
   void bbox(const Box& box);
   void apply(std::vector<OGRGeometryPtr>& geoms, bool preserve_topology) const;
 
@@ -51,6 +60,9 @@ class GeometrySmoother
   // inflating pass compensates for the shrinkage of the smoothing pass.
   double m_lambda = 0.5;
   double m_mu = -0.53;
+
+  unsigned int m_threads = 1;  // worker threads, 0 = automatic
+  bool m_arcs = false;         // smooth arcs of the ArcTopology
 };
 
 }  // namespace Fmi
@@ -6,6 +6,7 @@
 // ======================================================================
 
 #include "Gshhs.h"
+#include "Geodesy.h"
 
 #include <fmt/format.h>
 #include <macgyver/Exception.h>
@@ -156,12 +157,7 @@ PolygonData read_polygon(std::FILE* fp,
     ring.setPoint(k, lon, lat);
 
     if (k > 0)
-    {
-      const double avgLatRad = (lat + prev_lat) * 0.5 * M_PI / 180.0;
-      const double dLon = (lon - prev_lon) * std::cos(avgLatRad);
-      const double dLat = lat - prev_lat;
-      perimeter_km += std::sqrt(dLon * dLon + dLat * dLat) * 111.32;
-    }
+      perimeter_km += Geodesy::approximateDistance(prev_lon, prev_lat, lon, lat) / 1000.0;
     prev_lon = lon;
     prev_lat = lat;
   }
@@ -171,10 +167,8 @@ PolygonData read_polygon(std::FILE* fp,
   {
     OGRPoint first;
     ring.getPoint(0, &first);
-    const double avgLatRad = (first.getY() + prev_lat) * 0.5 * M_PI / 180.0;
-    const double dLon = (first.getX() - prev_lon) * std::cos(avgLatRad);
-    const double dLat = first.getY() - prev_lat;
-    perimeter_km += std::sqrt(dLon * dLon + dLat * dLat) * 111.32;
+    perimeter_km +=
+        Geodesy::approximateDistance(prev_lon, prev_lat, first.getX(), first.getY()) / 1000.0;
   }
 
   ring.closeRings();
@@ -83,7 +83,13 @@ GDALDataPtr Host::connect() const
           .addParameter("User", itsUsername)
           .addParameter("Port", Fmi::to_string(itsPort));
 
+    // Session settings are applied once per connection. PostGIS::read needs times in UTC and
+    // skips setting the time zone again for connections marked here.
     ptr->ExecuteSQL("SET CLIENT_ENCODING TO 'UTF8'", nullptr, nullptr);
+    ptr->ExecuteSQL("SET TIME ZONE UTC", nullptr, nullptr);
+#if GDAL_VERSION_MAJOR >= 2
+    ptr->SetMetadataItem("TIME_ZONE", "UTC", "SMARTMET");
+#endif
     return ptr;
   }
   catch (...)
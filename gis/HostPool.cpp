@@ -0,0 +1,219 @@
+#include "HostPool.h"
+#include <macgyver/Exception.h>
+#include <macgyver/StringConversion.h>
+#include <condition_variable>
+#include <mutex>
+#include <ogrsf_frmts.h>
+#include <vector>
+
+namespace Fmi
+{
+namespace
+{
+bool is_alive(const GDALDataPtr& theConnection)
+{
+  try
+  {
+    auto* result = theConnection->ExecuteSQL("SELECT 1", nullptr, nullptr);
+    if (result == nullptr)
+      return false;
+    theConnection->ReleaseResultSet(result);
+    return true;
+  }
+  catch (...)
+  {
+    return false;
+  }
+}
+}  // namespace
+
+struct HostPool::State
+{
+  State(Host theHost,
+        std::size_t theMaxConnections,
+        std::chrono::milliseconds theTimeout,
+        std::chrono::milliseconds theHealthCheckInterval)
+      : host(std::move(theHost)),
+        max_connections(theMaxConnections),
+        timeout(theTimeout),
+        health_check_interval(theHealthCheckInterval)
+  {
+  }
+
+  struct Idle
+  {
+    GDALDataPtr connection;
+    std::chrono::steady_clock::time_point since;
+  };
+
+  const Host host;
+  const std::size_t max_connections;
+  const std::chrono::milliseconds timeout;
+  const std::chrono::milliseconds health_check_interval;  // idle time before a check
+
+  mutable std::mutex mutex;
+  std::condition_variable cond;
+  std::vector<Idle> idle;  // the most recently used connection is reused first
+  std::size_t open = 0;    // idle connections and connections in use
+
+  void release(GDALDataPtr theConnection, bool theValid)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (theValid)
+        idle.push_back(Idle{std::move(theConnection), std::chrono::steady_clock::now()});
+      else
+        --open;
+    }
+    cond.notify_one();
+    // An invalidated connection is closed here outside the lock
+  }
+};
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Connection handle
+ */
+// ----------------------------------------------------------------------
+
+HostPool::Connection::Connection(std::shared_ptr<State> theState, GDALDataPtr theConnection)
+    : itsState(std::move(theState)), itsConnection(std::move(theConnection))
+{
+}
+
+HostPool::Connection::Connection(Connection&& other) noexcept
+    : itsState(std::move(other.itsState)),
+      itsConnection(std::move(other.itsConnection)),
+      itsValid(other.itsValid)
+{
+}
+
+HostPool::Connection::~Connection()
+{
+  try
+  {
+    if (itsState)
+      itsState->release(std::move(itsConnection), itsValid);
+  }
+  catch (...)
+  {
+    // Destructors must not throw
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Create an empty pool, connections are opened on demand
+ */
+// ----------------------------------------------------------------------
+
+HostPool::HostPool(Host theHost,
+                   std::size_t theMaxConnections,
+                   std::chrono::milliseconds theTimeout,
+                   std::chrono::milliseconds theHealthCheckInterval)
+    : itsState(std::make_shared<State>(
+          std::move(theHost), theMaxConnections, theTimeout, theHealthCheckInterval))
+{
+  if (theMaxConnections == 0)
+    throw Fmi::Exception(BCP, "HostPool size must be positive");
+}
+
+// Connections still in use keep the shared state alive until they are returned
+HostPool::~HostPool() = default;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Get an idle connection or open a new one
+ *
+ * Waits until a connection is returned if the maximum number of
+ * connections is in use, and throws if none becomes available in time.
+ */
+// ----------------------------------------------------------------------
+
+HostPool::Connection HostPool::get()
+{
+  try
+  {
+    auto& state = *itsState;
+    std::unique_lock<std::mutex> lock(state.mutex);
+
+    const auto available = [&state]
+    { return !state.idle.empty() || state.open < state.max_connections; };
+
+    if (!state.cond.wait_for(lock, state.timeout, available))
+      throw Fmi::Exception(BCP, "Timed out waiting for a database connection")
+          .addParameter("Connections", Fmi::to_string(state.max_connections));
+
+    GDALDataPtr conn;
+    std::chrono::steady_clock::time_point since;
+    if (!state.idle.empty())
+    {
+      conn = std::move(state.idle.back().connection);
+      since = state.idle.back().since;
+      state.idle.pop_back();
+    }
+    else
+      ++state.open;
+    lock.unlock();
+
+    try
+    {
+      // Replace broken connections, for example after a database restart
+      if (conn && std::chrono::steady_clock::now() - since > state.health_check_interval &&
+          !is_alive(conn))
+        conn.reset();
+
+      if (!conn)
+        conn = state.host.connect();
+    }
+    catch (...)
+    {
+      state.release(nullptr, false);
+      throw;
+    }
+
+    return {itsState, std::move(conn)};
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Close all idle connections
+ */
+// ----------------------------------------------------------------------
+
+void HostPool::clear()
+{
+  try
+  {
+    std::vector<State::Idle> closed;
+    {
+      std::lock_guard<std::mutex> lock(itsState->mutex);
+      closed.swap(itsState->idle);
+      itsState->open -= closed.size();
+    }
+    itsState->cond.notify_all();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::size_t HostPool::size() const
+{
+  std::lock_guard<std::mutex> lock(itsState->mutex);
+  return itsState->open;
+}
+
+std::size_t HostPool::idle() const
+{
+  std::lock_guard<std::mutex> lock(itsState->mutex);
+  return itsState->idle.size();
+}
+
+}  // namespace Fmi
@@ -0,0 +1,94 @@
+// ======================================================================
+/*!
+ * \brief Pool of open database connections to a Host
+ *
+ * Opening a PostgreSQL dataset costs a TCP connection, authentication
+ * and a scan of the layer catalogue by GDAL. The pool keeps the opened
+ * connections and hands them out one user at a time:
+ *
+ *   Fmi::HostPool pool(Fmi::Host("localhost", "gis", "reader", "secret"));
+ *   ...
+ *   auto conn = pool.get();
+ *   auto features = Fmi::PostGIS::read(&srs, conn.get(), "public.cities", fields);
+ *
+ * The connection returns to the pool when the handle is destroyed. A
+ * handle should be invalidated if the connection was found to be broken,
+ * in which case the connection is closed instead. Connections which have
+ * been idle for a while are checked before they are handed out again.
+ *
+ * Host::connect sets the session time zone to UTC and PostGIS::read
+ * trusts that setting for the lifetime of the connection. Users must not
+ * change the time zone or other session settings of a pooled connection.
+ *
+ * \note The user is responsible for calling OGRRegisterAll() in the
+ *       application init phase.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Host.h"
+#include "Types.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace Fmi
+{
+class HostPool
+{
+ private:
+  struct State;
+
+ public:
+  // Exclusive use of one connection
+  class Connection
+  {
+   public:
+    ~Connection();
+    Connection(Connection&& other) noexcept;
+    Connection(const Connection& other) = delete;
+    Connection& operator=(const Connection& other) = delete;
+    Connection& operator=(Connection&& other) = delete;
+
+    // The pointer must not be used after the handle has been destroyed
+    const GDALDataPtr& get() const { return itsConnection; }
+
+    // Close the connection instead of returning it to the pool
+    void invalidate() { itsValid = false; }
+
+   private:
+    friend class HostPool;
+    Connection(std::shared_ptr<State> theState, GDALDataPtr theConnection);
+
+    std::shared_ptr<State> itsState;
+    GDALDataPtr itsConnection;
+    bool itsValid = true;
+  };
+
+  HostPool() = delete;
+  HostPool(const HostPool& other) = delete;
+  HostPool& operator=(const HostPool& other) = delete;
+
+  // At most theMaxConnections are open at a time, get() waits at most theTimeout for one.
+  // Connections idle longer than theHealthCheckInterval are checked before reuse.
+  explicit HostPool(Host theHost,
+                    std::size_t theMaxConnections = 8,
+                    std::chrono::milliseconds theTimeout = std::chrono::seconds(30),
+                    std::chrono::milliseconds theHealthCheckInterval = std::chrono::seconds(30));
+  ~HostPool();
+
+  Connection get();
+
+  // Close the idle connections, for example after a database restart
+  void clear();
+
+  // Number of open connections, idle and in use
+  std::size_t size() const;
+  std::size_t idle() const;
+
+ private:
+  std::shared_ptr<State> itsState;
+};
+}  // namespace Fmi
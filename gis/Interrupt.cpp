@@ -1,13 +1,19 @@
 #include "Interrupt.h"
+#include "GeometryBuilder.h"
 #include "OGR.h"
 #include "ProjInfo.h"
 #include "Shape_circle.h"
 #include "Shape_rect.h"
 #include "SpatialReference.h"
 #include <boost/math/constants/constants.hpp>
+#include <macgyver/Cache.h>
 #include <macgyver/Exception.h>
+#include <macgyver/Hash.h>
+#include <macgyver/StaticCleanup.h>
 #include <memory>
+#include <optional>
 #include <ogr_geometry.h>
+#include <vector>
 #include <ogr_spatialref.h>
 
 namespace Fmi
@@ -18,6 +24,21 @@ const double wgs84radius = 6378137.0;
 
 const int default_circle_segments = 360;
 
+// A cut applied to a polygon with an envelope which overlaps the bounds and contains the
+// condition
+struct CutRule
+{
+  OGREnvelope bounds;
+  std::optional<OGREnvelope> condition;
+  std::optional<Box> box;
+  Shape_sptr shape;
+};
+
+struct InterruptCutRules
+{
+  std::vector<CutRule> rules;
+};
+
 namespace
 {
 std::shared_ptr<OGRGeometry> make_geometry_ptr(OGRGeometry* geometry)
@@ -254,9 +275,7 @@ Shape_sptr make_horizontal_cut(double lat, double lon1, double lon2)
   }
 }
 
-}  // anonymous namespace
-
-Interrupt interruptGeometry(const SpatialReference& theSRS)
+Interrupt make_interrupt(const SpatialReference& theSRS)
 {
   try
   {
@@ -282,8 +301,8 @@ Interrupt interruptGeometry(const SpatialReference& theSRS)
     // and the cut should be made for that polygon only. Hence this code is not generic enough.
     // Similar logic would be needed for the north pole should there be a polygon covering it.
     //
-    // The Interrupt struct should thus contain conditional cuts for individual polygons based
-    // on the envelope of the individual polygon. The current implementation does not support this.
+    // Such cuts can be expressed as conditionalCuts which are applied only to polygons whose
+    // envelope covers the given area, but a working cut for oblique aspects has not been found.
     //
     // The code commented out shows various tests used to find out how a nonzero lon_0 should be
     // handled, but the (random) experimental approach failed.
@@ -646,7 +665,7 @@ Interrupt interruptGeometry(const SpatialReference& theSRS)
   }
 }
 
-OGREnvelope interruptEnvelope(const SpatialReference& theSRS)
+OGREnvelope make_interrupt_envelope(const SpatialReference& theSRS)
 {
   try
   {
@@ -704,4 +723,271 @@ OGREnvelope interruptEnvelope(const SpatialReference& theSRS)
   }
 }
 
+std::shared_ptr<const InterruptCutRules> cut_rules(const Interrupt& theInterrupt)
+{
+  try
+  {
+    auto result = std::make_shared<InterruptCutRules>();
+    auto& rules = result->rules;
+
+    for (const auto& box : theInterrupt.cuts)
+    {
+      CutRule rule;
+      rule.bounds.MinX = box.xmin();
+      rule.bounds.MinY = box.ymin();
+      rule.bounds.MaxX = box.xmax();
+      rule.bounds.MaxY = box.ymax();
+      rule.box = box;
+      rules.push_back(rule);
+    }
+
+    const auto shape_rule = [](const Shape_sptr& shape)
+    {
+      CutRule rule;
+      std::unique_ptr<OGRLinearRing> ring(shape->makeRing(0));
+      ring->getEnvelope(&rule.bounds);
+      rule.shape = shape;
+      return rule;
+    };
+
+    for (const auto& shape : theInterrupt.shapeCuts)
+      rules.push_back(shape_rule(shape));
+
+    for (const auto& cut : theInterrupt.conditionalCuts)
+    {
+      auto rule = shape_rule(cut.shape);
+      rule.condition = cut.condition;
+      rules.push_back(rule);
+    }
+
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// The interrupt data depends only on the spatial reference and is immutable once created
+struct InterruptData
+{
+  std::shared_ptr<const Interrupt> interrupt;
+  OGREnvelope envelope;
+};
+
+const std::size_t default_cache_size = 1000;
+using InterruptCache = Cache::Cache<std::size_t, std::shared_ptr<const InterruptData>>;
+
+InterruptCache& interrupt_cache()
+{
+  static InterruptCache g_interruptCache{default_cache_size};
+  static StaticCleanup cleanup([]() { g_interruptCache.clear(); });
+  return g_interruptCache;
+}
+
+std::shared_ptr<const InterruptData> interrupt_data(const SpatialReference& theSRS)
+{
+  try
+  {
+    // The rules are based on the PROJ parameters which may not all be preserved in the WKT
+    auto hash = theSRS.hashValue();
+    Fmi::hash_combine(hash, Fmi::hash_value(theSRS.projStr()));
+
+    auto obj = interrupt_cache().find(hash);
+    if (obj)
+      return *obj;
+
+    auto data = std::make_shared<InterruptData>();
+    auto interrupt = make_interrupt(theSRS);
+    interrupt.cutRules = cut_rules(interrupt);
+    data->interrupt = std::make_shared<const Interrupt>(std::move(interrupt));
+    data->envelope = make_interrupt_envelope(theSRS);
+
+    interrupt_cache().insert(hash, data);
+    return data;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+bool applies(const CutRule& theRule, const OGREnvelope& theEnvelope)
+{
+  return (theRule.bounds.Intersects(theEnvelope) &&
+          (!theRule.condition || theEnvelope.Contains(*theRule.condition)));
+}
+
+// Move the parts of the geometry to the builder
+void add_parts(GeometryBuilder& theBuilder, OGRGeometry* theGeom)
+{
+  try
+  {
+    switch (wkbFlatten(theGeom->getGeometryType()))
+    {
+      case wkbPoint:
+        theBuilder.add(theGeom->toPoint());
+        return;
+      case wkbLineString:
+        theBuilder.add(theGeom->toLineString());
+        return;
+      case wkbPolygon:
+        theBuilder.add(theGeom->toPolygon());
+        return;
+      case wkbMultiPoint:
+      case wkbMultiLineString:
+      case wkbMultiPolygon:
+      case wkbGeometryCollection:
+      {
+        auto geom = make_geometry_ptr(theGeom);
+        auto* collection = theGeom->toGeometryCollection();
+        while (collection->getNumGeometries() > 0)
+        {
+          auto* part = collection->getGeometryRef(0);
+          collection->removeGeometry(0, FALSE);
+          add_parts(theBuilder, part);
+        }
+        return;
+      }
+      default:
+      {
+        OGRGeometryFactory::destroyGeometry(theGeom);
+        throw Fmi::Exception(BCP, "Unsupported geometry type in interrupt cuts");
+      }
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// Cut the components of the geometry separately
+void cut_parts(GeometryBuilder& theBuilder,
+               const OGRGeometry& theGeom,
+               const std::vector<CutRule>& theRules,
+               double theMaxSegmentLength)
+{
+  try
+  {
+    if (theGeom.IsEmpty() != 0)
+      return;
+
+    if (OGR_GT_IsSubClassOf(wkbFlatten(theGeom.getGeometryType()), wkbGeometryCollection) != 0)
+    {
+      const auto* collection = theGeom.toGeometryCollection();
+      for (int i = 0, n = collection->getNumGeometries(); i < n; ++i)
+        cut_parts(theBuilder, *collection->getGeometryRef(i), theRules, theMaxSegmentLength);
+      return;
+    }
+
+    OGREnvelope env;
+    theGeom.getEnvelope(&env);
+
+    std::unique_ptr<OGRGeometry> result;
+
+    for (const auto& rule : theRules)
+    {
+      if (!applies(rule, env))
+        continue;
+
+      const OGRGeometry& input = (result ? *result : theGeom);
+      if (rule.box)
+        result.reset(OGR::polycut(input, *rule.box, theMaxSegmentLength));
+      else
+      {
+        auto shape = rule.shape;
+        result.reset(OGR::polycut(input, shape, theMaxSegmentLength));
+      }
+
+      if (!result || result->IsEmpty() != 0)
+        return;
+    }
+
+    add_parts(theBuilder, result ? result.release() : theGeom.clone());
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // anonymous namespace
+
+OGRGeometry* interruptCut(const OGRGeometry& theGeom,
+                          const Interrupt& theInterrupt,
+                          double theMaxSegmentLength)
+{
+  try
+  {
+    // The rules of the cached interrupts are built only once
+    auto cut_data = theInterrupt.cutRules;
+    if (!cut_data)
+      cut_data = cut_rules(theInterrupt);
+    const auto& rules = cut_data->rules;
+
+    // The envelope of the whole geometry decides whether any part may need cutting
+    OGREnvelope env;
+    theGeom.getEnvelope(&env);
+
+    bool needed = false;
+    for (const auto& rule : rules)
+      needed |= applies(rule, env);
+
+    if (!needed)
+      return theGeom.clone();
+
+    GeometryBuilder builder;
+    cut_parts(builder, theGeom, rules, theMaxSegmentLength);
+
+    OGRGeometry* geom = builder.build();
+    if (geom != nullptr)
+      geom->assignSpatialReference(theGeom.getSpatialReference());
+    return geom;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::shared_ptr<const Interrupt> sharedInterruptGeometry(const SpatialReference& theSRS)
+{
+  try
+  {
+    return interrupt_data(theSRS)->interrupt;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+Interrupt interruptGeometry(const SpatialReference& theSRS)
+{
+  try
+  {
+    // The copy may be modified, hence the precomputed rules are not kept
+    auto result = *interrupt_data(theSRS)->interrupt;
+    result.cutRules.reset();
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+OGREnvelope interruptEnvelope(const SpatialReference& theSRS)
+{
+  try
+  {
+    return interrupt_data(theSRS)->envelope;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 }  // namespace Fmi
@@ -12,25 +12,49 @@ class OGREnvelope;
 
 namespace Fmi
 {
+// Cut needed only by polygons whose envelope contains the given area, for example polygons
+// covering a pole
+struct ConditionalCut
+{
+  OGREnvelope condition;
+  Shape_sptr shape;
+};
+
+// Cut rules precomputed by sharedInterruptGeometry for interruptCut
+struct InterruptCutRules;
+
 // Geographic interrupt geometry for the given spatial reference
 
 struct Interrupt
 {
   std::list<Box> cuts;
-  std::shared_ptr<OGRGeometry> andGeometry;
-  std::shared_ptr<OGRGeometry> cutGeometry;
+  std::shared_ptr<const OGRGeometry> andGeometry;
+  std::shared_ptr<const OGRGeometry> cutGeometry;
   std::list<Shape_sptr> shapeClips;
   std::list<Shape_sptr> shapeCuts;
+  std::list<ConditionalCut> conditionalCuts;
+  std::shared_ptr<const InterruptCutRules> cutRules;
 
   bool empty() const
   {
     return (cuts.empty() && !andGeometry && !cutGeometry && shapeClips.empty() &&
-            shapeCuts.empty());
+            shapeCuts.empty() && conditionalCuts.empty());
   }
 };
 
 Interrupt interruptGeometry(const SpatialReference& theSRS);
 
+// The same interrupt geometry cached per spatial reference and shared by all threads. The shapes
+// must not be modified. Copies returned by interruptGeometry share the same const geometries.
+std::shared_ptr<const Interrupt> sharedInterruptGeometry(const SpatialReference& theSRS);
+
+// Apply the box cuts, shape cuts and conditional cuts to the geometry. Each polygon, line and
+// point is cut only by the cuts whose extent its envelope overlaps, the geometry is returned
+// as is if no cut is needed. Returns nullptr if nothing remains, the caller owns the result.
+OGRGeometry* interruptCut(const OGRGeometry& theGeom,
+                          const Interrupt& theInterrupt,
+                          double theMaxSegmentLength = 0);
+
 // Estimated envelope for interrupt generation
 OGREnvelope interruptEnvelope(const SpatialReference& theSRS);
 
@@ -0,0 +1,98 @@
+#include "NumberFormat.h"
+#include <fmt/format.h>
+#include <cmath>
+
+#ifdef UNIX
+#include <double-conversion/double-conversion.h>
+#endif
+
+namespace Fmi
+{
+namespace NumberFormat
+{
+namespace
+{
+char* write_nan(char* theOut)
+{
+  std::memcpy(theOut, "NaN", 3);
+  return theOut + 3;
+}
+
+// Remove trailing zeros and the decimal point if possible
+char* trim_zeros(char* theBegin, char* theEnd)
+{
+  if (std::memchr(theBegin, '.', theEnd - theBegin) == nullptr)
+    return theEnd;
+  while (theEnd > theBegin && theEnd[-1] == '0')
+    --theEnd;
+  if (theEnd > theBegin && theEnd[-1] == '.')
+    --theEnd;
+  return theEnd;
+}
+
+}  // namespace
+
+#ifdef UNIX
+
+char* writeDouble(char* theOut, double theValue, int theDecimals)
+{
+  if (!std::isfinite(theValue))
+    return write_nan(theOut);
+
+  // Fast special case for integer formatting
+  if (theDecimals <= 0)
+  {
+    fmt::format_int f(std::lround(theValue));
+    std::memcpy(theOut, f.data(), f.size());
+    return theOut + f.size();
+  }
+
+  using namespace double_conversion;
+
+  // The converter is immutable and can be shared by all threads. NO_TRAILING_ZEROS is not
+  // available in RHEL7 yet.
+  static const DoubleToStringConverter converter(
+      DoubleToStringConverter::UNIQUE_ZERO, "Infinity", "NaN", 'e', 0, 0, 0, 0);
+
+  StringBuilder builder(theOut, static_cast<int>(MaxDoubleLength));
+  if (!converter.ToFixed(theValue, theDecimals, &builder))
+    return write_nan(theOut);
+
+  auto pos = builder.position();  // must be called before Finalize
+  builder.Finalize();             // required to avoid asserts in debug mode
+
+  return trim_zeros(theOut, theOut + pos);
+}
+
+#else
+
+// The above version is about 13 times faster since fmt has to parse the format again and again
+
+char* writeDouble(char* theOut, double theValue, int theDecimals)
+{
+  if (!std::isfinite(theValue))
+    return write_nan(theOut);
+
+  if (theDecimals <= 0)
+  {
+    fmt::format_int f(std::lround(theValue));
+    std::memcpy(theOut, f.data(), f.size());
+    return theOut + f.size();
+  }
+
+  auto result = fmt::format_to_n(theOut, MaxDoubleLength, "{:.{}f}", theValue, theDecimals);
+  auto* end = trim_zeros(theOut, result.out);
+
+  // Convert -0 to 0
+  if (end - theOut == 2 && theOut[0] == '-' && theOut[1] == '0')
+  {
+    theOut[0] = '0';
+    return theOut + 1;
+  }
+  return end;
+}
+
+#endif
+
+}  // namespace NumberFormat
+}  // namespace Fmi
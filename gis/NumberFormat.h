@@ -0,0 +1,171 @@
+// ======================================================================
+/*!
+ * \brief Fast number formatting for the geometry writers
+ *
+ * The writers output coordinates with a fixed maximum number of decimals
+ * and without trailing zeros. Coordinates which have been rounded and
+ * scaled to integers are formatted with integer arithmetic two digits at
+ * a time, other numbers with double-conversion. Integers can also be
+ * written as varints for binary output. The functions write to a caller
+ * provided buffer and return the end of the output, nothing is allocated.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Fmi
+{
+namespace NumberFormat
+{
+// Scaled integers up to this magnitude are formatted exactly by writeFixed
+constexpr double MaxFixed = 1e15;
+
+// Buffer space needed by writeFixed, writeVarint and writeDouble
+constexpr std::size_t MaxFixedLength = 24;
+constexpr std::size_t MaxVarintLength = 10;
+constexpr std::size_t MaxDoubleLength = 168;
+
+namespace detail
+{
+constexpr char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+constexpr std::uint64_t powers_of_ten[] = {1ULL,
+                                           10ULL,
+                                           100ULL,
+                                           1000ULL,
+                                           10000ULL,
+                                           100000ULL,
+                                           1000000ULL,
+                                           10000000ULL,
+                                           100000000ULL,
+                                           1000000000ULL,
+                                           10000000000ULL,
+                                           100000000000ULL,
+                                           1000000000000ULL,
+                                           10000000000000ULL,
+                                           100000000000000ULL,
+                                           1000000000000000ULL,
+                                           10000000000000000ULL,
+                                           100000000000000000ULL,
+                                           1000000000000000000ULL,
+                                           10000000000000000000ULL};
+
+// Write exactly theDigits digits of the value ending at theEnd, zero padded
+inline void write_digits(char* theEnd, std::uint64_t theValue, int theDigits)
+{
+  while (theDigits >= 2)
+  {
+    const auto pair = 2 * (theValue % 100);
+    theValue /= 100;
+    theEnd -= 2;
+    std::memcpy(theEnd, digit_pairs + pair, 2);
+    theDigits -= 2;
+  }
+  if (theDigits > 0)
+    *--theEnd = static_cast<char>('0' + theValue % 10);
+}
+
+inline int count_digits(std::uint64_t theValue)
+{
+  int n = 1;
+  while (n < 20 && theValue >= powers_of_ten[n])
+    ++n;
+  return n;
+}
+
+}  // namespace detail
+
+// Write an unsigned integer
+inline char* writeUnsigned(char* theOut, std::uint64_t theValue)
+{
+  const int n = detail::count_digits(theValue);
+  detail::write_digits(theOut + n, theValue, n);
+  return theOut + n;
+}
+
+// Write theValue / 10^theDecimals with trailing zeros and a trailing decimal point removed.
+// The decimals must be in the range 0-16.
+inline char* writeFixed(char* theOut, std::int64_t theValue, int theDecimals)
+{
+  std::uint64_t value = static_cast<std::uint64_t>(theValue);
+  if (theValue < 0)
+  {
+    *theOut++ = '-';
+    value = ~value + 1;
+  }
+
+  if (theDecimals <= 0)
+    return writeUnsigned(theOut, value);
+
+  const auto scale = detail::powers_of_ten[theDecimals];
+  theOut = writeUnsigned(theOut, value / scale);
+
+  auto fraction = value % scale;
+  if (fraction == 0)
+    return theOut;
+
+  while (fraction % 10 == 0)
+  {
+    fraction /= 10;
+    --theDecimals;
+  }
+
+  *theOut++ = '.';
+  detail::write_digits(theOut + theDecimals, fraction, theDecimals);
+  return theOut + theDecimals;
+}
+
+// Write an unsigned integer as a little endian base 128 varint
+inline char* writeVarint(char* theOut, std::uint64_t theValue)
+{
+  while (theValue >= 0x80)
+  {
+    *theOut++ = static_cast<char>((theValue & 0x7F) | 0x80);
+    theValue >>= 7;
+  }
+  *theOut++ = static_cast<char>(theValue);
+  return theOut;
+}
+
+// Write a signed integer as a zigzag encoded varint so that small negative numbers stay short
+inline char* writeZigZag(char* theOut, std::int64_t theValue)
+{
+  const auto value = static_cast<std::uint64_t>(theValue);
+  return writeVarint(theOut, (value << 1) ^ (theValue < 0 ? ~std::uint64_t{0} : 0));
+}
+
+// Write a number with at most the given number of decimals with trailing zeros and a trailing
+// decimal point removed. -0 is written as 0 and non-finite values as NaN. Requires
+// MaxDoubleLength characters of space.
+char* writeDouble(char* theOut, double theValue, int theDecimals);
+
+// As writeDouble, but numbers of reasonable magnitude are written with writeFixed. Values which
+// are within the rounding error of the scaling from a tie are left to writeDouble, hence the
+// result is rounded the same way. The decimals must be in the range 0-16.
+inline char* writeRounded(char* theOut, double theValue, int theDecimals)
+{
+  const double scaled = theValue * static_cast<double>(detail::powers_of_ten[theDecimals]);
+  const double magnitude = std::abs(scaled);
+  const double fraction = magnitude - std::floor(magnitude);
+  if (magnitude < MaxFixed && std::abs(fraction - 0.5) > magnitude * 4.5e-16)
+    return writeFixed(theOut, static_cast<std::int64_t>(std::round(scaled)), theDecimals);
+  return writeDouble(theOut, theValue, theDecimals);
+}
+
+}  // namespace NumberFormat
+}  // namespace Fmi
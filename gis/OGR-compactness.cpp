@@ -13,6 +13,7 @@
  */
 // ======================================================================
 
+#include "Geodesy.h"
 #include "OGR.h"
 
 #include <boost/math/constants/constants.hpp>
@@ -25,58 +26,6 @@
 
 namespace
 {
-constexpr double kEarthRadiusMeters = 6378137.0;
-
-// Spherical area of a closed ring on the WGS84 sphere, in m². Mirrors
-// the convention used by Fmi::OGR::despeckle's geographic_area helper:
-// the formula returns a signed result; we take the absolute value.
-double geographic_area(const OGRLineString* line)
-{
-  if (line == nullptr)
-    return 0.0;
-  const std::size_t n = line->getNumPoints();
-  if (n < 2)
-    return 0.0;
-
-  double area = 0.0;
-  for (std::size_t i = 0; i + 1 < n; ++i)
-  {
-    const double x1 = line->getX(i) * boost::math::double_constants::degree;
-    const double y1 = line->getY(i) * boost::math::double_constants::degree;
-    const double x2 = line->getX(i + 1) * boost::math::double_constants::degree;
-    const double y2 = line->getY(i + 1) * boost::math::double_constants::degree;
-    area += (x2 - x1) * (2.0 + std::sin(y1) + std::sin(y2));
-  }
-  area *= kEarthRadiusMeters * kEarthRadiusMeters / 2.0;
-  return std::abs(area);
-}
-
-// Great-circle perimeter on the WGS84 sphere, in m.
-double geographic_length(const OGRLineString* line)
-{
-  if (line == nullptr)
-    return 0.0;
-  const std::size_t n = line->getNumPoints();
-  if (n < 2)
-    return 0.0;
-
-  double total = 0.0;
-  for (std::size_t i = 0; i + 1 < n; ++i)
-  {
-    const double lon1 = line->getX(i) * boost::math::double_constants::degree;
-    const double lat1 = line->getY(i) * boost::math::double_constants::degree;
-    const double lon2 = line->getX(i + 1) * boost::math::double_constants::degree;
-    const double lat2 = line->getY(i + 1) * boost::math::double_constants::degree;
-    const double dlon = lon2 - lon1;
-    const double dlat = lat2 - lat1;
-    const double sdlat2 = std::sin(0.5 * dlat);
-    const double sdlon2 = std::sin(0.5 * dlon);
-    const double a = sdlat2 * sdlat2 + std::cos(lat1) * std::cos(lat2) * sdlon2 * sdlon2;
-    total += 2.0 * kEarthRadiusMeters * std::asin(std::min(1.0, std::sqrt(a)));
-  }
-  return total;
-}
-
 bool spatial_ref_is_geographic(const OGRSpatialReference* sr)
 {
   return (sr != nullptr) && (sr->IsGeographic() != 0);
@@ -87,7 +36,7 @@ double ring_area(const OGRLinearRing* ring, bool geographic)
   if (ring == nullptr)
     return 0.0;
   if (geographic)
-    return geographic_area(static_cast<const OGRLineString*>(ring));
+    return Fmi::Geodesy::sphericalArea(*ring);
   return std::abs(ring->get_Area());
 }
 
@@ -96,7 +45,7 @@ double ring_length(const OGRLinearRing* ring, bool geographic)
   if (ring == nullptr)
     return 0.0;
   if (geographic)
-    return geographic_length(static_cast<const OGRLineString*>(ring));
+    return Fmi::Geodesy::sphericalLength(*ring);
   return ring->get_Length();
 }
 
@@ -1,63 +1,11 @@
+#include "Geodesy.h"
 #include "OGR.h"
-#include <boost/math/constants/constants.hpp>
 #include <macgyver/Exception.h>
 #include <ogr_geometry.h>
 
 namespace
 {
 
-// ----------------------------------------------------------------------
-/*!
- * \brief Calculate area in m^2 for a geography
- *
- * Refs: Some algorithms for polygons on a sphere
- *       http://hdl.handle.net/2014/40409
- *
- *       https://trac.osgeo.org/openlayers/browser/trunk/openlayers/lib/OpenLayers/Geometry/LinearRing.js
- *
- * Note: The algorithm returns a positive number for clockwise rings.
- */
-// ----------------------------------------------------------------------
-
-double geographic_area(const OGRLineString *theGeom)
-{
-  try
-  {
-    double area = 0;
-
-    std::size_t npoints = theGeom->getNumPoints();
-
-    for (std::size_t i = 0; i < npoints - 1; i++)
-    {
-      double x1 = theGeom->getX(i) * boost::math::double_constants::degree;
-      double y1 = theGeom->getY(i) * boost::math::double_constants::degree;
-      double x2 = theGeom->getX(i + 1) * boost::math::double_constants::degree;
-      double y2 = theGeom->getY(i + 1) * boost::math::double_constants::degree;
-
-      area += (x2 - x1) * (2 + sin(y1) + sin(y2));
-    }
-    area *= 6378137.0 * 6378137.0 / 2.0;
-
-    return std::abs(area);
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
-}
-
-double geographic_area(const OGRLinearRing *theGeom)
-{
-  try
-  {
-    return geographic_area(static_cast<const OGRLineString *>(theGeom));
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
-}
-
 // ----------------------------------------------------------------------
 /*!
  * \brief get_Area substitute for OGRLineString copied from OGRLinearRing::get_Area()
@@ -106,7 +54,7 @@ OGRPolygon *despeckle_polygon(const OGRPolygon *theGeom, double theLimit, bool t
     // Quick exit if the exterior is too small
 
     const auto *exterior = theGeom->getExteriorRing();
-    double area = (theGeogFlag ? geographic_area(exterior) : exterior->get_Area());
+    double area = (theGeogFlag ? Fmi::Geodesy::sphericalArea(*exterior) : exterior->get_Area());
 
     if (area < theLimit)
       return nullptr;
@@ -121,7 +69,7 @@ OGRPolygon *despeckle_polygon(const OGRPolygon *theGeom, double theLimit, bool t
     for (int i = 0, n = theGeom->getNumInteriorRings(); i < n; ++i)
     {
       const auto *hole = theGeom->getInteriorRing(i);
-      area = (theGeogFlag ? geographic_area(hole) : hole->get_Area());
+      area = (theGeogFlag ? Fmi::Geodesy::sphericalArea(*hole) : hole->get_Area());
       if (area >= theLimit)
         out->addRingDirectly(hole->clone());
     }
@@ -154,7 +102,7 @@ OGRLineString *despeckle_linestring(const OGRLineString *theGeom, double theLimi
 
     // TODO: Old GDAL does not have get_Area for linestrings
     // double area = (theGeogFlag ? geographic_area(theGeom) : geom->get_Area());
-    double area = (theGeogFlag ? geographic_area(theGeom) : metric_area(theGeom));
+    double area = (theGeogFlag ? Fmi::Geodesy::sphericalArea(*theGeom) : metric_area(theGeom));
 
     if (area < theLimit)
       return nullptr;
@@ -1,15 +1,13 @@
 #include "Box.h"
+#include "NumberFormat.h"
 #include "OGR.h"
-#include <fmt/format.h>
-#include <fmt/printf.h>
+#include "OutputSink.h"
 #include <macgyver/Exception.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <ogr_geometry.h>
-
-// Not in use on SmartMet Editor yet
-
-#ifdef UNIX
-#include <double-conversion/double-conversion.h>
-#endif
+#include <vector>
 
 using Fmi::Box;
 
@@ -17,55 +15,168 @@ namespace
 {
 // ----------------------------------------------------------------------
 /*!
- * \brief Format a number to a local buffer and append it to string thus avoiding intermediate
- * std::string creation
+ * \brief Count the vertices for estimating the size of the output
  */
 // ----------------------------------------------------------------------
 
-#ifdef UNIX
-void append_number(std::string &out, double num, const char * /* format */, int decimals)
+std::size_t count_points(const OGRGeometry *geom)
 {
-  try
+  if (geom == nullptr || geom->IsEmpty() != 0)
+    return 0;
+
+  switch (wkbFlatten(geom->getGeometryType()))
   {
-    // Fast special case for integer formatting
-    if (decimals <= 0)
+    case wkbPoint:
+      return 1;
+    case wkbLineString:
+    case wkbLinearRing:
+      return dynamic_cast<const OGRSimpleCurve *>(geom)->getNumPoints();
+    case wkbPolygon:
     {
-      fmt::format_int f(std::lround(num));
-      out.append(f.data(), f.size());  // avoids strlen
-      return;
+      const auto *poly = dynamic_cast<const OGRPolygon *>(geom);
+      std::size_t n = count_points(poly->getExteriorRing());
+      for (int i = 0, rings = poly->getNumInteriorRings(); i < rings; ++i)
+        n += count_points(poly->getInteriorRing(i));
+      return n;
     }
+    case wkbMultiPoint:
+    case wkbMultiLineString:
+    case wkbMultiPolygon:
+    case wkbGeometryCollection:
+    {
+      const auto *coll = dynamic_cast<const OGRGeometryCollection *>(geom);
+      std::size_t n = 0;
+      for (int i = 0, parts = coll->getNumGeometries(); i < parts; ++i)
+        n += count_points(coll->getGeometryRef(i));
+      return n;
+    }
+    default:
+      return 0;
+  }
+}
 
-    using namespace double_conversion;
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether the middle vertex is on the line through its neighbours
+ *
+ * The rounded coordinates are integers, the test is exact when the cross
+ * product is. Larger turns are never considered straight.
+ */
+// ----------------------------------------------------------------------
 
-    const int kBufferSize = 168;
-    char buffer[kBufferSize];  // NOLINT(modernize-avoid-c-arrays)
-    StringBuilder builder(buffer, kBufferSize);
-    int flags = DoubleToStringConverter::UNIQUE_ZERO;
+bool straight(double x1, double y1, double x2, double y2, double x3, double y3)
+{
+  const double limit = 67108864;  // 2^26
+  const double dx1 = x2 - x1;
+  const double dy1 = y2 - y1;
+  const double dx2 = x3 - x2;
+  const double dy2 = y3 - y2;
+  if (std::abs(dx1) >= limit || std::abs(dy1) >= limit || std::abs(dx2) >= limit ||
+      std::abs(dy2) >= limit)
+    return false;
+  return dx1 * dy2 == dy1 * dx2;
+}
 
-    // Not available in RHEL7 yet:
-    // int flags = DoubleToStringConverter::UNIQUE_ZERO |
-    // DoubleToStringConverter::NO_TRAILING_ZEROS;
+// ----------------------------------------------------------------------
+/*!
+ * \brief Fused coordinate transformation and SVG path formatting
+ *
+ * The coordinates of each linestring and ring are copied out in bulk and
+ * then transformed to pixels, scaled and rounded in one pass over the
+ * arrays, which are reused for all paths. If the precision is a whole
+ * number of decimals, the rounded coordinates are integers which are
+ * formatted with integer arithmetic instead of double-conversion. The
+ * output is written directly into blocks reserved from the sink, which
+ * is given an estimate of the size of the whole geometry.
+ *
+ * The relative and binary formats work on integers in units of the last
+ * decimal, hence the deltas are exact and the positions do not drift.
+ * Paths with too large coordinates for exact integers are written in
+ * the absolute format, binary output is refused.
+ */
+// ----------------------------------------------------------------------
 
-    DoubleToStringConverter dc(flags, "Infinity", "NaN", 'e', 0, 0, 0, 0);
+class SvgWriter
+{
+ public:
+  SvgWriter(Fmi::OutputSink &theSink, const Box &theBox, const Fmi::OGR::SvgOptions &theOptions);
+
+  void write(const OGRGeometry &theGeom);
+
+ private:
+  void writeGeometry(const OGRGeometry *geom);
+  void writePoint(const OGRPoint *geom);
+  void writeCurve(const OGRSimpleCurve *geom, bool ring);
+
+  bool roundPath(int n);
+  int reducePath(int n, bool ring);
+  void toUnits(int n);
+
+  template <typename Format>
+  void writePath(int count, std::size_t maxlength, Format format);
+  void writeRelative(int count);
+  void writeBinary(char kind, int count);
+
+  Fmi::OutputCursor m_cursor;
+  const Box &m_box;
+  Fmi::OGR::SvgFormat m_format;
+  double m_rfactor;
+  int m_decimals;
+  double m_scale;  // 10^decimals
+  double m_limit;  // largest rounded value which can be formatted as an exact integer
+  bool m_fixed;    // precision is a whole number of decimals
+  bool m_reduce;   // remove redundant vertices and rings smaller than a pixel
+
+  std::vector<double> m_x;  // coordinates of the current path
+  std::vector<double> m_y;
+};
+
+SvgWriter::SvgWriter(Fmi::OutputSink &theSink,
+                     const Box &theBox,
+                     const Fmi::OGR::SvgOptions &theOptions)
+    : m_cursor(theSink), m_box(theBox), m_format(theOptions.format), m_reduce(theOptions.reduce)
+{
+  // For backwards compatibility
+  const double precision = std::max(0.0, theOptions.precision);
 
-    if (!dc.ToFixed(num, decimals, &builder))
-    {
-      out.append("NaN");
-      return;
-    }
+  // We also disallow to many useless decimals
+  m_decimals = static_cast<int>(std::min(16.0, std::ceil(precision)));
+
+  m_rfactor = pow(10.0, precision);
+  m_scale = pow(10.0, m_decimals);
+  m_limit = Fmi::NumberFormat::MaxFixed * std::min(1.0, m_rfactor / m_scale);
+  m_fixed = (precision == m_decimals);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Write the geometry as a SVG path
+ */
+// ----------------------------------------------------------------------
 
-    // Remove trailing zeros and decimal point if possible. This can be removed
-    // when NO_TRAILING_ZEROS becomes available.
+void SvgWriter::write(const OGRGeometry &theGeom)
+{
+  try
+  {
+    // Integer digits, sign, decimal point, decimals and a separator per coordinate, or a
+    // few bytes per delta in binary
+    const auto pixels = std::max<std::size_t>(1000, std::max(m_box.width(), m_box.height()));
+    const auto digits = static_cast<std::size_t>(std::log10(pixels)) + 1;
+    const auto bytes = (m_format == Fmi::OGR::SvgFormat::Binary ? 3 : digits + m_decimals + 3);
+    const auto estimate = 2 * bytes * count_points(&theGeom) + 1;
 
-    auto pos = builder.position();  // must be called before next row!
-    builder.Finalize();             // required to avoid asserts in debug mode
+    m_cursor.expect(estimate);
 
-    while (pos > 0 && buffer[pos - 1] == '0')
-      --pos;
-    if (pos > 0 && (buffer[pos - 1] == ',' || buffer[pos - 1] == '.'))
-      --pos;
+    // The binary format starts with the number of decimals
+    if (m_format == Fmi::OGR::SvgFormat::Binary)
+    {
+      char *p = m_cursor.reserve(1);
+      *p++ = static_cast<char>(m_decimals);
+      m_cursor.advance(p);
+    }
 
-    out.append(buffer, pos);
+    writeGeometry(&theGeom);
+    m_cursor.finish();
   }
   catch (...)
   {
@@ -73,345 +184,477 @@ void append_number(std::string &out, double num, const char * /* format */, int
   }
 }
 
-#else
-
-// The above version is about 13 times faster since fmt has to parse the format string again and
-// again
+// ----------------------------------------------------------------------
+/*!
+ * \brief Handle a single geometry component
+ *
+ * This could be more efficiently done if the geometries supported
+ * a visitor.
+ */
+// ----------------------------------------------------------------------
 
-void append_number(std::string &out, double num, const char *format, int /* decimals */)
+void SvgWriter::writeGeometry(const OGRGeometry *geom)
 {
   try
   {
-    char buffer[168]{};  // zero initialized; sized to match the UNIX path buffer
-    if (strcmp(format, "%.0f") == 0)
-      fmt::format_to(buffer, "%d", std::round(num));
-    else
-    {
-      fmt::format_to(buffer, format, num);
+    const OGRwkbGeometryType id = geom->getGeometryType();
 
-      // Remove trailing zeros and decimal point if possible
-      auto pos = strlen(buffer);
-      while (pos > 0 && buffer[--pos] == '0')
+    switch (wkbFlatten(id))
+    {
+      case wkbPoint:
+      {
+        writePoint(dynamic_cast<const OGRPoint *>(geom));
+        return;
+      }
+      case wkbLineString:
       {
+        writeCurve(dynamic_cast<const OGRLineString *>(geom), false);
+        return;
+      }
+      case wkbLinearRing:
+      {
+        writeCurve(dynamic_cast<const OGRLinearRing *>(geom), true);
+        return;
       }
-      if (buffer[pos] == ',' || buffer[pos] == '.')
-        buffer[pos] = '\0';
-      // Convert -0 to 0
-      if (strcmp(buffer, "-0") == 0)
+      case wkbPolygon:
       {
-        out += '0';
+        const auto *poly = dynamic_cast<const OGRPolygon *>(geom);
+        if (poly == nullptr || poly->IsEmpty() != 0)
+          return;
+        writeCurve(poly->getExteriorRing(), true);
+        for (int i = 0, n = poly->getNumInteriorRings(); i < n; ++i)
+          writeCurve(poly->getInteriorRing(i), true);
         return;
       }
+      case wkbMultiPoint:
+      case wkbMultiLineString:
+      case wkbMultiPolygon:
+      case wkbGeometryCollection:
+      {
+        const auto *coll = dynamic_cast<const OGRGeometryCollection *>(geom);
+        if (coll == nullptr || coll->IsEmpty() != 0)
+          return;
+        for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
+          writeGeometry(coll->getGeometryRef(i));
+        return;
+      }
+      default:
+      {
+        const char *pszName = OGRGeometryTypeToName(id);
+        throw Fmi::Exception::Trace(
+            BCP, "Encountered an unknown geometry component in OGR to SVG conversion")
+            .addParameter("Type", pszName);
+      }
     }
-    out.append(buffer);
   }
   catch (...)
   {
     throw Fmi::Exception::Trace(BCP, "Operation failed!");
   }
 }
-#endif
-
-// Forward declaration needed since two functions call each other
-
-void writeSVG(std::string &out,
-              const OGRGeometry *geom,
-              const Box &box,
-              double rfactor,
-              const char *format,
-              int decimals);
 
 // ----------------------------------------------------------------------
 /*!
  * \brief Handle a Point
+ *
+ * Points are not rounded before formatting.
  */
 // ----------------------------------------------------------------------
 
-void writePointSVG(
-    std::string &out, const OGRPoint *geom, const Box &box, const char *format, int decimals)
+void SvgWriter::writePoint(const OGRPoint *geom)
 {
-  try
-  {
-    if (geom != nullptr)
-    {
-      double x = geom->getX();
-      double y = geom->getY();
-      box.transform(x, y);
-      out += 'M';
-      append_number(out, x, format, decimals);
-      out += ' ';
-      append_number(out, y, format, decimals);
-    }
-  }
-  catch (...)
+  if (geom == nullptr)
+    return;
+
+  if (m_format == Fmi::OGR::SvgFormat::Binary)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    m_x.assign(1, geom->getX());
+    m_y.assign(1, geom->getY());
+    if (!roundPath(1))
+      throw Fmi::Exception(BCP, "Point coordinates too large for binary path output");
+    toUnits(1);
+    writeBinary(0, 1);
+    return;
   }
+
+  double x = geom->getX();
+  double y = geom->getY();
+  m_box.transform(x, y);
+
+  char *p = m_cursor.reserve(2 * Fmi::NumberFormat::MaxDoubleLength + 2);
+  *p++ = 'M';
+  p = Fmi::NumberFormat::writeDouble(p, x, m_decimals);
+  *p++ = ' ';
+  p = Fmi::NumberFormat::writeDouble(p, y, m_decimals);
+  m_cursor.advance(p);
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle LinearRing
+ * \brief Handle LineString and LinearRing
+ *
+ * The closing vertex of a ring is replaced by Z.
  */
 // ----------------------------------------------------------------------
 
-void writeLinearRingSVG(std::string &out,
-                        const OGRLinearRing *geom,
-                        const Box &box,
-                        double rfactor,
-                        const char *format,
-                        int decimals)
+void SvgWriter::writeCurve(const OGRSimpleCurve *geom, bool ring)
 {
-  try
+  if (geom == nullptr || geom->IsEmpty() != 0)
+    return;
+
+  int n = geom->getNumPoints();
+  m_x.resize(n);
+  m_y.resize(n);
+  geom->getPoints(m_x.data(), sizeof(double), m_y.data(), sizeof(double));
+
+  const bool fits = roundPath(n);
+  if (fits && m_reduce)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
+    n = reducePath(n, ring);
+    if (n == 0)
       return;
+  }
 
-    // Convert the numbers to rounded form
+  const int count = (ring ? n - 1 : n);
+  const int decimals = m_decimals;
 
-    const int n = geom->getNumPoints();
+  if (m_format == Fmi::OGR::SvgFormat::Binary)
+  {
+    if (!fits)
+      throw Fmi::Exception(BCP, "Path coordinates too large for binary path output");
+    toUnits(n);
+    writeBinary(ring ? 2 : 1, count);
+    return;
+  }
 
-    std::vector<double> xx(n, 0.0);
-    std::vector<double> yy(n, 0.0);
+  if (fits && m_format == Fmi::OGR::SvgFormat::Relative)
+  {
+    toUnits(n);
+    writeRelative(count);
+  }
+  else if (fits && m_fixed)
+  {
+    writePath(count,
+              Fmi::NumberFormat::MaxFixedLength,
+              [decimals](char *p, double value)
+              {
+                const auto scaled = static_cast<std::int64_t>(value);
+                return Fmi::NumberFormat::writeFixed(p, scaled, decimals);
+              });
+  }
+  else
+  {
+    double *x = m_x.data();
+    double *y = m_y.data();
     for (int i = 0; i < n; ++i)
     {
-      double x = geom->getX(i);
-      double y = geom->getY(i);
-      box.transform(x, y);
-      xx[i] = std::round(x * rfactor) / rfactor;
-      yy[i] = std::round(y * rfactor) / rfactor;
+      x[i] /= m_rfactor;
+      y[i] /= m_rfactor;
     }
+    writePath(count,
+              Fmi::NumberFormat::MaxDoubleLength,
+              [decimals](char *p, double value)
+              { return Fmi::NumberFormat::writeDouble(p, value, decimals); });
+  }
 
-    // Output the first point immediately so we don't have to test
-    // for i==0 in the inner loop
-
-    double prev_x = xx[0];
-    double prev_y = yy[0];
-
-    out += 'M';
-    append_number(out, prev_x, format, decimals);
-    out += ' ';
-    append_number(out, prev_y, format, decimals);
-
-    for (int i = 1; i < n - 1; ++i)
-    {
-      double new_x = xx[i];
-      double new_y = yy[i];
+  if (ring)
+  {
+    char *p = m_cursor.reserve(1);
+    *p++ = 'Z';
+    m_cursor.advance(p);
+  }
+}
 
-      if (new_x != prev_x || new_y != prev_y)
-      {
-        out += ' ';
-        append_number(out, new_x, format, decimals);
-        out += ' ';
-        append_number(out, new_y, format, decimals);
-        prev_x = new_x;
-        prev_y = new_y;
-      }
-    }
+// ----------------------------------------------------------------------
+/*!
+ * \brief Transform, scale and round the coordinates of the current path
+ *
+ * Returns true if the values are small enough to be formatted as exact
+ * integers.
+ */
+// ----------------------------------------------------------------------
 
-    out += 'Z';
-  }
-  catch (...)
+bool SvgWriter::roundPath(int n)
+{
+  double *x = m_x.data();
+  double *y = m_y.data();
+  const double rfactor = m_rfactor;
+  const double limit = m_limit;
+  bool fits = true;
+  for (int i = 0; i < n; ++i)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    m_box.transform(x[i], y[i]);
+    x[i] = std::round(x[i] * rfactor);
+    y[i] = std::round(y[i] * rfactor);
+    fits &= (std::abs(x[i]) < limit) & (std::abs(y[i]) < limit);
   }
+  return fits;
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle LineString
+ * \brief Remove redundant vertices from the rounded path
+ *
+ * Duplicate vertices and vertices on a straight line between their
+ * neighbours are removed, including back-tracking spikes. The remaining
+ * vertices are compacted to the start of the arrays. Rings are reduced
+ * across the closing vertex too, and are dropped by returning zero if
+ * they have no area left or fit inside one pixel. The ends of a
+ * linestring are always kept.
  */
 // ----------------------------------------------------------------------
 
-void writeLineStringSVG(std::string &out,
-                        const OGRLineString *geom,
-                        const Box &box,
-                        double rfactor,
-                        const char *format,
-                        int decimals)
+int SvgWriter::reducePath(int n, bool ring)
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return;
+  double *x = m_x.data();
+  double *y = m_y.data();
 
-    // Convert the numbers to rounded form
+  // The closing vertex of a ring is restored at the end
+  if (ring)
+    --n;
 
-    const int n = geom->getNumPoints();
+  int k = 0;  // number of vertices kept
+  for (int i = 0; i < n; ++i)
+  {
+    const double px = x[i];
+    const double py = y[i];
+    if (k > 0 && px == x[k - 1] && py == y[k - 1])
+      continue;
+    while (k >= 2 && straight(x[k - 2], y[k - 2], x[k - 1], y[k - 1], px, py))
+      --k;
+    if (k > 0 && px == x[k - 1] && py == y[k - 1])
+      continue;
+    x[k] = px;
+    y[k] = py;
+    ++k;
+  }
 
-    std::vector<double> xx(n, 0.0);
-    std::vector<double> yy(n, 0.0);
-    for (int i = 0; i < n; ++i)
-    {
-      double x = geom->getX(i);
-      double y = geom->getY(i);
-      box.transform(x, y);
-      xx[i] = std::round(x * rfactor) / rfactor;
-      yy[i] = std::round(y * rfactor) / rfactor;
-    }
+  if (!ring)
+    return k;
 
-    // Output the first point immediately so we don't have to test
-    // for i==0 in the inner loop
+  // Reduce across the closing vertex
+  int first = 0;
+  while (k - first >= 3)
+  {
+    if (x[k - 1] == x[first] && y[k - 1] == y[first])
+      --k;
+    else if (straight(x[k - 2], y[k - 2], x[k - 1], y[k - 1], x[first], y[first]))
+      --k;
+    else if (straight(x[k - 1], y[k - 1], x[first], y[first], x[first + 1], y[first + 1]))
+      ++first;
+    else
+      break;
+  }
 
-    double prev_x = xx[0];
-    double prev_y = yy[0];
+  if (k - first < 3)
+    return 0;
 
-    out += 'M';
-    append_number(out, prev_x, format, decimals);
-    out += ' ';
-    append_number(out, prev_y, format, decimals);
+  const auto xrange = std::minmax_element(x + first, x + k);
+  const auto yrange = std::minmax_element(y + first, y + k);
+  if (*xrange.second - *xrange.first < m_rfactor && *yrange.second - *yrange.first < m_rfactor)
+    return 0;
 
-    for (int i = 1; i < n; ++i)
-    {
-      double new_x = xx[i];
-      double new_y = yy[i];
+  std::copy(x + first, x + k, x);
+  std::copy(y + first, y + k, y);
+  k -= first;
+  x[k] = x[0];
+  y[k] = y[0];
+  return k + 1;
+}
 
-      if (new_x != prev_x || new_y != prev_y)
-      {
-        out += ' ';
-        append_number(out, new_x, format, decimals);
-        out += ' ';
-        append_number(out, new_y, format, decimals);
-        prev_x = new_x;
-        prev_y = new_y;
-      }
-    }
-  }
-  catch (...)
+// Convert the rounded coordinates to integers in units of the last decimal
+void SvgWriter::toUnits(int n)
+{
+  if (m_fixed)
+    return;
+
+  double *x = m_x.data();
+  double *y = m_y.data();
+  const double factor = m_scale / m_rfactor;
+  for (int i = 0; i < n; ++i)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    x[i] = std::round(x[i] * factor);
+    y[i] = std::round(y[i] * factor);
   }
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle Polygon
+ * \brief Write the first count vertices of the current path skipping duplicates
  */
 // ----------------------------------------------------------------------
 
-void writePolygonSVG(std::string &out,
-                     const OGRPolygon *geom,
-                     const Box &box,
-                     double rfactor,
-                     const char *format,
-                     int decimals)
+template <typename Format>
+void SvgWriter::writePath(int count, std::size_t maxlength, Format format)
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return;
+  const double *x = m_x.data();
+  const double *y = m_y.data();
+  const std::size_t need = 2 * maxlength + 2;
 
-    writeLinearRingSVG(out, geom->getExteriorRing(), box, rfactor, format, decimals);
-    for (int i = 0, n = geom->getNumInteriorRings(); i < n; ++i)
+  // Output the first point immediately so we don't have to test
+  // for i==0 in the inner loop
+
+  double prev_x = x[0];
+  double prev_y = y[0];
+
+  char *p = m_cursor.reserve(need);
+  *p++ = 'M';
+  p = format(p, prev_x);
+  *p++ = ' ';
+  p = format(p, prev_y);
+  m_cursor.advance(p);
+
+  for (int i = 1; i < count; ++i)
+  {
+    if (x[i] != prev_x || y[i] != prev_y)
     {
-      writeLinearRingSVG(out, geom->getInteriorRing(i), box, rfactor, format, decimals);
+      p = m_cursor.reserve(need);
+      *p++ = ' ';
+      p = format(p, x[i]);
+      *p++ = ' ';
+      p = format(p, y[i]);
+      m_cursor.advance(p);
+      prev_x = x[i];
+      prev_y = y[i];
     }
   }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle MultiPoint
+ * \brief Write the current path in units with relative commands
+ *
+ * Horizontal and vertical moves use h and v, other moves l. A command
+ * letter is written only when it changes, and numbers are separated only
+ * when the next one does not start with a minus sign.
  */
 // ----------------------------------------------------------------------
 
-void writeMultiPointSVG(
-    std::string &out, const OGRMultiPoint *geom, const Box &box, const char *format, int decimals)
+void SvgWriter::writeRelative(int count)
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return;
+  const double *x = m_x.data();
+  const double *y = m_y.data();
+  const int decimals = m_decimals;
+  const std::size_t need = 2 * Fmi::NumberFormat::MaxFixedLength + 3;
 
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
+  auto number = [decimals](char *p, std::int64_t value, bool separate)
+  {
+    if (separate && value >= 0)
+      *p++ = ' ';
+    return Fmi::NumberFormat::writeFixed(p, value, decimals);
+  };
+
+  auto prev_x = static_cast<std::int64_t>(x[0]);
+  auto prev_y = static_cast<std::int64_t>(y[0]);
+
+  char *p = m_cursor.reserve(need);
+  *p++ = 'M';
+  p = number(p, prev_x, false);
+  p = number(p, prev_y, true);
+  m_cursor.advance(p);
+
+  char command = 'M';
+  for (int i = 1; i < count; ++i)
+  {
+    const auto new_x = static_cast<std::int64_t>(x[i]);
+    const auto new_y = static_cast<std::int64_t>(y[i]);
+    const auto dx = new_x - prev_x;
+    const auto dy = new_y - prev_y;
+    if (dx == 0 && dy == 0)
+      continue;
+
+    const char next = (dy == 0 ? 'h' : (dx == 0 ? 'v' : 'l'));
+    const bool separate = (next == command);
+
+    p = m_cursor.reserve(need);
+    if (!separate)
+      *p++ = next;
+    if (next == 'h')
+      p = number(p, dx, separate);
+    else if (next == 'v')
+      p = number(p, dy, separate);
+    else
     {
-      writePointSVG(out, geom->getGeometryRef(i), box, format, decimals);
+      p = number(p, dx, separate);
+      p = number(p, dy, true);
     }
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    m_cursor.advance(p);
+
+    command = next;
+    prev_x = new_x;
+    prev_y = new_y;
   }
 }
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle MultiLineString
+ * \brief Write the current path in units in the binary format
+ *
+ * Kind 0 is a point, 1 a linestring and 2 a ring without the closing
+ * vertex. The kind byte is followed by the first vertex and for paths the
+ * number of deltas and the deltas to the following vertices, duplicates
+ * skipped.
  */
 // ----------------------------------------------------------------------
 
-void writeMultiLineStringSVG(std::string &out,
-                             const OGRMultiLineString *geom,
-                             const Box &box,
-                             double rfactor,
-                             const char *format,
-                             int decimals)
+void SvgWriter::writeBinary(char kind, int count)
 {
-  try
-  {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return;
+  const double *x = m_x.data();
+  const double *y = m_y.data();
+  const std::size_t need = 2 * Fmi::NumberFormat::MaxVarintLength;
 
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
-      writeLineStringSVG(out, geom->getGeometryRef(i), box, rfactor, format, decimals);
-  }
-  catch (...)
-  {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
-  }
-}
+  auto prev_x = static_cast<std::int64_t>(x[0]);
+  auto prev_y = static_cast<std::int64_t>(y[0]);
 
-// ----------------------------------------------------------------------
-/*!
- * \brief Handle MultiPolygon
- */
-// ----------------------------------------------------------------------
+  char *p = m_cursor.reserve(1 + 3 * Fmi::NumberFormat::MaxVarintLength);
+  *p++ = kind;
+  p = Fmi::NumberFormat::writeZigZag(p, prev_x);
+  p = Fmi::NumberFormat::writeZigZag(p, prev_y);
 
-void writeMultiPolygonSVG(std::string &out,
-                          const OGRMultiPolygon *geom,
-                          const Box &box,
-                          double rfactor,
-                          const char *format,
-                          int decimals)
-{
-  try
+  if (kind == 0)
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return;
-
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
-      writePolygonSVG(out, geom->getGeometryRef(i), box, rfactor, format, decimals);
+    m_cursor.advance(p);
+    return;
   }
-  catch (...)
+
+  std::uint64_t deltas = 0;
+  for (int i = 1; i < count; ++i)
+    deltas += (x[i] != x[i - 1] || y[i] != y[i - 1]);
+  p = Fmi::NumberFormat::writeVarint(p, deltas);
+  m_cursor.advance(p);
+
+  for (int i = 1; i < count; ++i)
   {
-    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+    const auto new_x = static_cast<std::int64_t>(x[i]);
+    const auto new_y = static_cast<std::int64_t>(y[i]);
+    if (new_x == prev_x && new_y == prev_y)
+      continue;
+    p = m_cursor.reserve(need);
+    p = Fmi::NumberFormat::writeZigZag(p, new_x - prev_x);
+    p = Fmi::NumberFormat::writeZigZag(p, new_y - prev_y);
+    m_cursor.advance(p);
+    prev_x = new_x;
+    prev_y = new_y;
   }
 }
 
+}  // namespace
+
 // ----------------------------------------------------------------------
 /*!
- * \brief Handle GeometryCollection
+ * \brief Convert the geometry to a SVG string
  */
 // ----------------------------------------------------------------------
 
-void writeGeometryCollectionSVG(std::string &out,
-                                const OGRGeometryCollection *geom,
-                                const Box &box,
-                                double rfactor,
-                                const char *format,
-                                int decimals)
+std::string Fmi::OGR::exportToSvg(const OGRGeometry &theGeom,
+                                  const Box &theBox,
+                                  double thePrecision)
 {
   try
   {
-    if (geom == nullptr || geom->IsEmpty() != 0)
-      return;
-
-    for (int i = 0, n = geom->getNumGeometries(); i < n; ++i)
-      writeSVG(out, geom->getGeometryRef(i), box, rfactor, format, decimals);
+    SvgOptions options;
+    options.precision = thePrecision;
+    return exportToSvg(theGeom, theBox, options);
   }
   catch (...)
   {
@@ -421,80 +664,20 @@ void writeGeometryCollectionSVG(std::string &out,
 
 // ----------------------------------------------------------------------
 /*!
- * \brief Write the geometry as a SVG path
- *
- * This could be more efficiently done if the geometries supported
- * a visitor.
+ * \brief Convert the geometry to a SVG path or a binary path
  */
 // ----------------------------------------------------------------------
 
-void writeSVG(std::string &out,
-              const OGRGeometry *geom,
-              const Box &box,
-              double rfactor,
-              const char *format,
-              int decimals)
+std::string Fmi::OGR::exportToSvg(const OGRGeometry &theGeom,
+                                  const Box &theBox,
+                                  const SvgOptions &theOptions)
 {
   try
   {
-    const OGRwkbGeometryType id = geom->getGeometryType();
-
-    switch (wkbFlatten(id))
-    {
-      case wkbPoint:
-      {
-        writePointSVG(out, dynamic_cast<const OGRPoint *>(geom), box, format, decimals);
-        return;
-      }
-      case wkbLineString:
-      {
-        writeLineStringSVG(
-            out, dynamic_cast<const OGRLineString *>(geom), box, rfactor, format, decimals);
-        return;
-      }
-      case wkbLinearRing:
-      {
-        writeLinearRingSVG(
-            out, dynamic_cast<const OGRLinearRing *>(geom), box, rfactor, format, decimals);
-        return;
-      }
-      case wkbPolygon:
-      {
-        writePolygonSVG(
-            out, dynamic_cast<const OGRPolygon *>(geom), box, rfactor, format, decimals);
-        return;
-      }
-      case wkbMultiPoint:
-      {
-        writeMultiPointSVG(out, dynamic_cast<const OGRMultiPoint *>(geom), box, format, decimals);
-        return;
-      }
-      case wkbMultiLineString:
-      {
-        writeMultiLineStringSVG(
-            out, dynamic_cast<const OGRMultiLineString *>(geom), box, rfactor, format, decimals);
-        return;
-      }
-      case wkbMultiPolygon:
-      {
-        writeMultiPolygonSVG(
-            out, dynamic_cast<const OGRMultiPolygon *>(geom), box, rfactor, format, decimals);
-        return;
-      }
-      case wkbGeometryCollection:
-      {
-        writeGeometryCollectionSVG(
-            out, dynamic_cast<const OGRGeometryCollection *>(geom), box, rfactor, format, decimals);
-        return;
-      }
-      default:
-      {
-        const char *pszName = OGRGeometryTypeToName(id);
-        throw Fmi::Exception::Trace(
-            BCP, "Encountered an unknown geometry component in OGR to SVG conversion")
-            .addParameter("Type", pszName);
-      }
-    }
+    std::string out;
+    BufferSink<std::string> sink(out);
+    exportToSvg(sink, theGeom, theBox, theOptions);
+    return out;
   }
   catch (...)
   {
@@ -502,32 +685,21 @@ void writeSVG(std::string &out,
   }
 }
 
-}  // namespace
-
 // ----------------------------------------------------------------------
 /*!
- * \brief Convert the geometry to a SVG string
+ * \brief Stream the geometry as a SVG path or a binary path into a sink
  */
 // ----------------------------------------------------------------------
 
-std::string Fmi::OGR::exportToSvg(const OGRGeometry &theGeom,
-                                  const Box &theBox,
-                                  double thePrecision)
+void Fmi::OGR::exportToSvg(OutputSink &theSink,
+                           const OGRGeometry &theGeom,
+                           const Box &theBox,
+                           const SvgOptions &theOptions)
 {
   try
   {
-    // For backwards compatibility
-    const double precision = std::max(0.0, thePrecision);
-
-    // We also disallow to many useless decimals
-    const int decimals = std::min(16.0, std::ceil(precision));
-
-    const double rfactor = pow(10.0, precision);
-    const std::string format = "{:." + fmt::sprintf("%d", decimals) + "f}";
-
-    std::string out;
-    writeSVG(out, &theGeom, theBox, rfactor, format.c_str(), decimals);
-    return out;
+    SvgWriter writer(theSink, theBox, theOptions);
+    writer.write(theGeom);
   }
   catch (...)
   {
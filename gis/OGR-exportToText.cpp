@@ -0,0 +1,488 @@
+#include "NumberFormat.h"
+#include "OGR.h"
+#include "OutputSink.h"
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ogr_geometry.h>
+#include <vector>
+
+namespace
+{
+// Space needed for a position and its separators
+const std::size_t max_position_length = 3 * (Fmi::NumberFormat::MaxDoubleLength + 1) + 4;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Common parts of the WKT and GeoJSON writers
+ *
+ * Coordinates are copied out in bulk and formatted directly into blocks
+ * reserved from the sink. Numbers are rounded to the given number of
+ * decimals, trailing zeros are not written.
+ */
+// ----------------------------------------------------------------------
+
+class TextWriter
+{
+ public:
+  TextWriter(Fmi::OutputSink &theSink, int thePrecision)
+      : m_cursor(theSink), m_decimals(std::clamp(thePrecision, 0, 16))
+  {
+  }
+
+ protected:
+  void literal(const char *theText) { m_cursor.append(theText, std::strlen(theText)); }
+
+  char *number(char *p, double value) const
+  {
+    return Fmi::NumberFormat::writeRounded(p, value, m_decimals);
+  }
+
+  void loadPoint(const OGRPoint *geom);
+  int loadCurve(const OGRSimpleCurve *geom);
+
+  Fmi::OutputCursor m_cursor;
+  int m_decimals;
+  bool m_3d = false;
+
+  std::vector<double> m_x;  // coordinates of the current point or path
+  std::vector<double> m_y;
+  std::vector<double> m_z;
+};
+
+void TextWriter::loadPoint(const OGRPoint *geom)
+{
+  m_x.assign(1, geom->getX());
+  m_y.assign(1, geom->getY());
+  m_z.assign(1, geom->getZ());
+}
+
+int TextWriter::loadCurve(const OGRSimpleCurve *geom)
+{
+  const int n = geom->getNumPoints();
+  m_x.resize(n);
+  m_y.resize(n);
+  m_z.resize(m_3d ? n : 0);
+  geom->getPoints(m_x.data(),
+                  sizeof(double),
+                  m_y.data(),
+                  sizeof(double),
+                  m_3d ? m_z.data() : nullptr,
+                  m_3d ? sizeof(double) : 0);
+  return n;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Streaming WKT writer
+ *
+ * The syntax is the same as in OGRGeometry::exportToWkt with the default
+ * options, 3D geometries have three coordinates without a Z tag and the
+ * points of a MULTIPOINT are not parenthesized.
+ */
+// ----------------------------------------------------------------------
+
+const char *wkt_name(OGRwkbGeometryType id)
+{
+  switch (id)
+  {
+    case wkbPoint:
+      return "POINT";
+    case wkbLineString:
+      return "LINESTRING";
+    case wkbLinearRing:
+      return "LINEARRING";
+    case wkbPolygon:
+      return "POLYGON";
+    case wkbMultiPoint:
+      return "MULTIPOINT";
+    case wkbMultiLineString:
+      return "MULTILINESTRING";
+    case wkbMultiPolygon:
+      return "MULTIPOLYGON";
+    case wkbGeometryCollection:
+      return "GEOMETRYCOLLECTION";
+    default:
+      return nullptr;
+  }
+}
+
+class WktWriter : public TextWriter
+{
+ public:
+  using TextWriter::TextWriter;
+
+  void write(const OGRGeometry &theGeom);
+
+ private:
+  void writeGeometry(const OGRGeometry *geom, bool tagged);
+  void writeCurve(const OGRSimpleCurve *geom);
+  void writePositions(int n);
+};
+
+void WktWriter::write(const OGRGeometry &theGeom)
+{
+  try
+  {
+    m_3d = (theGeom.Is3D() != 0);
+    writeGeometry(&theGeom, true);
+    m_cursor.finish();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// Components of multi geometries are written without the type name
+void WktWriter::writeGeometry(const OGRGeometry *geom, bool tagged)
+{
+  const OGRwkbGeometryType id = geom->getGeometryType();
+  const char *name = wkt_name(wkbFlatten(id));
+  if (name == nullptr)
+    throw Fmi::Exception(BCP, "Encountered an unknown geometry component in OGR to WKT conversion")
+        .addParameter("Type", OGRGeometryTypeToName(id));
+
+  if (tagged)
+  {
+    literal(name);
+    literal(" ");
+  }
+
+  if (geom->IsEmpty() != 0)
+  {
+    literal("EMPTY");
+    return;
+  }
+
+  switch (wkbFlatten(id))
+  {
+    case wkbPoint:
+    {
+      loadPoint(dynamic_cast<const OGRPoint *>(geom));
+      literal("(");
+      writePositions(1);
+      literal(")");
+      return;
+    }
+    case wkbLineString:
+    case wkbLinearRing:
+    {
+      writeCurve(dynamic_cast<const OGRSimpleCurve *>(geom));
+      return;
+    }
+    case wkbPolygon:
+    {
+      const auto *poly = dynamic_cast<const OGRPolygon *>(geom);
+      literal("(");
+      writeCurve(poly->getExteriorRing());
+      for (int i = 0, n = poly->getNumInteriorRings(); i < n; ++i)
+      {
+        literal(",");
+        writeCurve(poly->getInteriorRing(i));
+      }
+      literal(")");
+      return;
+    }
+    case wkbMultiPoint:
+    {
+      const auto *coll = dynamic_cast<const OGRGeometryCollection *>(geom);
+      literal("(");
+      for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
+      {
+        if (i > 0)
+          literal(",");
+        const auto *point = dynamic_cast<const OGRPoint *>(coll->getGeometryRef(i));
+        if (point->IsEmpty() != 0)
+          literal("EMPTY");
+        else
+        {
+          loadPoint(point);
+          writePositions(1);
+        }
+      }
+      literal(")");
+      return;
+    }
+    default:
+    {
+      const auto *coll = dynamic_cast<const OGRGeometryCollection *>(geom);
+      const bool tag_parts = (wkbFlatten(id) == wkbGeometryCollection);
+      literal("(");
+      for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
+      {
+        if (i > 0)
+          literal(",");
+        writeGeometry(coll->getGeometryRef(i), tag_parts);
+      }
+      literal(")");
+      return;
+    }
+  }
+}
+
+void WktWriter::writeCurve(const OGRSimpleCurve *geom)
+{
+  const int n = loadCurve(geom);
+  literal("(");
+  writePositions(n);
+  literal(")");
+}
+
+void WktWriter::writePositions(int n)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    char *p = m_cursor.reserve(max_position_length);
+    if (i > 0)
+      *p++ = ',';
+    p = number(p, m_x[i]);
+    *p++ = ' ';
+    p = number(p, m_y[i]);
+    if (m_3d)
+    {
+      *p++ = ' ';
+      p = number(p, m_z[i]);
+    }
+    m_cursor.advance(p);
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Streaming GeoJSON geometry writer
+ *
+ * Writes a RFC 7946 geometry object. Rings are written with the closing
+ * vertex and a standalone LinearRing as a LineString. Non-finite
+ * coordinates cannot be represented and are an error.
+ */
+// ----------------------------------------------------------------------
+
+const char *geojson_name(OGRwkbGeometryType id)
+{
+  switch (id)
+  {
+    case wkbPoint:
+      return "Point";
+    case wkbLineString:
+    case wkbLinearRing:
+      return "LineString";
+    case wkbPolygon:
+      return "Polygon";
+    case wkbMultiPoint:
+      return "MultiPoint";
+    case wkbMultiLineString:
+      return "MultiLineString";
+    case wkbMultiPolygon:
+      return "MultiPolygon";
+    case wkbGeometryCollection:
+      return "GeometryCollection";
+    default:
+      return nullptr;
+  }
+}
+
+class GeoJsonWriter : public TextWriter
+{
+ public:
+  using TextWriter::TextWriter;
+
+  void write(const OGRGeometry &theGeom);
+
+ private:
+  void writeGeometry(const OGRGeometry *geom);
+  void writeCoordinates(const OGRGeometry *geom);
+  void writeCurve(const OGRSimpleCurve *geom);
+  void writePositions(int n);
+};
+
+void GeoJsonWriter::write(const OGRGeometry &theGeom)
+{
+  try
+  {
+    m_3d = (theGeom.Is3D() != 0);
+    writeGeometry(&theGeom);
+    m_cursor.finish();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void GeoJsonWriter::writeGeometry(const OGRGeometry *geom)
+{
+  const OGRwkbGeometryType id = geom->getGeometryType();
+  const char *name = geojson_name(wkbFlatten(id));
+  if (name == nullptr)
+    throw Fmi::Exception(BCP,
+                         "Encountered an unknown geometry component in OGR to GeoJSON conversion")
+        .addParameter("Type", OGRGeometryTypeToName(id));
+
+  literal(R"({"type":")");
+  literal(name);
+
+  if (wkbFlatten(id) == wkbGeometryCollection)
+  {
+    const auto *coll = dynamic_cast<const OGRGeometryCollection *>(geom);
+    literal(R"(","geometries":[)");
+    for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
+    {
+      if (i > 0)
+        literal(",");
+      writeGeometry(coll->getGeometryRef(i));
+    }
+    literal("]}");
+    return;
+  }
+
+  literal(R"(","coordinates":)");
+  writeCoordinates(geom);
+  literal("}");
+}
+
+// Write the coordinates array of a non-collection geometry or of a component of one
+void GeoJsonWriter::writeCoordinates(const OGRGeometry *geom)
+{
+  if (geom->IsEmpty() != 0)
+  {
+    literal("[]");
+    return;
+  }
+
+  switch (wkbFlatten(geom->getGeometryType()))
+  {
+    case wkbPoint:
+    {
+      loadPoint(dynamic_cast<const OGRPoint *>(geom));
+      writePositions(1);
+      return;
+    }
+    case wkbLineString:
+    case wkbLinearRing:
+    {
+      writeCurve(dynamic_cast<const OGRSimpleCurve *>(geom));
+      return;
+    }
+    case wkbPolygon:
+    {
+      const auto *poly = dynamic_cast<const OGRPolygon *>(geom);
+      literal("[");
+      writeCurve(poly->getExteriorRing());
+      for (int i = 0, n = poly->getNumInteriorRings(); i < n; ++i)
+      {
+        literal(",");
+        writeCurve(poly->getInteriorRing(i));
+      }
+      literal("]");
+      return;
+    }
+    default:
+    {
+      const auto *coll = dynamic_cast<const OGRGeometryCollection *>(geom);
+      literal("[");
+      for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
+      {
+        if (i > 0)
+          literal(",");
+        writeCoordinates(coll->getGeometryRef(i));
+      }
+      literal("]");
+      return;
+    }
+  }
+}
+
+void GeoJsonWriter::writeCurve(const OGRSimpleCurve *geom)
+{
+  const int n = loadCurve(geom);
+  literal("[");
+  writePositions(n);
+  literal("]");
+}
+
+void GeoJsonWriter::writePositions(int n)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    if (!std::isfinite(m_x[i]) || !std::isfinite(m_y[i]) || (m_3d && !std::isfinite(m_z[i])))
+      throw Fmi::Exception(BCP, "GeoJSON cannot represent non-finite coordinates");
+
+    char *p = m_cursor.reserve(max_position_length);
+    if (i > 0)
+      *p++ = ',';
+    *p++ = '[';
+    p = number(p, m_x[i]);
+    *p++ = ',';
+    p = number(p, m_y[i]);
+    if (m_3d)
+    {
+      *p++ = ',';
+      p = number(p, m_z[i]);
+    }
+    *p++ = ']';
+    m_cursor.advance(p);
+  }
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Stream the geometry as WKT into a sink
+ */
+// ----------------------------------------------------------------------
+
+void Fmi::OGR::exportToWkt(OutputSink &theSink, const OGRGeometry &theGeom, int precision)
+{
+  try
+  {
+    WktWriter writer(theSink, precision);
+    writer.write(theGeom);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Stream the geometry as a GeoJSON geometry object into a sink
+ */
+// ----------------------------------------------------------------------
+
+void Fmi::OGR::exportToGeoJson(OutputSink &theSink, const OGRGeometry &theGeom, int precision)
+{
+  try
+  {
+    GeoJsonWriter writer(theSink, precision);
+    writer.write(theGeom);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Convert the geometry to a GeoJSON geometry object
+ */
+// ----------------------------------------------------------------------
+
+std::string Fmi::OGR::exportToGeoJson(const OGRGeometry &theGeom, int precision)
+{
+  try
+  {
+    std::string out;
+    BufferSink<std::string> sink(out);
+    exportToGeoJson(sink, theGeom, precision);
+    return out;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
@@ -1,4 +1,5 @@
 #include "OGR.h"
+#include "PreparedGeometry.h"
 #include <macgyver/Exception.h>
 #include <ogr_geometry.h>
 
@@ -204,4 +205,29 @@ bool inside(const OGRGeometry &theGeom, double theX, double theY)
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test several coordinates at once
+ *
+ * The geometry is indexed once, which pays off already for a handful of
+ * points when the geometry is large.
+ */
+// ----------------------------------------------------------------------
+
+void inside(const OGRGeometry &theGeom,
+            const double *theX,
+            const double *theY,
+            bool *theResult,
+            std::size_t theCount)
+{
+  try
+  {
+    PreparedGeometry(theGeom).inside(theX, theY, theResult, theCount);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 }  // namespace Fmi::OGR
@@ -26,6 +26,7 @@ class CoordinateTransformation;
 class Box;
 class SpatialReference;
 class GeometryBuilder;
+class OutputSink;
 class Shape;
 
 using Shape_sptr = std::shared_ptr<Shape>;
@@ -40,6 +41,36 @@ std::string exportToProj(const OGRSpatialReference& theSRS);
 std::string exportToWkt(const OGRGeometry& theGeom);
 std::string exportToSvg(const OGRGeometry& theGeom, const Box& theBox, double thePrecision);
 
+// Path syntax for exportToSvg
+enum class SvgFormat
+{
+  Absolute,  // M x y x y ... Z
+  Relative,  // M x y followed by relative l, h and v commands with minimal separators
+  Binary     // zigzag varint deltas for canvas renderers, see docs/gis-clipping.md
+};
+
+struct SvgOptions
+{
+  double precision = 1;  // decimals, fractional values give intermediate rounding steps
+  SvgFormat format = SvgFormat::Absolute;
+  bool reduce = false;  // drop redundant vertices and sub-pixel rings after rounding
+};
+
+std::string exportToSvg(const OGRGeometry& theGeom,
+                        const Box& theBox,
+                        const SvgOptions& theOptions);
+
+std::string exportToGeoJson(const OGRGeometry& theGeom, int precision);
+
+// Streaming writers appending to a sink, see OutputSink.h. The WKT and GeoJSON precision is the
+// maximum number of decimals.
+void exportToSvg(OutputSink& theSink,
+                 const OGRGeometry& theGeom,
+                 const Box& theBox,
+                 const SvgOptions& theOptions);
+void exportToWkt(OutputSink& theSink, const OGRGeometry& theGeom, int precision);
+void exportToGeoJson(OutputSink& theSink, const OGRGeometry& theGeom, int precision);
+
 // We would prefert to use a const reference here but const is
 // not possible due to SR reference counting
 OGRGeometry* importFromGeos(const geos::geom::Geometry& theGeom, OGRSpatialReference* theSRS);
@@ -115,6 +146,12 @@ void normalizeWindingOrder(OGRGeometry* theGeom);
 // Is the given coordinate inside a shape?
 bool inside(const OGRGeometry& theGeom, double theX, double theY);
 bool inside(const OGRPolygon& theGeom, double theX, double theY);
+// Batch version. Use PreparedGeometry directly when testing the same geometry repeatedly.
+void inside(const OGRGeometry& theGeom,
+            const double* theX,
+            const double* theY,
+            bool* theResult,
+            std::size_t theCount);
 
 using CoordinatePoints = std::list<std::pair<double, double>>;
 
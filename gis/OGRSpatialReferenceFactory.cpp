@@ -1,4 +1,5 @@
 #include "OGRSpatialReferenceFactory.h"
+#include "CacheKeyLog.h"
 #include "OGR.h"
 #include "ProjInfo.h"
 #include <fmt/format.h>
@@ -24,6 +25,34 @@ SpatialReferenceCache& spatialReferenceCache()
   return g_spatialReferenceCache;
 }
 
+// Descriptors inserted into the cache, for saving snapshots
+CacheKeyLog& descriptorLog()
+{
+  static CacheKeyLog g_descriptorLog(10000);
+  return g_descriptorLog;
+}
+
+// For some reason getEPSG test fails unless this conversion is done
+std::string cache_key(const std::string& theDesc)
+{
+  if (theDesc == "WGS84")
+    return "EPSG:4326";
+  return theDesc;
+}
+
+// Single line WKT2 preserves the definition when restoring from a snapshot
+std::string export_wkt2(const OGRSpatialReference& theSRS)
+{
+  const char* const options[] = {"FORMAT=WKT2", "MULTILINE=NO", nullptr};
+  char* out = nullptr;
+  auto err = theSRS.exportToWkt(&out, options);
+  std::string ret = (out != nullptr ? out : "");
+  CPLFree(out);
+  if (err != OGRERR_NONE)
+    throw Fmi::Exception(BCP, "Failed to export spatial reference to WKT2");
+  return ret;
+}
+
 // Known datums : those listed in PROJ.4 pj_datums.c
 
 std::map<std::string, std::string> known_datums = {
@@ -97,9 +126,7 @@ std::shared_ptr<OGRSpatialReference> make_crs(std::string theDesc)
     if (theDesc.empty())
       throw Fmi::Exception::Trace(BCP, "Cannot create spatial reference from empty string");
 
-    // For some reason getEPSG test fails unless this conversion is done
-    if (theDesc == "WGS84")
-      theDesc = "EPSG:4326";
+    theDesc = cache_key(theDesc);
 
     auto cacheObject = spatialReferenceCache().find(theDesc);
     if (cacheObject)
@@ -139,6 +166,7 @@ std::shared_ptr<OGRSpatialReference> make_crs(std::string theDesc)
     sr->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
 
     spatialReferenceCache().insert(theDesc, sr);
+    descriptorLog().add(theDesc);
 
     return sr;
   }
@@ -189,10 +217,81 @@ void SetCacheSize(std::size_t newMaxSize)
   }
 }
 
+void ClearCache()
+{
+  try
+  {
+    spatialReferenceCache().clear();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 Cache::CacheStats getCacheStats()
 {
   return spatialReferenceCache().statistics();
 }
 
+std::vector<std::pair<std::string, std::string>> GetCacheContents()
+{
+  try
+  {
+    std::vector<std::pair<std::string, std::string>> ret;
+    for (const auto& desc : descriptorLog().keys())
+    {
+      auto cacheObject = spatialReferenceCache().find(desc);
+      if (!cacheObject)
+        continue;
+      try
+      {
+        ret.emplace_back(desc, export_wkt2(**cacheObject));
+      }
+      catch (...)
+      {
+        // Not all PROJ definitions have a WKT2 representation, the rest are still saved
+        auto exception = Fmi::Exception::Trace(BCP, "Spatial reference not saved to the snapshot");
+        exception.addParameter("Descriptor", desc);
+        exception.printError();
+      }
+    }
+    return ret;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::shared_ptr<OGRSpatialReference> Restore(const std::string& theDesc, const std::string& theWKT)
+{
+  try
+  {
+    const auto desc = cache_key(theDesc);
+
+    auto cacheObject = spatialReferenceCache().find(desc);
+    if (cacheObject)
+      return *cacheObject;
+
+    std::shared_ptr<OGRSpatialReference> sr(new OGRSpatialReference,
+                                            [](OGRSpatialReference* ref) { ref->Release(); });
+
+    if (sr->importFromWkt(theWKT.c_str()) != OGRERR_NONE)
+      throw Fmi::Exception(BCP, "Failed to restore spatial reference: " + theDesc);
+
+    sr->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+
+    spatialReferenceCache().insert(desc, sr);
+    descriptorLog().add(desc);
+
+    return sr;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 }  // namespace OGRSpatialReferenceFactory
 }  // namespace Fmi
@@ -1,6 +1,8 @@
 #include <macgyver/Cache.h>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 class OGRSpatialReference;
 
@@ -11,8 +13,16 @@ namespace OGRSpatialReferenceFactory
 std::shared_ptr<OGRSpatialReference> Create(const std::string& theDesc);
 std::shared_ptr<OGRSpatialReference> Create(int epsg);
 void SetCacheSize(std::size_t newMaxSize);
+void ClearCache();
 // Get cache statistics
 Cache::CacheStats getCacheStats();
 
+// Cached spatial references as descriptor and single line WKT2 pairs for saving a snapshot.
+// Spatial references which cannot be exported as WKT2 are skipped with a warning.
+std::vector<std::pair<std::string, std::string>> GetCacheContents();
+
+// Cache a spatial reference rebuilt from WKT2 saved in a snapshot, unless already cached
+std::shared_ptr<OGRSpatialReference> Restore(const std::string& theDesc, const std::string& theWKT);
+
 }  // namespace OGRSpatialReferenceFactory
 }  // namespace Fmi
@@ -0,0 +1,165 @@
+#include "OutputSink.h"
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <cstring>
+
+namespace Fmi
+{
+namespace
+{
+// Largest size of the blocks the writers reserve at a time
+const std::size_t max_block_size = 16 * 1024;
+}  // namespace
+
+OutputSink::~OutputSink() = default;
+
+void OutputSink::append(const char* theText, std::size_t theSize)
+{
+  std::memcpy(reserve(theSize), theText, theSize);
+  commit(theSize);
+}
+
+// ----------------------------------------------------------------------
+
+ChunkSink::ChunkSink(std::size_t theChunkSize) : m_chunkSize(std::max<std::size_t>(1, theChunkSize))
+{
+}
+
+char* ChunkSink::reserve(std::size_t n)
+{
+  try
+  {
+    if (m_chunks.empty() || m_chunks.back().capacity - m_chunks.back().size < n)
+    {
+      const auto capacity = std::max(n, m_chunkSize);
+      // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+      m_chunks.push_back(Storage{std::unique_ptr<char[]>(new char[capacity]), 0, capacity});
+    }
+    auto& chunk = m_chunks.back();
+    return chunk.data.get() + chunk.size;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void ChunkSink::commit(std::size_t n)
+{
+  if (!m_chunks.empty())
+    m_chunks.back().size += n;
+}
+
+std::vector<ChunkSink::Chunk> ChunkSink::chunks() const
+{
+  std::vector<Chunk> result;
+  result.reserve(m_chunks.size());
+  for (const auto& chunk : m_chunks)
+    if (chunk.size > 0)
+      result.push_back(Chunk{chunk.data.get(), chunk.size});
+  return result;
+}
+
+std::size_t ChunkSink::size() const
+{
+  std::size_t n = 0;
+  for (const auto& chunk : m_chunks)
+    n += chunk.size;
+  return n;
+}
+
+// ----------------------------------------------------------------------
+
+CallbackSink::CallbackSink(Callback theCallback, std::size_t theBufferSize)
+    : m_callback(std::move(theCallback)), m_buffer(std::max<std::size_t>(1, theBufferSize))
+{
+}
+
+char* CallbackSink::reserve(std::size_t n)
+{
+  try
+  {
+    if (m_buffer.size() - m_used < n)
+    {
+      flush();
+      if (m_buffer.size() < n)
+        m_buffer.resize(n);
+    }
+    return m_buffer.data() + m_used;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void CallbackSink::commit(std::size_t n)
+{
+  m_used += n;
+}
+
+void CallbackSink::flush()
+{
+  try
+  {
+    if (m_used > 0)
+    {
+      m_callback(m_buffer.data(), m_used);
+      m_used = 0;
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+
+OutputCursor::OutputCursor(OutputSink& theSink) : m_sink(theSink), m_blockSize(max_block_size) {}
+
+OutputCursor::~OutputCursor()
+{
+  try
+  {
+    if (m_begin != nullptr)
+      m_sink.commit(m_pos - m_begin);
+  }
+  catch (...)
+  {
+    // Destructors must not throw
+  }
+}
+
+void OutputCursor::expect(std::size_t n)
+{
+  m_sink.expect(n);
+  m_blockSize = std::min(std::max<std::size_t>(n, 64), max_block_size);
+}
+
+// Commit the current block and reserve a new one, doubling the block size up to the maximum
+void OutputCursor::next(std::size_t n)
+{
+  if (m_begin != nullptr)
+    m_sink.commit(m_pos - m_begin);
+  const auto size = std::max(n, m_blockSize);
+  m_blockSize = std::min(2 * m_blockSize, max_block_size);
+  m_begin = m_pos = m_sink.reserve(size);
+  m_end = m_begin + size;
+}
+
+void OutputCursor::append(const char* theText, std::size_t theSize)
+{
+  std::memcpy(reserve(theSize), theText, theSize);
+  m_pos += theSize;
+}
+
+void OutputCursor::finish()
+{
+  if (m_begin != nullptr)
+    m_sink.commit(m_pos - m_begin);
+  m_begin = m_pos = m_end = nullptr;
+  m_sink.flush();
+}
+
+}  // namespace Fmi
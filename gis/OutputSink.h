@@ -0,0 +1,155 @@
+// ======================================================================
+/*!
+ * \brief Destinations for streamed geometry output
+ *
+ * The SVG, WKT and GeoJSON writers stream their output into a sink
+ * instead of returning a string, so that large responses can be written
+ * directly into the final buffer, into a list of chunks for scatter/gather
+ * I/O, or passed to a callback piece by piece. The writers request blocks
+ * of space with reserve(), format directly into them and commit the part
+ * they used, hence the virtual calls are made once per block instead of
+ * once per number.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Fmi
+{
+class OutputSink
+{
+ public:
+  virtual ~OutputSink();
+
+  // Space for at least n characters. Invalidated by the next call to reserve.
+  virtual char* reserve(std::size_t n) = 0;
+
+  // Keep the first n characters written to the reserved space
+  virtual void commit(std::size_t n) = 0;
+
+  // Hint on the total size of the coming output
+  virtual void expect(std::size_t /* n */) {}
+
+  // Pass the committed output onwards if the sink buffers it. Called by the writers when done.
+  virtual void flush() {}
+
+  void append(const char* theText, std::size_t theSize);
+};
+
+// Appends to a contiguous resizable buffer such as std::string, std::vector<char> or
+// fmt::memory_buffer
+template <typename Buffer>
+class BufferSink : public OutputSink
+{
+ public:
+  explicit BufferSink(Buffer& theBuffer) : m_buffer(theBuffer) {}
+
+  char* reserve(std::size_t n) override
+  {
+    m_size = m_buffer.size();
+    m_buffer.resize(m_size + n);
+    return m_buffer.data() + m_size;
+  }
+
+  void commit(std::size_t n) override { m_buffer.resize(m_size + n); }
+  void expect(std::size_t n) override { m_buffer.reserve(m_buffer.size() + n); }
+
+ private:
+  Buffer& m_buffer;
+  std::size_t m_size = 0;  // size before the last reserve
+};
+
+// Collects the output into separately allocated chunks which are never moved, for example
+// for writev. The output is never copied into one contiguous buffer.
+class ChunkSink : public OutputSink
+{
+ public:
+  struct Chunk
+  {
+    const char* data;
+    std::size_t size;
+  };
+
+  explicit ChunkSink(std::size_t theChunkSize = 64 * 1024);
+
+  char* reserve(std::size_t n) override;
+  void commit(std::size_t n) override;
+
+  std::vector<Chunk> chunks() const;
+  std::size_t size() const;
+
+ private:
+  struct Storage
+  {
+    std::unique_ptr<char[]> data;  // NOLINT(modernize-avoid-c-arrays)
+    std::size_t size;
+    std::size_t capacity;
+  };
+
+  std::size_t m_chunkSize;
+  std::vector<Storage> m_chunks;
+};
+
+// Passes the output to a callback in pieces of at most the buffer size, unless a single
+// reservation is larger
+class CallbackSink : public OutputSink
+{
+ public:
+  using Callback = std::function<void(const char* theData, std::size_t theSize)>;
+
+  explicit CallbackSink(Callback theCallback, std::size_t theBufferSize = 64 * 1024);
+
+  char* reserve(std::size_t n) override;
+  void commit(std::size_t n) override;
+  void flush() override;
+
+ private:
+  Callback m_callback;
+  std::vector<char> m_buffer;
+  std::size_t m_used = 0;
+};
+
+// Block-wise access to a sink for the writers. Reserve space, write into it and advance past
+// the written characters. finish() commits the last block and flushes the sink. If a writer
+// fails before finish(), the destructor commits only the characters written so far so that
+// the unused part of the block is not left in the sink.
+class OutputCursor
+{
+ public:
+  explicit OutputCursor(OutputSink& theSink);
+  ~OutputCursor();
+  OutputCursor(const OutputCursor& other) = delete;
+  OutputCursor& operator=(const OutputCursor& other) = delete;
+
+  // Pass the size hint to the sink. Small outputs then use small blocks.
+  void expect(std::size_t n);
+
+  char* reserve(std::size_t n)
+  {
+    if (static_cast<std::size_t>(m_end - m_pos) < n)
+      next(n);
+    return m_pos;
+  }
+
+  void advance(char* theEnd) { m_pos = theEnd; }
+
+  void append(const char* theText, std::size_t theSize);
+
+  void finish();
+
+ private:
+  void next(std::size_t n);
+
+  OutputSink& m_sink;
+  char* m_begin = nullptr;  // the reserved block
+  char* m_pos = nullptr;
+  char* m_end = nullptr;
+  std::size_t m_blockSize;  // size of the next block
+};
+
+}  // namespace Fmi
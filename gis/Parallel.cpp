@@ -0,0 +1,76 @@
+#include "Parallel.h"
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace Fmi
+{
+namespace Parallel
+{
+void run(std::size_t theCount,
+         unsigned int theThreads,
+         const std::function<void(std::size_t)>& theTask)
+{
+  try
+  {
+    if (theThreads == 0)
+      theThreads = std::max(1U, std::thread::hardware_concurrency());
+    theThreads = static_cast<unsigned int>(std::min<std::size_t>(theThreads, theCount));
+
+    if (theThreads <= 1)
+    {
+      for (std::size_t k = 0; k < theCount; k++)
+        theTask(k);
+      return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::vector<std::exception_ptr> errors(theThreads);
+
+    auto worker = [&](unsigned int thread)
+    {
+      try
+      {
+        for (auto k = next++; k < theCount; k = next++)
+          theTask(k);
+      }
+      catch (...)
+      {
+        errors[thread] = std::current_exception();
+        next = theCount;  // stop the other threads too
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(theThreads - 1);
+    for (unsigned int t = 1; t < theThreads; t++)
+    {
+      try
+      {
+        workers.emplace_back(worker, t);
+      }
+      catch (...)
+      {
+        break;  // could not start a thread, continue with the ones we have
+      }
+    }
+
+    worker(0);
+    for (auto& w : workers)
+      w.join();
+
+    for (const auto& error : errors)
+      if (error)
+        std::rethrow_exception(error);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace Parallel
+}  // namespace Fmi
@@ -0,0 +1,28 @@
+// ======================================================================
+/*!
+ * \brief Run independent tasks in worker threads
+ *
+ * The threads pick the next unprocessed task from a shared counter, so
+ * the tasks should be ordered largest first to avoid a big task picked
+ * up last leaving the other threads idle. An exception thrown by a task
+ * stops the remaining work and is rethrown in the calling thread.
+ */
+// ======================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace Fmi
+{
+namespace Parallel
+{
+// Call theTask(0) ... theTask(theCount-1) using the given number of threads, 0 = one per
+// hardware core. The calling thread participates in the work.
+void run(std::size_t theCount,
+         unsigned int theThreads,
+         const std::function<void(std::size_t)>& theTask);
+
+}  // namespace Parallel
+}  // namespace Fmi
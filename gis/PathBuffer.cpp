@@ -0,0 +1,267 @@
+#include "PathBuffer.h"
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <ogr_geometry.h>
+
+namespace Fmi
+{
+namespace
+{
+const std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+// Hash for the exact bit pattern of a coordinate. -0 is normalized to +0 first since
+// the vertices are compared with operator==.
+std::size_t hash_xy(double x, double y)
+{
+  x += 0.0;
+  y += 0.0;
+  std::uint64_t a = 0;
+  std::uint64_t b = 0;
+  std::memcpy(&a, &x, sizeof(a));
+  std::memcpy(&b, &y, sizeof(b));
+  std::uint64_t h = a * 0x9E3779B97F4A7C15ULL;
+  h ^= (h >> 32);
+  h ^= b * 0xC2B2AE3D27D4EB4FULL;
+  h ^= (h >> 29);
+  return static_cast<std::size_t>(h);
+}
+
+}  // namespace
+
+void PathBuffer::visit(OGRGeometry* theGeom,
+                       const std::function<void(OGRSimpleCurve*, bool)>& theCallback)
+{
+  try
+  {
+    switch (wkbFlatten(theGeom->getGeometryType()))
+    {
+      case wkbLineString:
+      {
+        auto* line = theGeom->toLineString();
+        if (!line->IsEmpty())
+          theCallback(line, false);
+        return;
+      }
+      case wkbLinearRing:
+      {
+        auto* ring = theGeom->toLinearRing();
+        if (!ring->IsEmpty())
+          theCallback(ring, true);
+        return;
+      }
+      case wkbPolygon:
+      {
+        auto* poly = theGeom->toPolygon();
+        if (poly->IsEmpty())
+          return;
+        for (int i = -1, n = poly->getNumInteriorRings(); i < n; ++i)
+        {
+          auto* ring = (i < 0 ? poly->getExteriorRing() : poly->getInteriorRing(i));
+          if (ring != nullptr && !ring->IsEmpty())
+            theCallback(ring, true);
+        }
+        return;
+      }
+      case wkbMultiLineString:
+      case wkbMultiPolygon:
+      case wkbGeometryCollection:
+      {
+        auto* coll = theGeom->toGeometryCollection();
+        for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
+          visit(coll->getGeometryRef(i), theCallback);
+        return;
+      }
+      default:
+        throw Fmi::Exception::Trace(
+            BCP, "Encountered an unknown geometry component while filtering an isoline/isoband");
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+PathBuffer::~PathBuffer() = default;
+PathBuffer::PathBuffer() = default;
+
+PathBuffer::PathBuffer(const std::vector<OGRGeometryPtr>& theGeoms)
+{
+  try
+  {
+    m_geoms.resize(theGeoms.size());
+    for (std::size_t i = 0; i < theGeoms.size(); i++)
+    {
+      const auto& geom = theGeoms[i];
+      if (!geom || geom->IsEmpty())
+        continue;
+      m_geoms[i].reset(geom->clone());
+      visit(m_geoms[i].get(),
+            [this](OGRSimpleCurve* theCurve, bool theRing) { add(theCurve, theRing); });
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void PathBuffer::add(OGRSimpleCurve* theCurve, bool theRing)
+{
+  Path path;
+  path.curve = theCurve;
+  path.offset = x.size();
+  path.size = theCurve->getNumPoints();
+  path.closed = (theCurve->get_IsClosed() != 0);
+  path.wrap = (theRing || path.closed);
+  paths.push_back(path);
+
+  x.resize(path.offset + path.size);
+  y.resize(path.offset + path.size);
+  theCurve->getPoints(
+      x.data() + path.offset, sizeof(double), y.data() + path.offset, sizeof(double));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Group the vertices by their coordinates
+ *
+ * The first vertex of a ring or a closed linestring is a duplicate and is
+ * not counted, hence the counts are 1 for unshared isoband edges, 2 for
+ * shared edges and 4 for corners shared by four isobands.
+ */
+// ----------------------------------------------------------------------
+
+PathBuffer::Groups PathBuffer::groups() const
+{
+  try
+  {
+    const auto n = x.size();
+
+    std::size_t capacity = 16;
+    while (capacity < 2 * n)
+      capacity *= 2;
+    const auto mask = capacity - 1;
+
+    std::vector<std::size_t> table(capacity, npos);  // first vertex with the coordinates
+
+    Groups result;
+    result.group.resize(n);
+
+    for (const auto& path : paths)
+    {
+      for (int i = 0; i < path.size; i++)
+      {
+        const auto v = path.offset + i;
+        const double vx = x[v];
+        const double vy = y[v];
+
+        auto slot = hash_xy(vx, vy) & mask;
+        while (table[slot] != npos)
+        {
+          const auto w = table[slot];
+          if (x[w] == vx && y[w] == vy)
+            break;
+          slot = (slot + 1) & mask;
+        }
+
+        if (table[slot] == npos)
+        {
+          table[slot] = v;
+          result.group[v] = result.count.size();
+          result.count.push_back(0);
+          result.size.push_back(0);
+        }
+        else
+          result.group[v] = result.group[table[slot]];
+
+        ++result.size[result.group[v]];
+        if (i > 0 || !path.wrap)
+          ++result.count[result.group[v]];
+      }
+    }
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// The filters either move the vertices or remove some of them, hence the kept vertices can be
+// matched to the original ones in order.
+void PathBuffer::setPoints(OGRSimpleCurve* theCurve,
+                           int theSize,
+                           const double* theX,
+                           const double* theY)
+{
+  try
+  {
+    const bool has_z = (theCurve->Is3D() != 0);
+    const bool has_m = (theCurve->IsMeasured() != 0);
+    if (!has_z && !has_m)
+    {
+      theCurve->setPoints(theSize, theX, theY);
+      return;
+    }
+
+    const int n = theCurve->getNumPoints();
+    std::vector<double> z(has_z ? theSize : 0);
+    std::vector<double> m(has_m ? theSize : 0);
+
+    for (int i = 0, j = 0; i < theSize; i++, j++)
+    {
+      if (theSize < n)
+      {
+        while (j < n - 1 && (theCurve->getX(j) != theX[i] || theCurve->getY(j) != theY[i]))
+          ++j;
+      }
+      j = std::min(j, n - 1);
+      if (has_z)
+        z[i] = theCurve->getZ(j);
+      if (has_m)
+        m[i] = theCurve->getM(j);
+    }
+
+    theCurve->setPoints(
+        theSize, theX, theY, has_z ? z.data() : nullptr, has_m ? m.data() : nullptr);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void PathBuffer::store(std::vector<OGRGeometryPtr>& theGeoms)
+{
+  try
+  {
+    for (const auto& path : paths)
+      if (path.curve != nullptr)
+        setPoints(path.curve, path.size, x.data() + path.offset, y.data() + path.offset);
+
+    for (std::size_t i = 0; i < theGeoms.size() && i < m_geoms.size(); i++)
+      if (m_geoms[i])
+        theGeoms[i].reset(m_geoms[i].release());
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+std::vector<std::size_t> PathBuffer::order() const
+{
+  std::vector<std::size_t> result(paths.size());
+  std::iota(result.begin(), result.end(), 0);
+  std::stable_sort(result.begin(),
+                   result.end(),
+                   [this](std::size_t a, std::size_t b) { return paths[a].size > paths[b].size; });
+  return result;
+}
+
+}  // namespace Fmi
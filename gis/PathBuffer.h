@@ -0,0 +1,90 @@
+// ======================================================================
+/*!
+ * \brief Linestrings and rings of geometries in flat coordinate buffers
+ *
+ * The smoothing and simplification filters process each linestring and
+ * ring separately, but need to know which vertices are shared with other
+ * paths to preserve the topology of isobands. The paths are copied into
+ * two coordinate arrays with a single bulk copy per path, and vertices
+ * with identical coordinates are grouped with an open addressing hash
+ * table instead of a node based map.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "Types.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class OGRSimpleCurve;
+
+namespace Fmi
+{
+class PathBuffer
+{
+ public:
+  // A linestring or a ring stored in the coordinate buffers
+  struct Path
+  {
+    OGRSimpleCurve* curve = nullptr;  // the curve the coordinates were copied from
+    std::size_t offset = 0;           // position of the first vertex in the buffers
+    int size = 0;                     // number of vertices
+    bool closed = false;              // first and last vertices are equal
+    bool wrap = false;                // ring or closed linestring, last vertex duplicates 1st
+  };
+
+  // Vertices with identical coordinates
+  struct Groups
+  {
+    std::vector<std::size_t> group;  // group of each vertex
+    std::vector<int> count;          // occurrences of each group, closing vertices excluded
+    std::vector<std::size_t> size;   // number of vertices in each group
+  };
+
+  ~PathBuffer();
+  PathBuffer();
+  PathBuffer(const PathBuffer& other) = delete;
+  PathBuffer& operator=(const PathBuffer& other) = delete;
+  PathBuffer(PathBuffer&& other) = default;
+  PathBuffer& operator=(PathBuffer&& other) = default;
+
+  // Collect the paths of copies of the geometries
+  explicit PathBuffer(const std::vector<OGRGeometryPtr>& theGeoms);
+
+  // Call theCallback(curve, isRing) for the non-empty linestrings and rings in the order the
+  // filters used to visit them
+  static void visit(OGRGeometry* theGeom,
+                    const std::function<void(OGRSimpleCurve*, bool)>& theCallback);
+
+  // Group the vertices by their coordinates
+  Groups groups() const;
+
+  // Path indices sorted largest first for distributing the work to threads
+  std::vector<std::size_t> order() const;
+
+  // The copies of the geometries, which have not been modified yet
+  const std::vector<std::unique_ptr<OGRGeometry>>& geometries() const { return m_geoms; }
+
+  // Set the possibly modified paths to the copies and replace the original geometries
+  void store(std::vector<OGRGeometryPtr>& theGeoms);
+
+  // Set filtered coordinates to a curve keeping the Z and M values of the kept vertices
+  static void setPoints(OGRSimpleCurve* theCurve,
+                        int theSize,
+                        const double* theX,
+                        const double* theY);
+
+  std::vector<Path> paths;
+  std::vector<double> x;
+  std::vector<double> y;
+
+ private:
+  void add(OGRSimpleCurve* theCurve, bool theRing);
+
+  std::vector<std::unique_ptr<OGRGeometry>> m_geoms;  // copies of the input geometries
+};
+
+}  // namespace Fmi
@@ -6,9 +6,13 @@
 #include "OGR.h"
 #include "SpatialReference.h"
 #include <gdal_version.h>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <ogrsf_frmts.h>
 #include <stdexcept>
+#include <vector>
 
 #if GDAL_VERSION_MAJOR > 3 || (GDAL_VERSION_MAJOR == 3 && GDAL_VERSION_MINOR >= 13)
 struct OGRSpatialReferenceReleaser
@@ -66,6 +70,13 @@ void forceCloseRingIfNeeded(OGRLinearRing* ring)
     ring->setPoint(n - 1, x0, y0);
 }
 
+void forceClosePolygonRings(OGRPolygon* poly)
+{
+  forceCloseRingIfNeeded(poly->getExteriorRing());
+  for (int i = 0, n = poly->getNumInteriorRings(); i < n; ++i)
+    forceCloseRingIfNeeded(poly->getInteriorRing(i));
+}
+
 void forceClosePolygonRings(OGRGeometry* geom)
 {
   if (!geom)
@@ -74,18 +85,20 @@ void forceClosePolygonRings(OGRGeometry* geom)
   switch (wkbFlatten(geom->getGeometryType()))
   {
     case wkbPolygon:
+      forceClosePolygonRings(static_cast<OGRPolygon*>(geom));
+      break;
+    case wkbMultiPolygon:
     {
-      auto* poly = static_cast<OGRPolygon*>(geom);
-      forceCloseRingIfNeeded(poly->getExteriorRing());
-      for (int i = 0; i < poly->getNumInteriorRings(); ++i)
-        forceCloseRingIfNeeded(poly->getInteriorRing(i));
+      // All members are polygons, no need to dispatch on the type of each one
+      auto* mpoly = static_cast<OGRMultiPolygon*>(geom);
+      for (int i = 0, n = mpoly->getNumGeometries(); i < n; ++i)
+        forceClosePolygonRings(mpoly->getGeometryRef(i));
       break;
     }
-    case wkbMultiPolygon:
     case wkbGeometryCollection:
     {
       auto* coll = static_cast<OGRGeometryCollection*>(geom);
-      for (int i = 0; i < coll->getNumGeometries(); ++i)
+      for (int i = 0, n = coll->getNumGeometries(); i < n; ++i)
         forceClosePolygonRings(coll->getGeometryRef(i));
       break;
     }
@@ -94,6 +107,190 @@ void forceClosePolygonRings(OGRGeometry* geom)
   }
 }
 
+// Set the session time zone unless Host::connect has already done it. The mark set by
+// Host::connect is trusted for the lifetime of the connection, hence pooled connections must not
+// be used to change the session time zone.
+void set_utc(const GDALDataPtr& theConnection)
+{
+#if GDAL_VERSION_MAJOR >= 2
+  const char* tz = theConnection->GetMetadataItem("TIME_ZONE", "SMARTMET");
+  if (tz != nullptr && strcmp(tz, "UTC") == 0)
+    return;
+#endif
+  theConnection->ExecuteSQL("SET TIME ZONE UTC", nullptr, nullptr);
+}
+
+// Number of points sampled along each edge of a spatial filter box
+const int filter_edge_samples = 32;
+
+}  // namespace
+
+// The edges are sampled since they may curve, and the poles are included if they are inside the
+// box. If the box crosses the antimeridian of a geographic layer all longitudes are included.
+std::optional<OGREnvelope> Fmi::PostGIS::filterEnvelope(const SpatialFilter& theFilter,
+                                                        const Fmi::SpatialReference& theLayerCRS)
+{
+  const auto& box = theFilter.bbox;
+
+  // Sample the boundary counter clockwise starting from the south west corner
+  const double corners[5][2] = {{box.west, box.south},
+                                {box.east, box.south},
+                                {box.east, box.north},
+                                {box.west, box.north},
+                                {box.west, box.south}};
+  std::vector<double> x;
+  std::vector<double> y;
+  for (int edge = 0; edge < 4; edge++)
+  {
+    for (int i = 0; i < filter_edge_samples; i++)
+    {
+      const double t = static_cast<double>(i) / filter_edge_samples;
+      x.push_back(corners[edge][0] + t * (corners[edge + 1][0] - corners[edge][0]));
+      y.push_back(corners[edge][1] + t * (corners[edge + 1][1] - corners[edge][1]));
+    }
+  }
+  const std::size_t boundary_size = x.size();
+
+  // Read everything if the box is not fully valid in the layer spatial reference
+  Fmi::CoordinateTransformation transformation(theFilter.crs, theLayerCRS);
+  transformation.transform(x, y);
+  for (std::size_t i = 0; i < boundary_size; i++)
+    if (std::isnan(x[i]) || std::isnan(y[i]))
+      return {};
+
+  // Poles inside the box
+  std::vector<double> px = {0, 0};
+  std::vector<double> py = {90, -90};
+  Fmi::CoordinateTransformation pole_to_filter("WGS84", theFilter.crs);
+  pole_to_filter.transform(px, py);
+
+  bool full_circle = false;
+  for (std::size_t i = 0; i < px.size(); i++)
+  {
+    if (!std::isnan(px[i]) && px[i] >= box.west && px[i] <= box.east && py[i] >= box.south &&
+        py[i] <= box.north)
+    {
+      double lx = 0;
+      double ly = (i == 0 ? 90 : -90);
+      Fmi::CoordinateTransformation pole_to_layer("WGS84", theLayerCRS);
+      if (pole_to_layer.transform(lx, ly))
+      {
+        x.push_back(lx);
+        y.push_back(ly);
+      }
+      full_circle = true;
+    }
+  }
+
+  OGREnvelope env;
+  env.MinX = env.MinY = std::numeric_limits<double>::infinity();
+  env.MaxX = env.MaxY = -std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0; i < x.size(); i++)
+    env.Merge(x[i], y[i]);
+
+  if (theLayerCRS.isGeographic())
+  {
+    // Consecutive boundary samples jumping by over 180 degrees cross the antimeridian
+    for (std::size_t i = 0; i < boundary_size && !full_circle; i++)
+    {
+      const auto j = (i + 1) % boundary_size;
+      if (std::abs(x[j] - x[i]) > 180)
+        full_circle = true;
+    }
+    if (full_circle)
+    {
+      env.MinX = std::min(env.MinX, -180.0);
+      env.MaxX = std::max(env.MaxX, 180.0);
+    }
+  }
+
+  return env;
+}
+
+namespace
+{
+// Spatial reference of the layer. The authority code or WKT is used as the descriptor so that
+// the cached spatial reference is found instead of exporting the layer CRS again on every read.
+Fmi::SpatialReference layer_crs(OGRLayer* theLayer)
+{
+  const auto* crs = theLayer->GetSpatialRef();
+  if (crs == nullptr)
+    return Fmi::SpatialReference("WGS84");
+
+  const char* authority = crs->GetAuthorityName(nullptr);
+  const char* code = crs->GetAuthorityCode(nullptr);
+  if (authority != nullptr && code != nullptr && EQUAL(authority, "EPSG"))
+    return Fmi::SpatialReference(std::string("EPSG:") + code);
+
+  return Fmi::SpatialReference(Fmi::OGR::exportToWkt(*crs));
+}
+
+// Layers are owned by the connection and keep their filters, which would then apply to other
+// users of the same layer on a shared or pooled connection. The filters are cleared when the
+// read is finished.
+class LayerFilterGuard
+{
+ public:
+  explicit LayerFilterGuard(OGRLayer* theLayer) : itsLayer(theLayer) {}
+  LayerFilterGuard(const LayerFilterGuard& other) = delete;
+  LayerFilterGuard& operator=(const LayerFilterGuard& other) = delete;
+
+  ~LayerFilterGuard()
+  {
+    itsLayer->SetAttributeFilter(nullptr);
+    itsLayer->SetSpatialFilter(nullptr);
+    itsLayer->SetIgnoredFields(nullptr);
+  }
+
+ private:
+  OGRLayer* itsLayer;
+};
+
+// Set the filters of the layer. Settings left by other users of the layer are always reset.
+void set_filters(OGRLayer* theLayer,
+                 const std::string& theName,
+                 const std::optional<std::string>& theWhereClause,
+                 const std::optional<Fmi::PostGIS::SpatialFilter>& theFilter,
+                 const std::set<std::string>* theFieldNames)
+{
+  if (theWhereClause && !theWhereClause->empty())
+  {
+    auto err = theLayer->SetAttributeFilter(theWhereClause->c_str());
+    if (err != OGRERR_NONE)
+      throw std::runtime_error("Failed to set filter '" + *theWhereClause + "' on '" + theName +
+                               "'");
+  }
+  else
+    theLayer->SetAttributeFilter(nullptr);
+
+  std::optional<OGREnvelope> env;
+  if (theFilter)
+    env = Fmi::PostGIS::filterEnvelope(*theFilter, layer_crs(theLayer));
+
+  if (env)
+    theLayer->SetSpatialFilterRect(env->MinX, env->MinY, env->MaxX, env->MaxY);
+  else
+    theLayer->SetSpatialFilter(nullptr);
+
+  // Fetch only the requested fields, or none at all if no names are given
+  std::vector<std::string> ignored;
+  auto* defn = theLayer->GetLayerDefn();
+  for (int i = 0; i < defn->GetFieldCount(); i++)
+  {
+    const char* name = defn->GetFieldDefn(i)->GetNameRef();
+    if (theFieldNames == nullptr || theFieldNames->find(name) == theFieldNames->end())
+      ignored.emplace_back(name);
+  }
+
+  std::vector<const char*> names;
+  for (const auto& name : ignored)
+    names.push_back(name.c_str());
+  names.push_back(nullptr);
+
+  if (theLayer->SetIgnoredFields(names.data()) != OGRERR_NONE)
+    throw std::runtime_error("Failed to select the fields to be read from '" + theName + "'");
+}
+
 }  // namespace
 
 namespace Fmi
@@ -188,35 +385,29 @@ namespace PostGIS
 OGRGeometryPtr read(const Fmi::SpatialReference* theSR,
                     const GDALDataPtr& theConnection,
                     const std::string& theName,
-                    const std::optional<std::string>& theWhereClause)
+                    const std::optional<std::string>& theWhereClause,
+                    const std::optional<SpatialFilter>& theFilter)
 {
   // Get time column in UTC time
-  theConnection->ExecuteSQL("SET TIME ZONE UTC", nullptr, nullptr);
+  set_utc(theConnection);
 
   // Fetch the layer, which is owned by the data source
   OGRLayer* layer = theConnection->GetLayerByName(theName.c_str());
   if (layer == nullptr)
     throw std::runtime_error("Failed to read '" + theName + "' from the database");
 
-  // Establish the filter
+  // Establish the filters, no attribute fields are needed
 
-  if (theWhereClause && !theWhereClause->empty())
-  {
-    auto err = layer->SetAttributeFilter(theWhereClause->c_str());
-    if (err != OGRERR_NONE)
-      throw std::runtime_error("Failed to set filter '" + *theWhereClause + "' on '" + theName +
-                               "'");
-  }
+  LayerFilterGuard guard(layer);
+  set_filters(layer, theName, theWhereClause, theFilter, nullptr);
 
   auto* out = new OGRGeometryCollection;  // NOLINT
 
-  const auto next_feature = [layer]()
-  {
-    return std::shared_ptr<OGRFeature>(
-        layer->GetNextFeature(), [](OGRFeature* feature) { OGRFeature::DestroyFeature(feature); });
-  };
+  // GDAL has no API for reading into an existing feature, but the geometries are
+  // stolen from the features instead of being cloned where possible
+  const auto next_feature = [layer]() { return OGRFeatureUniquePtr(layer->GetNextFeature()); };
 
-  std::shared_ptr<OGRFeature> feature;
+  OGRFeatureUniquePtr feature;
 
   if (theSR == nullptr)
   {
@@ -238,16 +429,12 @@ OGRGeometryPtr read(const Fmi::SpatialReference* theSR,
     layer->ResetReading();
     while ((feature = next_feature()))
     {
-      // owned by feature
-      OGRGeometry* geometry = feature->GetGeometryRef();
+      // ownership is transferred from the feature
+      OGRGeometry* geometry = feature->StealGeometry();
       if (geometry != nullptr)
       {
-        auto* clone = geometry->clone();
-        if (clone)
-        {
-          forceClosePolygonRings(clone);
-          out->addGeometryDirectly(clone);  // takes ownership
-        }
+        forceClosePolygonRings(geometry);
+        out->addGeometryDirectly(geometry);  // takes ownership
       }
     }
   }
@@ -276,13 +463,6 @@ OGRGeometryPtr read(const Fmi::SpatialReference* theSR,
     layer->ResetReading();
     while ((feature = next_feature()))
     {
-      const auto* defn = feature->GetDefnRef();
-      int fieldIndex = defn->GetFieldIndex("iso_a2");
-      bool hasfield = (fieldIndex >= 0 && feature->IsFieldSetAndNotNull(fieldIndex));
-      std::string name;
-      if (hasfield)
-        name = feature->GetFieldAsString(fieldIndex);
-
       // owned by feature
       OGRGeometry* geometry = feature->GetGeometryRef();
       if (geometry != nullptr)
@@ -315,10 +495,11 @@ Features read(const Fmi::SpatialReference* theSR,
               const GDALDataPtr& theConnection,
               const std::string& theName,
               const std::set<std::string>& theFieldNames,
-              const std::optional<std::string>& theWhereClause)
+              const std::optional<std::string>& theWhereClause,
+              const std::optional<SpatialFilter>& theFilter)
 {
   // Get time column in UTC time
-  theConnection->ExecuteSQL("SET TIME ZONE UTC", nullptr, nullptr);
+  set_utc(theConnection);
 
   Features ret;
 
@@ -327,15 +508,10 @@ Features read(const Fmi::SpatialReference* theSR,
   if (layer == nullptr)
     throw std::runtime_error("Failed to read '" + theName + "' from the database");
 
-  // Establish the filter
+  // Establish the filters
 
-  if (theWhereClause && !theWhereClause->empty())
-  {
-    auto err = layer->SetAttributeFilter(theWhereClause->c_str());
-    if (err != OGRERR_NONE)
-      throw std::runtime_error("Failed to set filter '" + *theWhereClause + "' on '" + theName +
-                               "'");
-  }
+  LayerFilterGuard guard(layer);
+  set_filters(layer, theName, theWhereClause, theFilter, &theFieldNames);
 
   // Establish coordinate transformation
 
@@ -361,63 +537,76 @@ Features read(const Fmi::SpatialReference* theSR,
     projector->setDensifyResolutionKm(default_segmentation_length);
   }
 
-  const auto next_feature = [layer]()
+  // GDAL has no API for reading into an existing feature, but the geometries are
+  // stolen from the features instead of being cloned where possible
+  const auto next_feature = [layer]() { return OGRFeatureUniquePtr(layer->GetNextFeature()); };
+
+  // Note: We clone the input SR since we have no lifetime guarantees for it. The
+  // clone is reference counted and hence can be shared by all the geometries.
+  std::shared_ptr<OGRSpatialReference> target_crs;
+  if (transformation != nullptr)
+    target_crs.reset(theSR->get()->Clone(), [](OGRSpatialReference* sr) { sr->Release(); });
+
+  // Resolve the requested fields once instead of comparing names for every feature
+
+  struct RequestedField
   {
-    return std::shared_ptr<OGRFeature>(
-        layer->GetNextFeature(), [](OGRFeature* feature) { OGRFeature::DestroyFeature(feature); });
+    int index;
+    std::string name;
+    OGRFieldType type;
   };
+  std::vector<RequestedField> requested_fields;
+
+  OGRFeatureDefn* poFDefn = layer->GetLayerDefn();
+  for (int iField = 0; iField < poFDefn->GetFieldCount(); iField++)
+  {
+    OGRFieldDefn* poFieldDefn = poFDefn->GetFieldDefn(iField);
+    std::string fieldname(poFieldDefn->GetNameRef());
+    if (theFieldNames.find(fieldname) != theFieldNames.end())
+      requested_fields.push_back(RequestedField{iField, fieldname, poFieldDefn->GetType()});
+  }
 
-  std::shared_ptr<OGRFeature> feature;
+  OGRFeatureUniquePtr feature;
 
   layer->ResetReading();
   while ((feature = next_feature()))
   {
     FeaturePtr ret_item(new Feature);
-    // owned by feature
-    OGRGeometry* geometry = feature->GetGeometryRef();
-    if (geometry != nullptr)
+    if (transformation == nullptr)
     {
-      if (transformation == nullptr)
-      {
-        auto* clone = geometry->clone();
-        forceClosePolygonRings(clone);
-        ret_item->geom.reset(clone);
-      }
-      else
-      {
-        auto* clone = transformation->transformGeometry(*geometry, *projector);
-        forceClosePolygonRings(clone);
-        ret_item->geom.reset(clone);
-        // Note: We clone the input SR since we have no lifetime guarantees for it
-        std::shared_ptr<OGRSpatialReference> tmp(theSR->get()->Clone(),
-                                                 [](OGRSpatialReference* sr) { sr->Release(); });
-        ret_item->geom->assignSpatialReference(tmp.get());
-      }
+      // ownership is transferred from the feature
+      ret_item->geom.reset(feature->StealGeometry());
+      forceClosePolygonRings(ret_item->geom.get());
     }
     else
     {
-      ret_item->geom = nullptr;
+      // owned by feature
+      OGRGeometry* geometry = feature->GetGeometryRef();
+      if (geometry != nullptr)
+      {
+        auto* clone = transformation->transformGeometry(*geometry, *projector);
+        if (clone != nullptr)
+        {
+          forceClosePolygonRings(clone);
+          ret_item->geom.reset(clone);
+          ret_item->geom->assignSpatialReference(target_crs.get());
+        }
+      }
     }
 
     // add attribute fields
-    OGRFeatureDefn* poFDefn = layer->GetLayerDefn();
-    int iField = 0;
-    for (iField = 0; iField < poFDefn->GetFieldCount(); iField++)
+    for (const auto& field : requested_fields)
     {
-      OGRFieldDefn* poFieldDefn = poFDefn->GetFieldDefn(iField);
-      std::string fieldname(poFieldDefn->GetNameRef());
+      const int iField = field.index;
+      const std::string& fieldname = field.name;
 
-      if (theFieldNames.find(fieldname) == theFieldNames.end())
-        continue;
       if (feature->IsFieldSet(iField) == 0)
       {
         ret_item->attributes.insert(make_pair(fieldname, ""));
         continue;
       }
 
-      const auto ftype = poFieldDefn->GetType();
-
-      switch (ftype)
+      switch (field.type)
       {
         case OFTInteger:
           ret_item->attributes.insert(make_pair(fieldname, feature->GetFieldAsInteger(iField)));
@@ -9,10 +9,12 @@
 
 #pragma once
 
+#include "BBox.h"
 #include "Host.h"
 #include "SpatialReference.h"
 #include "Types.h"
 
+#include <ogr_core.h>
 #include <optional>
 
 #include <set>
@@ -24,19 +26,35 @@ namespace Fmi
 {
 namespace PostGIS
 {
-// read geometries and attribute fields
+// Read only features intersecting the bounding box, which is given in the spatial reference of
+// the filter. The box is transformed to the spatial reference of the layer so that the database
+// can use its spatial index.
+struct SpatialFilter
+{
+  BBox bbox;
+  Fmi::SpatialReference crs;
+};
+
+// Envelope of the filter box in the spatial reference of the layer, or nothing if the box cannot
+// be transformed and all features must be read
+std::optional<OGREnvelope> filterEnvelope(const SpatialFilter& theFilter,
+                                          const Fmi::SpatialReference& theLayerCRS);
+
+// read geometries and attribute fields, only the listed fields are fetched
 Features read(const Fmi::SpatialReference* theSR,
               const GDALDataPtr& theConnection,
               const std::string& theName,
               const std::set<std::string>& theFieldNames,
-              const std::optional<std::string>& theWhereClause = std::optional<std::string>());
+              const std::optional<std::string>& theWhereClause = std::optional<std::string>(),
+              const std::optional<SpatialFilter>& theFilter = std::optional<SpatialFilter>());
 
 // name = "schema.table"
 OGRGeometryPtr read(
     const Fmi::SpatialReference* theSR,
     const GDALDataPtr& theConnection,
     const std::string& theName,
-    const std::optional<std::string>& theWhereClause = std::optional<std::string>());
+    const std::optional<std::string>& theWhereClause = std::optional<std::string>(),
+    const std::optional<SpatialFilter>& theFilter = std::optional<SpatialFilter>());
 
 }  // namespace PostGIS
 }  // namespace Fmi
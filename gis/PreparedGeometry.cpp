@@ -0,0 +1,585 @@
+#include "PreparedGeometry.h"
+#include "CoordinateMatrix.h"
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ogr_geometry.h>
+#include <vector>
+
+namespace Fmi
+{
+namespace
+{
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+using BPoint = bg::model::point<double, 2, bg::cs::cartesian>;
+using BBox = bg::model::box<BPoint>;
+using RtreeValue = std::pair<BBox, std::size_t>;
+
+// Maximum number of horizontal slabs per ring
+constexpr int MAX_BINS = 4096;
+
+// Below this many polygons a linear scan of the envelopes beats the R-tree
+constexpr std::size_t MIN_RTREE_SIZE = 8;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Ring edges bucketed into horizontal slabs
+ *
+ * Each edge is stored in every slab its y-range overlaps, hence the edges
+ * crossing a horizontal line are all found from a single slab.
+ */
+// ----------------------------------------------------------------------
+
+class RingIndex
+{
+ public:
+  explicit RingIndex(const OGRLinearRing& theRing)
+  {
+    const int npoints = theRing.getNumPoints();
+    itsX.reserve(npoints + 1);
+    itsY.reserve(npoints + 1);
+    for (int i = 0; i < npoints; i++)
+    {
+      itsX.push_back(theRing.getX(i));
+      itsY.push_back(theRing.getY(i));
+    }
+
+    // Close the ring if necessary
+    if (npoints > 0 && (itsX.front() != itsX.back() || itsY.front() != itsY.back()))
+    {
+      itsX.push_back(itsX.front());
+      itsY.push_back(itsY.front());
+    }
+
+    const int nedges = static_cast<int>(itsX.size()) - 1;
+    if (nedges < 1)
+      return;
+
+    const auto minmax = std::minmax_element(itsY.begin(), itsY.end());
+    itsYMin = *minmax.first;
+    itsYMax = *minmax.second;
+
+    itsBins = std::max(1, std::min(nedges / 2, MAX_BINS));
+    itsBinHeight = (itsYMax - itsYMin) / itsBins;
+    if (itsBinHeight <= 0)
+      itsBinHeight = 1;
+
+    // Count the edges per slab, accumulate to offsets, then fill
+
+    itsBinStart.assign(itsBins + 1, 0);
+    for (int k = 0; k < nedges; k++)
+    {
+      const int b2 = getBin(std::max(itsY[k], itsY[k + 1]));
+      for (int b = getBin(std::min(itsY[k], itsY[k + 1])); b <= b2; b++)
+        ++itsBinStart[b + 1];
+    }
+
+    for (int b = 0; b < itsBins; b++)
+      itsBinStart[b + 1] += itsBinStart[b];
+
+    itsBinEdges.resize(itsBinStart[itsBins]);
+    std::vector<int> pos(itsBinStart.begin(), itsBinStart.end() - 1);
+    for (int k = 0; k < nedges; k++)
+    {
+      const int b2 = getBin(std::max(itsY[k], itsY[k + 1]));
+      for (int b = getBin(std::min(itsY[k], itsY[k + 1])); b <= b2; b++)
+        itsBinEdges[pos[b]++] = k;
+    }
+  }
+
+  bool empty() const { return itsBinEdges.empty(); }
+
+  // Is the number of edge crossings to the right of the point odd?
+  bool crossings(double theX, double theY) const
+  {
+    if (theY < itsYMin || theY > itsYMax || empty())
+      return false;
+
+    bool odd = false;
+    const int b = getBin(theY);
+    for (int i = itsBinStart[b], end = itsBinStart[b + 1]; i < end; i++)
+    {
+      const int k = itsBinEdges[i];
+      const double y1 = itsY[k];
+      const double y2 = itsY[k + 1];
+      if ((y1 > theY) != (y2 > theY) && theX < intersect(k, theY))
+        odd = !odd;
+    }
+    return odd;
+  }
+
+  // Append the x-coordinates where the horizontal line at theY crosses the ring
+  void crossings(double theY, std::vector<double>& theCrossings) const
+  {
+    if (theY < itsYMin || theY > itsYMax || empty())
+      return;
+
+    const int b = getBin(theY);
+    for (int i = itsBinStart[b], end = itsBinStart[b + 1]; i < end; i++)
+    {
+      const int k = itsBinEdges[i];
+      if ((itsY[k] > theY) != (itsY[k + 1] > theY))
+        theCrossings.push_back(intersect(k, theY));
+    }
+  }
+
+ private:
+  int getBin(double theY) const
+  {
+    const int bin = static_cast<int>(std::floor((theY - itsYMin) / itsBinHeight));
+    return std::max(0, std::min(bin, itsBins - 1));
+  }
+
+  // The same expression must be used for points and scanlines to get identical results
+  double intersect(int k, double theY) const
+  {
+    return itsX[k] + (theY - itsY[k]) * (itsX[k + 1] - itsX[k]) / (itsY[k + 1] - itsY[k]);
+  }
+
+  std::vector<double> itsX;  // closed ring
+  std::vector<double> itsY;
+  std::vector<int> itsBinStart;  // offsets into itsBinEdges, size = bins+1
+  std::vector<int> itsBinEdges;  // edge indices per slab
+  double itsYMin = 0;
+  double itsYMax = 0;
+  double itsBinHeight = 1;
+  int itsBins = 1;
+};
+
+// A polygon with its envelope. The exterior ring and the holes are treated alike,
+// a point is inside if it is inside an odd number of rings.
+struct PolygonIndex
+{
+  double xmin = 0;
+  double ymin = 0;
+  double xmax = 0;
+  double ymax = 0;
+  std::vector<RingIndex> rings;
+
+  bool contains(double theX, double theY) const
+  {
+    return theX >= xmin && theX <= xmax && theY >= ymin && theY <= ymax;
+  }
+
+  bool inside(double theX, double theY) const
+  {
+    bool odd = false;
+    for (const auto& ring : rings)
+      odd ^= ring.crossings(theX, theY);
+    return odd;
+  }
+};
+
+}  // namespace
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Implementation details
+ */
+// ----------------------------------------------------------------------
+
+class PreparedGeometry::Impl
+{
+ public:
+  explicit Impl(const OGRGeometry& theGeom);
+
+  bool empty() const { return itsPolygons.empty(); }
+  bool inside(double theX, double theY) const;
+  void row(double theY,
+           double theX1,
+           double theDX,
+           std::size_t theWidth,
+           std::size_t theRow,
+           BoolMatrix& theMask,
+           std::vector<double>& theCrossings) const;
+
+ private:
+  void add(const OGRGeometry& theGeom);
+  void add(const OGRPolygon& theGeom);
+  void add(const OGRLinearRing& theGeom);
+  void add(const OGREnvelope& theEnvelope, std::vector<RingIndex>&& theRings);
+
+  std::vector<PolygonIndex> itsPolygons;
+  bgi::rtree<RtreeValue, bgi::quadratic<16>> itsRtree;
+};
+
+PreparedGeometry::Impl::Impl(const OGRGeometry& theGeom)
+{
+  try
+  {
+    add(theGeom);
+
+    if (itsPolygons.size() >= MIN_RTREE_SIZE)
+    {
+      std::vector<RtreeValue> values;
+      values.reserve(itsPolygons.size());
+      for (std::size_t i = 0; i < itsPolygons.size(); i++)
+      {
+        const auto& p = itsPolygons[i];
+        values.emplace_back(BBox{BPoint{p.xmin, p.ymin}, BPoint{p.xmax, p.ymax}}, i);
+      }
+      // Packing constructor, better balanced than inserting one by one
+      itsRtree = bgi::rtree<RtreeValue, bgi::quadratic<16>>(values.begin(), values.end());
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Collect the polygons. Points and lines cannot contain anything.
+ */
+// ----------------------------------------------------------------------
+
+void PreparedGeometry::Impl::add(const OGRGeometry& theGeom)
+{
+  try
+  {
+    if (theGeom.IsEmpty() != 0)
+      return;
+
+    switch (wkbFlatten(theGeom.getGeometryType()))
+    {
+      case wkbPoint:
+      case wkbMultiPoint:
+      case wkbMultiLineString:
+        return;
+      case wkbLineString:
+        if (strcmp(theGeom.getGeometryName(), "LINEARRING") != 0)
+          return;
+        [[fallthrough]];
+      case wkbLinearRing:
+        return add(dynamic_cast<const OGRLinearRing&>(theGeom));
+      case wkbPolygon:
+        return add(dynamic_cast<const OGRPolygon&>(theGeom));
+      case wkbMultiPolygon:
+      case wkbGeometryCollection:
+      {
+        const auto& geom = dynamic_cast<const OGRGeometryCollection&>(theGeom);
+        for (int i = 0, n = geom.getNumGeometries(); i < n; ++i)
+          add(*geom.getGeometryRef(i));
+        return;
+      }
+      default:
+        throw Fmi::Exception::Trace(
+            BCP, "Encountered an unknown geometry component while preparing inside-tests");
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void PreparedGeometry::Impl::add(const OGRPolygon& theGeom)
+{
+  try
+  {
+    const auto* exterior = theGeom.getExteriorRing();
+    if (exterior == nullptr || exterior->IsEmpty() != 0)
+      return;
+
+    std::vector<RingIndex> rings;
+    rings.reserve(1 + theGeom.getNumInteriorRings());
+    rings.emplace_back(*exterior);
+
+    for (int i = 0, n = theGeom.getNumInteriorRings(); i < n; ++i)
+    {
+      const auto* hole = theGeom.getInteriorRing(i);
+      if (hole != nullptr && hole->IsEmpty() == 0)
+        rings.emplace_back(*hole);
+    }
+
+    OGREnvelope envelope;
+    exterior->getEnvelope(&envelope);
+    add(envelope, std::move(rings));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void PreparedGeometry::Impl::add(const OGRLinearRing& theGeom)
+{
+  try
+  {
+    std::vector<RingIndex> rings;
+    rings.emplace_back(theGeom);
+
+    OGREnvelope envelope;
+    theGeom.getEnvelope(&envelope);
+    add(envelope, std::move(rings));
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+void PreparedGeometry::Impl::add(const OGREnvelope& theEnvelope, std::vector<RingIndex>&& theRings)
+{
+  if (theRings.front().empty())
+    return;
+
+  PolygonIndex polygon;
+  polygon.xmin = theEnvelope.MinX;
+  polygon.ymin = theEnvelope.MinY;
+  polygon.xmax = theEnvelope.MaxX;
+  polygon.ymax = theEnvelope.MaxY;
+  polygon.rings = std::move(theRings);
+  itsPolygons.push_back(std::move(polygon));
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test a single point
+ */
+// ----------------------------------------------------------------------
+
+bool PreparedGeometry::Impl::inside(double theX, double theY) const
+{
+  if (itsRtree.empty())
+  {
+    for (const auto& polygon : itsPolygons)
+      if (polygon.contains(theX, theY) && polygon.inside(theX, theY))
+        return true;
+    return false;
+  }
+
+  const BPoint pt{theX, theY};
+  for (auto it = itsRtree.qbegin(bgi::intersects(pt)); it != itsRtree.qend(); ++it)
+    if (itsPolygons[it->second].inside(theX, theY))
+      return true;
+  return false;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Fill one row of a rectilinear grid
+ *
+ * The crossings of each polygon are sorted, and the points between the
+ * even and odd crossings are inside. The comparisons are done with the
+ * actual grid coordinates so that the result is identical to testing
+ * each point separately.
+ */
+// ----------------------------------------------------------------------
+
+void PreparedGeometry::Impl::row(double theY,
+                                 double theX1,
+                                 double theDX,
+                                 std::size_t theWidth,
+                                 std::size_t theRow,
+                                 BoolMatrix& theMask,
+                                 std::vector<double>& theCrossings) const
+{
+  const double xmax = theX1 + (theWidth - 1) * theDX;
+
+  auto fill = [&](const PolygonIndex& polygon)
+  {
+    theCrossings.clear();
+    for (const auto& ring : polygon.rings)
+      ring.crossings(theY, theCrossings);
+    std::sort(theCrossings.begin(), theCrossings.end());
+
+    // First grid column with x >= the given crossing
+    auto column = [&](double x)
+    {
+      const double pos = std::ceil((x - theX1) / theDX);
+      if (pos <= 0)
+        return std::size_t{0};
+      if (pos >= static_cast<double>(theWidth))
+        return theWidth;
+      auto i = static_cast<std::size_t>(pos);
+      while (i > 0 && theX1 + (i - 1) * theDX >= x)
+        --i;
+      while (i < theWidth && theX1 + i * theDX < x)
+        ++i;
+      return i;
+    };
+
+    for (std::size_t k = 0; k + 1 < theCrossings.size(); k += 2)
+    {
+      const auto i2 = column(theCrossings[k + 1]);
+      for (auto i = column(theCrossings[k]); i < i2; i++)
+        theMask.set(i, theRow, true);
+    }
+  };
+
+  if (itsRtree.empty())
+  {
+    for (const auto& polygon : itsPolygons)
+      if (theY >= polygon.ymin && theY <= polygon.ymax && polygon.xmax >= theX1 &&
+          polygon.xmin <= xmax)
+        fill(polygon);
+    return;
+  }
+
+  const BBox query{BPoint{theX1, theY}, BPoint{xmax, theY}};
+  for (auto it = itsRtree.qbegin(bgi::intersects(query)); it != itsRtree.qend(); ++it)
+    fill(itsPolygons[it->second]);
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Prepare the geometry for inside-tests
+ */
+// ----------------------------------------------------------------------
+
+PreparedGeometry::PreparedGeometry(const OGRGeometry& theGeom)
+{
+  try
+  {
+    impl = std::make_unique<Impl>(theGeom);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+PreparedGeometry::~PreparedGeometry() = default;
+PreparedGeometry::PreparedGeometry(PreparedGeometry&& other) noexcept = default;
+PreparedGeometry& PreparedGeometry::operator=(PreparedGeometry&& other) noexcept = default;
+
+bool PreparedGeometry::empty() const
+{
+  return impl->empty();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Is the given coordinate inside the geometry?
+ */
+// ----------------------------------------------------------------------
+
+bool PreparedGeometry::inside(double theX, double theY) const
+{
+  try
+  {
+    return impl->inside(theX, theY);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test several coordinates at once
+ */
+// ----------------------------------------------------------------------
+
+void PreparedGeometry::inside(const double* theX,
+                              const double* theY,
+                              bool* theResult,
+                              std::size_t theCount) const
+{
+  try
+  {
+    if (impl->empty())
+    {
+      std::fill(theResult, theResult + theCount, false);
+      return;
+    }
+
+    for (std::size_t i = 0; i < theCount; i++)
+      theResult[i] = impl->inside(theX[i], theY[i]);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Mask of the coordinates inside the geometry
+ */
+// ----------------------------------------------------------------------
+
+BoolMatrix PreparedGeometry::mask(const CoordinateMatrix& theCoordinates) const
+{
+  try
+  {
+    const auto nx = theCoordinates.width();
+    const auto ny = theCoordinates.height();
+
+    BoolMatrix result(nx, ny, false);
+    if (impl->empty())
+      return result;
+
+    for (std::size_t j = 0; j < ny; j++)
+      for (std::size_t i = 0; i < nx; i++)
+      {
+        // Missing coordinates are HUGE_VAL
+        const auto x = theCoordinates.x(i, j);
+        const auto y = theCoordinates.y(i, j);
+        if (std::isfinite(x) && std::isfinite(y) && impl->inside(x, y))
+          result.set(i, j, true);
+      }
+
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Mask of a rectilinear grid using scanlines
+ */
+// ----------------------------------------------------------------------
+
+BoolMatrix PreparedGeometry::mask(std::size_t theWidth,
+                                  std::size_t theHeight,
+                                  double theX1,
+                                  double theY1,
+                                  double theX2,
+                                  double theY2) const
+{
+  try
+  {
+    // Decreasing x-coordinates are rare, use the generic algorithm for them
+    if (theWidth > 1 && theX2 < theX1)
+      return mask(CoordinateMatrix(theWidth, theHeight, theX1, theY1, theX2, theY2));
+
+    BoolMatrix result(theWidth, theHeight, false);
+    if (theWidth == 0 || theHeight == 0 || impl->empty())
+      return result;
+
+    // Same step sizes as in CoordinateMatrix
+    const auto dx = theWidth > 1 ? (theX2 - theX1) / (theWidth - 1) : 0;
+    const auto dy = theHeight > 1 ? (theY2 - theY1) / (theHeight - 1) : 0;
+
+    if (dx == 0)
+    {
+      for (std::size_t j = 0; j < theHeight; j++)
+        for (std::size_t i = 0; i < theWidth; i++)
+          result.set(i, j, impl->inside(theX1, theY1 + j * dy));
+      return result;
+    }
+
+    std::vector<double> crossings;
+    for (std::size_t j = 0; j < theHeight; j++)
+      impl->row(theY1 + j * dy, theX1, dx, theWidth, j, result, crossings);
+
+    return result;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace Fmi
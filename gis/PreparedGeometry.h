@@ -0,0 +1,67 @@
+// ======================================================================
+/*!
+ * \brief Point-in-polygon index for repeated inside-tests
+ *
+ * OGR::inside tests a single point against all members of a geometry
+ * visiting every vertex. When thousands of stations or grid points are
+ * tested against the same areas it is much faster to prepare the
+ * geometry once: the member envelopes are placed in an R-tree, and the
+ * edges of each ring are bucketed into horizontal slabs so that only the
+ * edges crossing the horizontal line through the point are visited.
+ *
+ * Points exactly on the boundary may be classified either way, just like
+ * with OGR::inside.
+ *
+ * Keep the prepared geometry to reuse the index. The batch version of
+ * OGR::inside builds a new one on every call.
+ */
+// ======================================================================
+
+#pragma once
+
+#include "BoolMatrix.h"
+#include <cstddef>
+#include <memory>
+
+class OGRGeometry;
+
+namespace Fmi
+{
+class CoordinateMatrix;
+
+class PreparedGeometry
+{
+ public:
+  explicit PreparedGeometry(const OGRGeometry& theGeom);
+  ~PreparedGeometry();
+
+  PreparedGeometry(const PreparedGeometry& other) = delete;
+  PreparedGeometry& operator=(const PreparedGeometry& other) = delete;
+  PreparedGeometry(PreparedGeometry&& other) noexcept;
+  PreparedGeometry& operator=(PreparedGeometry&& other) noexcept;
+
+  // True if there are no polygons to test against
+  bool empty() const;
+
+  // Is the given coordinate inside the geometry?
+  bool inside(double theX, double theY) const;
+
+  // Batch version: theResult[i] = inside(theX[i], theY[i])
+  void inside(const double* theX, const double* theY, bool* theResult, std::size_t theCount) const;
+
+  // Mask of the points inside the geometry. Missing coordinates are outside.
+  BoolMatrix mask(const CoordinateMatrix& theCoordinates) const;
+
+  // Mask for a rectilinear grid with the same layout as CoordinateMatrix(nx,ny,x1,y1,x2,y2).
+  // The rows are filled with a scanline algorithm instead of testing each point.
+  BoolMatrix mask(
+      std::size_t theWidth, std::size_t theHeight, double theX1, double theY1, double theX2, double theY2)
+      const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl;
+
+};  // class PreparedGeometry
+
+}  // namespace Fmi
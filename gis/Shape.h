@@ -80,6 +80,7 @@ class Shape
     Top = 8,
     Right = 16,
     Bottom = 32,
+    Edge = 64,                    // on the boundary of a non-rectangular shape
     TopLeft = Top | Left,         // 12
     TopRight = Top | Right,       // 24
     BottomLeft = Bottom | Left,   // 36
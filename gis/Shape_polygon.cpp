@@ -0,0 +1,957 @@
+#include "Shape_polygon.h"
+#include "OGR.h"
+#include "ShapeClipper.h"
+#include <macgyver/Exception.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <ogr_geometry.h>
+
+namespace Fmi
+{
+namespace
+{
+// Maximum number of horizontal slabs in the edge index
+constexpr int MAX_BINS = 4096;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Add a straight connection along the boundary, densified if necessary
+ */
+// ----------------------------------------------------------------------
+
+void connect(OGRLinearRing &ring,
+             double x1,
+             double y1,
+             double x2,
+             double y2,
+             double theMaximumSegmentLength)
+{
+  if (theMaximumSegmentLength > 0)
+  {
+    const auto dx = x2 - x1;
+    const auto dy = y2 - y1;
+
+    auto length = std::hypot(dx, dy);
+    if (length > theMaximumSegmentLength)
+    {
+      auto num = static_cast<int>(std::ceil(length / theMaximumSegmentLength));
+      for (auto i = 1; i < num; i++)
+      {
+        auto fraction = 1.0 * i / num;
+        ring.addPoint(x1 + fraction * dx, y1 + fraction * dy);
+      }
+    }
+  }
+  ring.addPoint(x2, y2);
+}
+
+}  // namespace
+
+Shape_polygon::Shape_polygon(const OGRLinearRing &theRing)
+{
+  try
+  {
+    init(theRing);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+Shape_polygon::Shape_polygon(const OGRPolygon &thePolygon)
+{
+  try
+  {
+    if (thePolygon.IsEmpty() != 0)
+      throw Fmi::Exception(BCP, "Cannot clip with an empty polygon");
+
+    if (thePolygon.getNumInteriorRings() > 0)
+      throw Fmi::Exception(BCP, "Clipping polygons with holes are not supported");
+
+    init(*thePolygon.getExteriorRing());
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+Shape_polygon::~Shape_polygon() = default;
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Extract the vertices and build the edge index
+ */
+// ----------------------------------------------------------------------
+
+void Shape_polygon::init(const OGRLinearRing &theRing)
+{
+  try
+  {
+    // Copy the vertices without duplicates and without the closing point
+
+    for (int i = 0, npoints = theRing.getNumPoints(); i < npoints; i++)
+    {
+      const double x = theRing.getX(i);
+      const double y = theRing.getY(i);
+      if (!itsX.empty() && x == itsX.back() && y == itsY.back())
+        continue;
+      itsX.push_back(x);
+      itsY.push_back(y);
+    }
+
+    while (itsX.size() > 1 && itsX.front() == itsX.back() && itsY.front() == itsY.back())
+    {
+      itsX.pop_back();
+      itsY.pop_back();
+    }
+
+    const int n = static_cast<int>(itsX.size());
+    if (n < 3)
+      throw Fmi::Exception(BCP, "Clipping polygon must have at least 3 distinct vertices");
+
+    // Make the ring counter-clockwise so that the arc length grows in the same direction
+    // as the angle of the circle shapes
+
+    double area2 = 0;
+    for (int k = 0; k < n; k++)
+    {
+      const int k2 = (k + 1 == n ? 0 : k + 1);
+      area2 += itsX[k] * itsY[k2] - itsX[k2] * itsY[k];
+    }
+
+    if (area2 == 0)
+      throw Fmi::Exception(BCP, "Clipping polygon has zero area");
+
+    if (area2 < 0)
+    {
+      std::reverse(itsX.begin(), itsX.end());
+      std::reverse(itsY.begin(), itsY.end());
+    }
+
+    const auto xminmax = std::minmax_element(itsX.begin(), itsX.end());
+    const auto yminmax = std::minmax_element(itsY.begin(), itsY.end());
+    itsXMin = *xminmax.first;
+    itsXMax = *xminmax.second;
+    itsYMin = *yminmax.first;
+    itsYMax = *yminmax.second;
+
+    itsTolerance = 1e-9 * std::max(itsXMax - itsXMin, itsYMax - itsYMin);
+
+    // Cumulative arc lengths
+
+    itsLength.resize(n + 1);
+    itsLength[0] = 0;
+    for (int k = 0; k < n; k++)
+    {
+      const int k2 = (k + 1 == n ? 0 : k + 1);
+      itsLength[k + 1] = itsLength[k] + std::hypot(itsX[k2] - itsX[k], itsY[k2] - itsY[k]);
+    }
+
+    // Index the edges into horizontal slabs
+
+    const int nbins = std::max(1, std::min(n / 2, MAX_BINS));
+    itsBinHeight = (itsYMax - itsYMin) / nbins;
+    itsBinStart.assign(nbins + 1, 0);
+    itsEdgeBin.resize(n);
+
+    std::vector<int> lastbin(n);
+    for (int k = 0; k < n; k++)
+    {
+      const int k2 = (k + 1 == n ? 0 : k + 1);
+      itsEdgeBin[k] = getBin(std::min(itsY[k], itsY[k2]));
+      lastbin[k] = getBin(std::max(itsY[k], itsY[k2]));
+      for (int b = itsEdgeBin[k]; b <= lastbin[k]; b++)
+        ++itsBinStart[b + 1];
+    }
+
+    for (int b = 0; b < nbins; b++)
+      itsBinStart[b + 1] += itsBinStart[b];
+
+    itsBinEdges.resize(itsBinStart[nbins]);
+    std::vector<int> pos(itsBinStart.begin(), itsBinStart.end() - 1);
+    for (int k = 0; k < n; k++)
+      for (int b = itsEdgeBin[k]; b <= lastbin[k]; b++)
+        itsBinEdges[pos[b]++] = k;
+
+    // Find a point strictly inside the polygon for containment tests. The horizontal
+    // line is placed halfway between two vertex levels near the middle of the bounding
+    // box so that it passes through no vertex, and hence every second crossing begins
+    // an interval of positive length inside the polygon.
+
+    std::vector<double> ys(itsY);
+    std::sort(ys.begin(), ys.end());
+    const double ymid = 0.5 * (itsYMin + itsYMax);
+    auto above = std::upper_bound(ys.begin(), ys.end(), ymid);
+    if (above == ys.end())
+      --above;
+    const double y = 0.5 * (*std::prev(above) + *above);
+
+    std::vector<double> xs;
+    for (int k = 0; k < n; k++)
+    {
+      const int k2 = (k + 1 == n ? 0 : k + 1);
+      if ((itsY[k] > y) != (itsY[k2] > y))
+        xs.push_back(itsX[k] + (y - itsY[k]) * (itsX[k2] - itsX[k]) / (itsY[k2] - itsY[k]));
+    }
+    std::sort(xs.begin(), xs.end());
+
+    std::size_t i = 0;
+    while (i + 1 < xs.size() && !(xs[i + 1] > xs[i]))
+      i += 2;
+    if (i + 1 >= xs.size())
+      throw Fmi::Exception(BCP, "Failed to find a point inside the clipping polygon");
+
+    itsInsideX = 0.5 * (xs[i] + xs[i + 1]);
+    itsInsideY = y;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Slab index for the given y-coordinate
+ */
+// ----------------------------------------------------------------------
+
+int Shape_polygon::getBin(double y) const
+{
+  const int nbins = static_cast<int>(itsBinStart.size()) - 1;
+  const int bin = static_cast<int>(std::floor((y - itsYMin) / itsBinHeight));
+  return std::max(0, std::min(bin, nbins - 1));
+}
+
+double Shape_polygon::cwDistance(double s1, double s2) const
+{
+  if (s2 <= s1)
+    return s1 - s2;
+  return s1 - s2 + itsLength.back();
+}
+
+double Shape_polygon::ccwDistance(double s1, double s2) const
+{
+  if (s2 >= s1)
+    return s2 - s1;
+  return s2 - s1 + itsLength.back();
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Classify a point as Inside, Outside or on the Edge
+ */
+// ----------------------------------------------------------------------
+
+int Shape_polygon::classify(double x, double y) const
+{
+  try
+  {
+    if (x < itsXMin - itsTolerance || x > itsXMax + itsTolerance ||
+        y < itsYMin - itsTolerance || y > itsYMax + itsTolerance)
+      return Outside;
+
+    const int n = static_cast<int>(itsX.size());
+    const double tol2 = itsTolerance * itsTolerance;
+    const int b1 = getBin(y - itsTolerance);
+    const int b2 = getBin(y + itsTolerance);
+
+    bool inside = false;
+
+    for (int b = b1; b <= b2; b++)
+    {
+      for (int i = itsBinStart[b]; i < itsBinStart[b + 1]; i++)
+      {
+        const int k = itsBinEdges[i];
+        if (std::max(itsEdgeBin[k], b1) != b)  // already handled in an earlier slab
+          continue;
+
+        const int k2 = (k + 1 == n ? 0 : k + 1);
+        const double x1 = itsX[k];
+        const double y1 = itsY[k];
+        const double dx = itsX[k2] - x1;
+        const double dy = itsY[k2] - y1;
+
+        // Distance to the edge
+        double t = ((x - x1) * dx + (y - y1) * dy) / (dx * dx + dy * dy);
+        t = std::max(0.0, std::min(1.0, t));
+        const double ex = x1 + t * dx - x;
+        const double ey = y1 + t * dy - y;
+        if (ex * ex + ey * ey <= tol2)
+          return Edge;
+
+        // Crossing number
+        if ((y1 > y) != (itsY[k2] > y))
+        {
+          const double xint = x1 + (y - y1) * dx / dy;
+          if (x < xint)
+            inside = !inside;
+        }
+      }
+    }
+
+    return (inside ? Inside : Outside);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+int Shape_polygon::getPosition(double x, double y) const
+{
+  try
+  {
+    auto pos = classify(x, y);
+    if (pos == Edge)
+      return Inside;
+    return pos;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Append the relative positions along A-B where the segment meets the boundary
+ */
+// ----------------------------------------------------------------------
+
+void Shape_polygon::intersections(
+    double xA, double yA, double xB, double yB, std::vector<double> &ts) const
+{
+  try
+  {
+    const double minx = std::min(xA, xB);
+    const double maxx = std::max(xA, xB);
+    const double miny = std::min(yA, yB);
+    const double maxy = std::max(yA, yB);
+
+    if (maxx < itsXMin - itsTolerance || minx > itsXMax + itsTolerance ||
+        maxy < itsYMin - itsTolerance || miny > itsYMax + itsTolerance)
+      return;
+
+    const double rx = xB - xA;
+    const double ry = yB - yA;
+    const double rr = rx * rx + ry * ry;
+    if (rr == 0)
+      return;
+
+    const int n = static_cast<int>(itsX.size());
+    const int b1 = getBin(miny - itsTolerance);
+    const int b2 = getBin(maxy + itsTolerance);
+
+    for (int b = b1; b <= b2; b++)
+    {
+      for (int i = itsBinStart[b]; i < itsBinStart[b + 1]; i++)
+      {
+        const int k = itsBinEdges[i];
+        if (std::max(itsEdgeBin[k], b1) != b)
+          continue;
+
+        const int k2 = (k + 1 == n ? 0 : k + 1);
+        const double x1 = itsX[k];
+        const double y1 = itsY[k];
+        const double x2 = itsX[k2];
+        const double y2 = itsY[k2];
+
+        if (std::max(x1, x2) < minx - itsTolerance || std::min(x1, x2) > maxx + itsTolerance ||
+            std::max(y1, y2) < miny - itsTolerance || std::min(y1, y2) > maxy + itsTolerance)
+          continue;
+
+        const double sx = x2 - x1;
+        const double sy = y2 - y1;
+        const double qx = x1 - xA;
+        const double qy = y1 - yA;
+        const double denom = rx * sy - ry * sx;
+
+        if (std::abs(denom) <= 1e-12 * std::sqrt(rr * (sx * sx + sy * sy)))
+        {
+          // Parallel. If collinear, the ends of the overlap are break points.
+          if (std::abs(qx * ry - qy * rx) > itsTolerance * std::sqrt(rr))
+            continue;
+
+          const double t1 = (qx * rx + qy * ry) / rr;
+          const double t2 = ((x2 - xA) * rx + (y2 - yA) * ry) / rr;
+          if (t1 > 0 && t1 < 1)
+            ts.push_back(t1);
+          if (t2 > 0 && t2 < 1)
+            ts.push_back(t2);
+          continue;
+        }
+
+        const double t = (qx * sy - qy * sx) / denom;
+        const double u = (qx * ry - qy * rx) / denom;
+        if (t >= 0 && t <= 1 && u >= -1e-12 && u <= 1 + 1e-12)
+          ts.push_back(t);
+      }
+    }
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether the point is on the boundary and return its arc length position
+ */
+// ----------------------------------------------------------------------
+
+bool Shape_polygon::isOnEdge(double x, double y, double &s) const
+{
+  try
+  {
+    if (x < itsXMin - itsTolerance || x > itsXMax + itsTolerance ||
+        y < itsYMin - itsTolerance || y > itsYMax + itsTolerance)
+      return false;
+
+    const int n = static_cast<int>(itsX.size());
+    const int b1 = getBin(y - itsTolerance);
+    const int b2 = getBin(y + itsTolerance);
+
+    int best = -1;
+    double bestdist = itsTolerance * itsTolerance;
+
+    for (int b = b1; b <= b2; b++)
+    {
+      for (int i = itsBinStart[b]; i < itsBinStart[b + 1]; i++)
+      {
+        const int k = itsBinEdges[i];
+        const int k2 = (k + 1 == n ? 0 : k + 1);
+        const double x1 = itsX[k];
+        const double y1 = itsY[k];
+        const double dx = itsX[k2] - x1;
+        const double dy = itsY[k2] - y1;
+
+        double t = ((x - x1) * dx + (y - y1) * dy) / (dx * dx + dy * dy);
+        t = std::max(0.0, std::min(1.0, t));
+        const double ex = x1 + t * dx - x;
+        const double ey = y1 + t * dy - y;
+        const double dist = ex * ex + ey * ey;
+        if (dist <= bestdist)
+        {
+          best = k;
+          bestdist = dist;
+        }
+      }
+    }
+
+    if (best < 0)
+      return false;
+
+    s = itsLength[best] + std::hypot(x - itsX[best], y - itsY[best]);
+    s = std::max(itsLength[best], std::min(itsLength[best + 1], s));
+    if (s >= itsLength.back())
+      s -= itsLength.back();
+
+    return true;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+OGRLinearRing *Shape_polygon::makeRing(double theMaximumSegmentLength) const
+{
+  try
+  {
+    auto *ring = new OGRLinearRing;
+    ring->addPoint(itsX[0], itsY[0]);
+    for (auto k = itsX.size() - 1; k > 0; k--)
+      ring->addPoint(itsX[k], itsY[k]);
+    ring->addPoint(itsX[0], itsY[0]);
+
+    if (theMaximumSegmentLength > 0)
+      ring->segmentize(theMaximumSegmentLength);
+
+    OGR::normalize(*ring);
+    return ring;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+OGRLinearRing *Shape_polygon::makeHole(double theMaximumSegmentLength) const
+{
+  try
+  {
+    auto *ring = new OGRLinearRing;
+    for (std::size_t k = 0; k < itsX.size(); k++)
+      ring->addPoint(itsX[k], itsY[k]);
+    ring->addPoint(itsX[0], itsY[0]);
+
+    if (theMaximumSegmentLength > 0)
+      ring->segmentize(theMaximumSegmentLength);
+
+    OGR::normalize(*ring);
+    return ring;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Split a linestring into parts inside and outside the polygon
+ *
+ * Each segment is broken at its intersections with the boundary, and the
+ * pieces are classified by their midpoints. Pieces running along the
+ * boundary are dropped just like Shape_rect drops segments travelling
+ * along the box edges; the boundary is restored when the pieces are
+ * reconnected. If nothing was removed, no lines are added and the caller
+ * handles the original geometry.
+ */
+// ----------------------------------------------------------------------
+
+int Shape_polygon::split(const OGRLineString *theGeom,
+                         ShapeClipper &theClipper,
+                         bool exterior,
+                         bool keep_inside) const
+{
+  try
+  {
+    if (theGeom == nullptr)
+      return 0;
+
+    const int n = theGeom->getNumPoints();
+    if (n < 1)
+      return 0;
+
+    const OGRLineString &g = *theGeom;
+
+    if (n == 1)
+      return classify(g.getX(0), g.getY(0));
+
+    const int wanted = (keep_inside ? Position::Inside : Position::Outside);
+
+    std::vector<OGRLineString *> lines;
+    std::vector<double> ts;
+    std::vector<int> status;
+
+    int position = 0;
+    auto *line = new OGRLineString();
+    bool active = false;  // is the line being extended
+
+    // Status of the previous segment end, used to skip classification when
+    // there are no intersections
+    int last_status = 0;
+    bool last_on_edge = true;
+
+    double xA = g.getX(0);
+    double yA = g.getY(0);
+
+    for (int i = 1; i < n; i++)
+    {
+      const double xB = g.getX(i);
+      const double yB = g.getY(i);
+      const double dx = xB - xA;
+      const double dy = yB - yA;
+
+      if (dx == 0 && dy == 0)
+        continue;
+
+      const double ttol = itsTolerance / std::hypot(dx, dy);
+
+      ts.clear();
+      ts.push_back(0);
+      ts.push_back(1);
+      intersections(xA, yA, xB, yB, ts);
+
+      status.clear();
+
+      if (ts.size() == 2 && !last_on_edge)
+      {
+        status.push_back(last_status);
+      }
+      else
+      {
+        last_on_edge = false;
+        for (std::size_t j = 2; j < ts.size(); j++)
+          last_on_edge |= (ts[j] >= 1 - ttol);
+
+        // Remove break points which are practically the same
+        std::sort(ts.begin(), ts.end());
+        std::size_t m = 1;
+        for (std::size_t j = 1; j < ts.size(); j++)
+          if (ts[j] - ts[m - 1] > ttol)
+            ts[m++] = ts[j];
+        ts.resize(m);
+        if (m == 1)
+          ts.push_back(1);
+        else
+          ts.back() = 1;
+
+        for (std::size_t j = 0; j + 1 < ts.size(); j++)
+        {
+          const double t = 0.5 * (ts[j] + ts[j + 1]);
+          status.push_back(classify(xA + t * dx, yA + t * dy));
+        }
+      }
+
+      const auto npieces = status.size();
+      for (std::size_t j = 0; j < npieces; j++)
+      {
+        position |= status[j];
+
+        if (status[j] == wanted)
+        {
+          if (!active)
+          {
+            if (ts[j] == 0)
+              line->addPoint(xA, yA);
+            else
+              line->addPoint(xA + ts[j] * dx, yA + ts[j] * dy);
+            active = true;
+          }
+
+          // Intermediate break points where the status does not change are not needed
+          if (j + 1 == npieces)
+            line->addPoint(xB, yB);
+          else if (status[j + 1] != wanted)
+            line->addPoint(xA + ts[j + 1] * dx, yA + ts[j + 1] * dy);
+        }
+        else if (active)
+        {
+          lines.push_back(line);
+          line = new OGRLineString();
+          active = false;
+        }
+      }
+
+      last_status = status.back();
+      xA = xB;
+      yA = yB;
+    }
+
+    if (active)
+      lines.push_back(line);
+    else
+      delete line;
+
+    // Nothing was removed: the caller handles the original geometry
+
+    if (position == wanted)
+    {
+      for (auto *li : lines)
+        delete li;
+      return position;
+    }
+
+    for (auto *li : lines)
+      theClipper.add(li, exterior);
+
+    return position;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+int Shape_polygon::clip(const OGRLineString *theGeom, ShapeClipper &theClipper, bool exterior) const
+{
+  try
+  {
+    return split(theGeom, theClipper, exterior, true);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+int Shape_polygon::cut(const OGRLineString *theGeom, ShapeClipper &theClipper, bool exterior) const
+{
+  try
+  {
+    return split(theGeom, theClipper, exterior, false);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Test whether the polygon is inside the ring
+ *
+ * This is called only when the ring does not enter the polygon, hence
+ * it is sufficient to test a single interior point.
+ */
+// ----------------------------------------------------------------------
+
+bool Shape_polygon::isInsideRing(const OGRLinearRing &theRing) const
+{
+  try
+  {
+    return OGR::inside(theRing, itsInsideX, itsInsideY);
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+bool Shape_polygon::isRingInside(const OGRLinearRing &theRing) const
+{
+  try
+  {
+    for (int i = 0, n = theRing.getNumPoints(); i < n; ++i)
+    {
+      auto pos = classify(theRing.getX(i), theRing.getY(i));
+
+      if (pos == Position::Outside)
+        return false;
+
+      if (pos == Position::Inside)
+        return true;
+    }
+
+    return false;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Search for matching line segment clockwise (clipping)
+ *
+ * The worst we can do is to move to the next vertex, closing the ring
+ * or continuing to another linestring may be better.
+ */
+// ----------------------------------------------------------------------
+
+LineIterator Shape_polygon::search_cw(OGRLinearRing *ring,
+                                      std::list<OGRLineString *> &lines,
+                                      double x1,
+                                      double y1,
+                                      double &x2,
+                                      double &y2) const
+{
+  try
+  {
+    auto best = lines.end();
+
+    double s1 = 0;
+    double s = 0;
+    const double x0 = ring->getX(0);
+    const double y0 = ring->getY(0);
+
+    // Close the ring directly if we cannot travel along the boundary
+    if (!isOnEdge(x1, y1, s1) || !isOnEdge(x0, y0, s))
+    {
+      x2 = x0;
+      y2 = y0;
+      return best;
+    }
+
+    const int n = static_cast<int>(itsX.size());
+    const auto k = std::lower_bound(itsLength.begin(), itsLength.end(), s1) - itsLength.begin();
+
+    int vertex = n - 1;
+    double bestdist = itsLength.back() - itsLength[n - 1];
+    if (k > 0)
+    {
+      vertex = static_cast<int>(k - 1);
+      bestdist = s1 - itsLength[k - 1];
+    }
+    x2 = itsX[vertex];
+    y2 = itsY[vertex];
+
+    bool closing = false;
+    auto dist = cwDistance(s1, s);
+    if (dist > 0 && dist <= bestdist)
+    {
+      x2 = x0;
+      y2 = y0;
+      bestdist = dist;
+      closing = true;
+    }
+
+    for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+      double x = (*iter)->getX(0);
+      double y = (*iter)->getY(0);
+      if (isOnEdge(x, y, s))
+      {
+        dist = cwDistance(s1, s);
+        if (dist < bestdist || (dist == bestdist && !closing))
+        {
+          x2 = x;
+          y2 = y;
+          best = iter;
+          bestdist = dist;
+          closing = false;
+        }
+      }
+    }
+
+    return best;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Search for matching line segment counter-clockwise (cutting)
+ */
+// ----------------------------------------------------------------------
+
+LineIterator Shape_polygon::search_ccw(OGRLinearRing *ring,
+                                       std::list<OGRLineString *> &lines,
+                                       double x1,
+                                       double y1,
+                                       double &x2,
+                                       double &y2) const
+{
+  try
+  {
+    auto best = lines.end();
+
+    double s1 = 0;
+    double s = 0;
+    const double x0 = ring->getX(0);
+    const double y0 = ring->getY(0);
+
+    if (!isOnEdge(x1, y1, s1) || !isOnEdge(x0, y0, s))
+    {
+      x2 = x0;
+      y2 = y0;
+      return best;
+    }
+
+    const int n = static_cast<int>(itsX.size());
+    const auto k = std::upper_bound(itsLength.begin(), itsLength.end(), s1) - itsLength.begin();
+
+    const int vertex = (k >= n ? 0 : static_cast<int>(k));
+    double bestdist = itsLength[k] - s1;
+    x2 = itsX[vertex];
+    y2 = itsY[vertex];
+
+    bool closing = false;
+    auto dist = ccwDistance(s1, s);
+    if (dist > 0 && dist <= bestdist)
+    {
+      x2 = x0;
+      y2 = y0;
+      bestdist = dist;
+      closing = true;
+    }
+
+    for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+      double x = (*iter)->getX(0);
+      double y = (*iter)->getY(0);
+      if (isOnEdge(x, y, s))
+      {
+        dist = ccwDistance(s1, s);
+        if (dist < bestdist || (dist == bestdist && !closing))
+        {
+          x2 = x;
+          y2 = y;
+          best = iter;
+          bestdist = dist;
+          closing = false;
+        }
+      }
+    }
+
+    return best;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+bool Shape_polygon::connectPoints_cw(OGRLinearRing &ring,
+                                     double x1,
+                                     double y1,
+                                     double x2,
+                                     double y2,
+                                     double theMaximumSegmentLength) const
+{
+  try
+  {
+    connect(ring, x1, y1, x2, y2, theMaximumSegmentLength);
+    return true;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+bool Shape_polygon::connectPoints_ccw(OGRLinearRing &ring,
+                                      double x1,
+                                      double y1,
+                                      double x2,
+                                      double y2,
+                                      double theMaximumSegmentLength) const
+{
+  try
+  {
+    connect(ring, x1, y1, x2, y2, theMaximumSegmentLength);
+    return true;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Reverse hole parts when cutting with the exterior surrounding the polygon
+ *
+ * The hole grows to include the whole polygon, hence the boundary must be
+ * travelled clockwise from the end of each part. Travelling counter-clockwise
+ * from the start of the reversed parts produces the same ring.
+ */
+// ----------------------------------------------------------------------
+
+void Shape_polygon::reorientLines(std::list<OGRLineString *> &lines) const
+{
+  for (auto *line : lines)
+    line->reversePoints();
+}
+
+void Shape_polygon::print(std::ostream &stream)
+{
+  try
+  {
+    stream << "Shape_polygon\n";
+    stream << "- vertices  = " << itsX.size() << "\n";
+    stream << "- slabs     = " << itsBinStart.size() - 1 << "\n";
+    stream << "- itsXMin   = " << itsXMin << "\n";
+    stream << "- itsYMin   = " << itsYMin << "\n";
+    stream << "- itsXMax   = " << itsXMax << "\n";
+    stream << "- itsYMax   = " << itsYMax << "\n";
+    stream << "- perimeter = " << itsLength.back() << "\n";
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+}  // namespace Fmi
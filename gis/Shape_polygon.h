@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Shape.h"
+#include <vector>
+
+namespace Fmi
+{
+// Clipping shape defined by an arbitrary simple polygon (no holes).
+//
+// The polygon edges are indexed into horizontal slabs so that point
+// location and segment intersection tests only visit the edges whose
+// y-range overlaps the query. The boundary is parametrised by arc length
+// (counter-clockwise), which lets ShapeClipper walk along it between exit
+// and entry points Weiler-Atherton style, just like the circle shapes walk
+// along their angles.
+
+class Shape_polygon : public Shape
+{
+ public:
+  explicit Shape_polygon(const OGRLinearRing &theRing);
+  explicit Shape_polygon(const OGRPolygon &thePolygon);
+  ~Shape_polygon() override;
+
+  Shape_polygon(const Shape_polygon &other) = delete;
+  Shape_polygon &operator=(const Shape_polygon &other) = delete;
+  Shape_polygon(Shape_polygon &&other) = delete;
+  Shape_polygon &operator=(Shape_polygon &&other) = delete;
+
+  int clip(const OGRLineString *theGeom, ShapeClipper &theClipper, bool exterior) const override;
+  int cut(const OGRLineString *theGeom, ShapeClipper &theClipper, bool exterior) const override;
+
+  bool connectPoints_cw(OGRLinearRing &ring,
+                        double x1,
+                        double y1,
+                        double x2,
+                        double y2,
+                        double theMaximumSegmentLength) const override;
+  bool connectPoints_ccw(OGRLinearRing &ring,
+                         double x1,
+                         double y1,
+                         double x2,
+                         double y2,
+                         double theMaximumSegmentLength) const override;
+
+  int getPosition(double x, double y) const override;
+
+  bool isInsideRing(const OGRLinearRing &theRing) const override;
+  bool isRingInside(const OGRLinearRing &theRing) const override;
+
+  OGRLinearRing *makeRing(double theMaximumSegmentLength) const override;
+  OGRLinearRing *makeHole(double theMaximumSegmentLength) const override;
+
+  LineIterator search_cw(OGRLinearRing *ring,
+                         std::list<OGRLineString *> &lines,
+                         double x1,
+                         double y1,
+                         double &x2,
+                         double &y2) const override;
+  LineIterator search_ccw(OGRLinearRing *ring,
+                          std::list<OGRLineString *> &lines,
+                          double x1,
+                          double y1,
+                          double &x2,
+                          double &y2) const override;
+
+  void reorientLines(std::list<OGRLineString *> &lines) const override;
+
+  void print(std::ostream &stream) override;
+
+ protected:
+  void init(const OGRLinearRing &theRing);
+
+  int split(const OGRLineString *theGeom,
+            ShapeClipper &theClipper,
+            bool exterior,
+            bool keep_inside) const;
+
+  int classify(double x, double y) const;
+  void intersections(double xA, double yA, double xB, double yB, std::vector<double> &ts) const;
+  bool isOnEdge(double x, double y, double &s) const;
+
+  int getBin(double y) const;
+  double cwDistance(double s1, double s2) const;
+  double ccwDistance(double s1, double s2) const;
+
+ private:
+  std::vector<double> itsX;       // vertices in counter-clockwise order, ring not closed
+  std::vector<double> itsY;       //
+  std::vector<double> itsLength;  // arc length at each vertex, last element is the perimeter
+
+  std::vector<int> itsEdgeBin;    // first slab each edge belongs to
+  std::vector<int> itsBinStart;   // CSR offsets into itsBinEdges, size = bins+1
+  std::vector<int> itsBinEdges;   // edge indices per slab
+
+  double itsXMin = 0;
+  double itsYMin = 0;
+  double itsXMax = 0;
+  double itsYMax = 0;
+  double itsBinHeight = 1;
+  double itsTolerance = 0;  // distance at which a point is considered to be on the boundary
+  double itsInsideX = 0;    // a point strictly inside the polygon
+  double itsInsideY = 0;
+};
+
+}  // namespace Fmi
@@ -1,13 +1,24 @@
 #include "SpatialReference.h"
+#include "CacheKeyLog.h"
 #include "OGR.h"
 #include "OGRSpatialReferenceFactory.h"
+#include "Parallel.h"
 #include "ProjInfo.h"
 #include <fmt/format.h>
 #include <macgyver/Exception.h>
 #include <macgyver/Hash.h>
 #include <macgyver/StaticCleanup.h>
 #include <macgyver/StringConversion.h>
+#include <gdal_version.h>
 #include <ogr_geometry.h>
+#include <proj.h>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace Fmi
 {
@@ -22,6 +33,7 @@ struct ImplData
   bool is_geographic = false;
   bool is_axis_swapped = false;
   bool epsg_treats_as_lat_long = false;
+  std::optional<int> epsg;
   std::string wkt;
   ProjInfo projinfo;
 };
@@ -36,6 +48,175 @@ ImplDataCache &get_cache()
   return g_ImplDataCache;
 }
 
+// Descriptors inserted into the cache, for saving snapshots
+CacheKeyLog &get_key_log()
+{
+  static CacheKeyLog g_KeyLog{default_cache_size};
+  return g_KeyLog;
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Read-mostly table of known descriptors
+ *
+ * Servers construct the same few spatial references for every request.
+ * The descriptors seen first, as given and in canonical form, are kept
+ * in an immutable map: writers replace a copy of the map under a mutex
+ * and bump an atomic version number, readers keep the latest map in a
+ * thread local variable and reload it under the mutex only when the
+ * version changes. A hit is thus one atomic load and a hash lookup
+ * without locking. The table is never pruned, other
+ * descriptors are looked up from the LRU cache.
+ *
+ * The data is also interned by WKT and PROJ string so that equivalent
+ * descriptors share the same objects.
+ */
+// ----------------------------------------------------------------------
+
+using DescriptorTable = std::unordered_map<std::string, std::shared_ptr<ImplData>>;
+
+const std::size_t max_table_size = 1000;
+
+class KnownDescriptors
+{
+ public:
+  std::shared_ptr<ImplData> find(const std::string &theDesc) const
+  {
+    thread_local std::shared_ptr<const DescriptorTable> t_table;
+    thread_local std::uint64_t t_version = 0;
+
+    const auto version = m_version.load(std::memory_order_acquire);
+    if (version != t_version)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      t_table = m_table;
+      t_version = version;
+    }
+    if (!t_table)
+      return {};
+
+    auto pos = t_table->find(theDesc);
+    if (pos == t_table->end())
+      return {};
+    return pos->second;
+  }
+
+  // Add a descriptor unless the table is full
+  void add(const std::string &theDesc, const std::shared_ptr<ImplData> &theData)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_table->size() >= max_table_size || m_table->find(theDesc) != m_table->end())
+      return;
+    auto copy = std::make_shared<DescriptorTable>(*m_table);
+    copy->emplace(theDesc, theData);
+    m_table = std::move(copy);
+    m_version.fetch_add(1, std::memory_order_release);
+  }
+
+  // Return previously created equivalent data if there is any
+  std::shared_ptr<ImplData> intern(const std::shared_ptr<ImplData> &theData)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto key = theData->wkt + '\n' + theData->projinfo.projStr();
+    auto pos = m_interned.find(key);
+    if (pos != m_interned.end())
+      return pos->second;
+    if (m_interned.size() < max_table_size)
+      m_interned.emplace(std::move(key), theData);
+    return theData;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table = std::make_shared<const DescriptorTable>();
+    m_version.fetch_add(1, std::memory_order_release);
+    m_interned.clear();
+  }
+
+ private:
+  mutable std::mutex m_mutex;
+  std::atomic<std::uint64_t> m_version{1};
+  std::shared_ptr<const DescriptorTable> m_table = std::make_shared<const DescriptorTable>();
+  std::unordered_map<std::string, std::shared_ptr<ImplData>> m_interned;
+};
+
+KnownDescriptors &get_known_descriptors()
+{
+  static KnownDescriptors g_KnownDescriptors;
+  static StaticCleanup cleanup([]() { g_KnownDescriptors.clear(); });
+  return g_KnownDescriptors;
+}
+
+// Normalize a descriptor so that trivially different spellings share the cache entry
+std::string canonical_key(const std::string &theDesc)
+{
+  const auto first = theDesc.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos)
+    return {};
+  const auto last = theDesc.find_last_not_of(" \t\r\n");
+  auto key = theDesc.substr(first, last - first + 1);
+
+  // Same mapping as in OGRSpatialReferenceFactory
+  if (key == "WGS84")
+    return "EPSG:4326";
+
+  // Authority codes such as epsg:4326 are case insensitive
+  const auto colon = key.find(':');
+  if (colon == std::string::npos || colon == 0 || colon + 1 == key.size())
+    return key;
+  for (std::size_t i = 0; i < colon; i++)
+    if (std::isalpha(static_cast<unsigned char>(key[i])) == 0)
+      return key;
+  for (std::size_t i = colon + 1; i < key.size(); i++)
+    if (std::isdigit(static_cast<unsigned char>(key[i])) == 0)
+      return key;
+  for (std::size_t i = 0; i < colon; i++)
+    key[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(key[i])));
+  return key;
+}
+
+// First line of a cache snapshot. The parsed definitions depend on the GDAL and PROJ versions.
+std::string snapshot_header()
+{
+  return fmt::format("# SpatialReference cache 1 GDAL {} PROJ {}.{}.{}",
+                     GDAL_RELEASE_NAME,
+                     PROJ_VERSION_MAJOR,
+                     PROJ_VERSION_MINOR,
+                     PROJ_VERSION_PATCH);
+}
+
+// Write a tab separated record, records which cannot be represented are skipped
+bool write_record(std::ostream &out, const std::vector<std::string> &fields)
+{
+  for (const auto &field : fields)
+    if (field.find_first_of("\t\r\n") != std::string::npos)
+      return false;
+
+  for (std::size_t i = 0; i < fields.size(); i++)
+  {
+    if (i > 0)
+      out << '\t';
+    out << fields[i];
+  }
+  out << '\n';
+  return true;
+}
+
+std::vector<std::string> split_record(const std::string &line)
+{
+  std::vector<std::string> fields;
+  std::size_t pos = 0;
+  while (true)
+  {
+    auto next = line.find('\t', pos);
+    fields.push_back(line.substr(pos, next - pos));
+    if (next == std::string::npos)
+      return fields;
+    pos = next + 1;
+  }
+}
+
 bool is_axis_swapped(const OGRSpatialReference &crs)
 {
   try
@@ -61,6 +242,39 @@ bool is_axis_swapped(const OGRSpatialReference &crs)
   }
 }
 
+std::optional<int> get_epsg(const OGRSpatialReference &crs)
+{
+  const auto *root = crs.GetRoot();
+  if (root == nullptr)
+    return {};
+
+  std::string prefix = root->GetValue();
+
+  const std::string authority = "AUTHORITY";
+
+  if (prefix != "PROJCS" && prefix != "GEOGCS")
+    return {};
+
+  for (int i = 0; i < root->GetChildCount(); i++)
+  {
+    const auto *node = root->GetChild(i);
+    if (node != nullptr)
+    {
+      const auto *name = node->GetValue();
+      if (name != nullptr && authority == name)
+      {
+        if (node->GetChildCount() != 2)
+          return {};
+        const auto *value = node->GetChild(1);
+        if (value == nullptr)
+          return {};
+        return Fmi::stoi(value->GetValue());
+      }
+    }
+  }
+  return {};
+}
+
 }  // namespace
 
 // Implementation details
@@ -125,34 +339,53 @@ class SpatialReference::Impl
   {
     try
     {
-      auto obj = get_cache().find(theCRS);
-      if (obj)
-        m_data = *obj;
-      else
-      {
-        m_data = std::make_shared<ImplData>();
-        m_data->crs = OGRSpatialReferenceFactory::Create(theCRS);
+      auto &known = get_known_descriptors();
+      m_data = known.find(theCRS);
+      if (m_data)
+        return;
 
-        // Generate WKT only once, and cache spatial references for better speed
-        m_data->wkt = OGR::exportToWkt(*m_data->crs);
+      const auto key = canonical_key(theCRS);
+      if (key != theCRS)
+        m_data = known.find(key);
 
-        try
-        {
-          // exportToProj may lose the original +type=crs setting, hence we try direct parsing first
-          m_data->projinfo = ProjInfo(theCRS);
-        }
-        catch (...)
+      if (!m_data)
+      {
+        auto obj = get_cache().find(key);
+        if (obj)
+          m_data = *obj;
+        else
         {
-          m_data->projinfo = ProjInfo(OGR::exportToProj(*m_data->crs));
+          m_data = std::make_shared<ImplData>();
+          m_data->crs = OGRSpatialReferenceFactory::Create(key);
+
+          // Generate WKT only once, and cache spatial references for better speed
+          m_data->wkt = OGR::exportToWkt(*m_data->crs);
+
+          try
+          {
+            // exportToProj may lose the original +type=crs setting, hence try direct parsing first
+            m_data->projinfo = ProjInfo(key);
+          }
+          catch (...)
+          {
+            m_data->projinfo = ProjInfo(OGR::exportToProj(*m_data->crs));
+          }
+          m_data->hashvalue = Fmi::hash_value(m_data->wkt);  // WKT is more reliable than PROJ
+
+          m_data->is_geographic = (m_data->crs->IsGeographic() != 0);
+          m_data->is_axis_swapped = is_axis_swapped(*m_data->crs);
+          m_data->epsg_treats_as_lat_long = (m_data->crs->EPSGTreatsAsLatLong() != 0);
+          m_data->epsg = get_epsg(*m_data->crs);
+
+          m_data = known.intern(m_data);
+
+          get_cache().insert(key, m_data);
+          get_key_log().add(key);
         }
-        m_data->hashvalue = Fmi::hash_value(m_data->wkt);  // WKT is more reliable than PROJ strings
-
-        m_data->is_geographic = (m_data->crs->IsGeographic() != 0);
-        m_data->is_axis_swapped = is_axis_swapped(*m_data->crs);
-        m_data->epsg_treats_as_lat_long = (m_data->crs->EPSGTreatsAsLatLong() != 0);
-
-        get_cache().insert(theCRS, m_data);
+        if (key != theCRS)
+          known.add(key, m_data);
       }
+      known.add(theCRS, m_data);
     }
     catch (...)
     {
@@ -175,6 +408,7 @@ class SpatialReference::Impl
       m_data->is_geographic = (m_data->crs->IsGeographic() != 0);
       m_data->is_axis_swapped = is_axis_swapped(*m_data->crs);
       m_data->epsg_treats_as_lat_long = (m_data->crs->EPSGTreatsAsLatLong() != 0);
+      m_data->epsg = get_epsg(*m_data->crs);
     }
     catch (...)
     {
@@ -341,34 +575,14 @@ const std::string &SpatialReference::projStr() const
 
 std::optional<int> SpatialReference::getEPSG() const
 {
-  const auto &crs = *impl->m_data->crs;
-
-  const auto *root = crs.GetRoot();
-  std::string prefix = root->GetValue();
-
-  const std::string authority = "AUTHORITY";
-
-  if (prefix != "PROJCS" && prefix != "GEOGCS")
-    return {};
-
-  for (int i = 0; i < root->GetChildCount(); i++)
+  try
   {
-    const auto *node = root->GetChild(i);
-    if (node != nullptr)
-    {
-      const auto *name = node->GetValue();
-      if (name != nullptr && authority == name)
-      {
-        if (node->GetChildCount() != 2)
-          return {};
-        const auto *value = node->GetChild(1);
-        if (value == nullptr)
-          return {};
-        return Fmi::stoi(value->GetValue());
-      }
-    }
+    return impl->m_data->epsg;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
   }
-  return {};
 }
 
 void SpatialReference::setCacheSize(std::size_t newMaxSize)
@@ -383,6 +597,20 @@ void SpatialReference::setCacheSize(std::size_t newMaxSize)
   }
 }
 
+void SpatialReference::clearCache()
+{
+  try
+  {
+    get_known_descriptors().clear();
+    get_cache().clear();
+    OGRSpatialReferenceFactory::ClearCache();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 Cache::CacheStats SpatialReference::getCacheStats()
 {
   try
@@ -396,4 +624,144 @@ Cache::CacheStats SpatialReference::getCacheStats()
   }
 }
 
+// ----------------------------------------------------------------------
+/*!
+ * \brief Save the cached spatial references to a file
+ *
+ * The file is tab separated text. F records hold the descriptors and WKT2
+ * definitions cached by OGRSpatialReferenceFactory, S records the
+ * descriptor, WKT, PROJ string, flags and EPSG code of the cached
+ * SpatialReference data. The parsed objects are rebuilt from WKT2, which
+ * is much faster than resolving the descriptors from the PROJ database.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t SpatialReference::saveCache(const std::string &theFilename)
+{
+  try
+  {
+    std::ofstream out(theFilename);
+    if (!out)
+      throw Fmi::Exception(BCP, "Failed to open spatial reference cache file for writing")
+          .addParameter("Filename", theFilename);
+
+    out << snapshot_header() << '\n';
+
+    std::size_t count = 0;
+    for (const auto &item : OGRSpatialReferenceFactory::GetCacheContents())
+      if (write_record(out, {"F", item.first, item.second}))
+        ++count;
+
+    for (const auto &desc : get_key_log().keys())
+    {
+      auto obj = get_cache().find(desc);
+      if (!obj)
+        continue;
+      const auto &data = **obj;
+      std::string flags = {data.is_geographic ? '1' : '0',
+                           data.is_axis_swapped ? '1' : '0',
+                           data.epsg_treats_as_lat_long ? '1' : '0'};
+      std::string epsg = (data.epsg ? std::to_string(*data.epsg) : std::string());
+      if (write_record(out, {"S", desc, data.wkt, data.projinfo.projStr(), flags, epsg}))
+        ++count;
+    }
+
+    out.close();
+    if (!out)
+      throw Fmi::Exception(BCP, "Failed to write spatial reference cache file")
+          .addParameter("Filename", theFilename);
+
+    return count;
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
+// ----------------------------------------------------------------------
+/*!
+ * \brief Load spatial references saved by saveCache
+ *
+ * The factory definitions are parsed first using the given number of
+ * threads, the SpatialReference data then reuses them from the factory
+ * cache. Entries already in the caches are kept.
+ */
+// ----------------------------------------------------------------------
+
+std::size_t SpatialReference::loadCache(const std::string &theFilename, unsigned int theThreads)
+{
+  try
+  {
+    std::ifstream in(theFilename);
+    if (!in)
+      throw Fmi::Exception(BCP, "Failed to open spatial reference cache file")
+          .addParameter("Filename", theFilename);
+
+    std::string line;
+    if (!std::getline(in, line) || line != snapshot_header())
+      return 0;
+
+    std::vector<std::vector<std::string>> factory_records;
+    std::vector<std::vector<std::string>> records;
+
+    std::size_t lineno = 1;
+    while (std::getline(in, line))
+    {
+      ++lineno;
+      if (line.empty())
+        continue;
+      auto fields = split_record(line);
+      if (fields[0] == "F" && fields.size() == 3)
+        factory_records.push_back(std::move(fields));
+      else if (fields[0] == "S" && fields.size() == 6)
+        records.push_back(std::move(fields));
+      else
+        throw Fmi::Exception(BCP, "Invalid record in spatial reference cache file")
+            .addParameter("Filename", theFilename)
+            .addParameter("Line", std::to_string(lineno));
+    }
+
+    Parallel::run(factory_records.size(),
+                  theThreads,
+                  [&factory_records](std::size_t i)
+                  {
+                    const auto &fields = factory_records[i];
+                    OGRSpatialReferenceFactory::Restore(fields[1], fields[2]);
+                  });
+
+    Parallel::run(records.size(),
+                  theThreads,
+                  [&records](std::size_t i)
+                  {
+                    const auto &fields = records[i];
+                    const auto &desc = fields[1];
+                    if (get_cache().find(desc))
+                      return;
+
+                    auto data = std::make_shared<ImplData>();
+                    data->crs = OGRSpatialReferenceFactory::Create(desc);
+                    data->wkt = fields[2];
+                    data->projinfo = ProjInfo(fields[3]);
+                    data->hashvalue = Fmi::hash_value(data->wkt);
+                    data->is_geographic = (fields[4].size() > 0 && fields[4][0] == '1');
+                    data->is_axis_swapped = (fields[4].size() > 1 && fields[4][1] == '1');
+                    data->epsg_treats_as_lat_long = (fields[4].size() > 2 && fields[4][2] == '1');
+                    if (!fields[5].empty())
+                      data->epsg = Fmi::stoi(fields[5]);
+
+                    data = get_known_descriptors().intern(data);
+                    get_cache().insert(desc, data);
+                    get_key_log().add(desc);
+                    get_known_descriptors().add(desc, data);
+                  });
+
+    return factory_records.size() + records.size();
+  }
+  catch (...)
+  {
+    throw Fmi::Exception::Trace(BCP, "Operation failed!");
+  }
+}
+
 }  // namespace Fmi
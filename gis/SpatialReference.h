@@ -2,6 +2,7 @@
 
 #include <macgyver/Cache.h>
 #include <memory>
+#include <optional>
 #include <string>
 
 class OGRSpatialReference;
@@ -60,9 +61,18 @@ class SpatialReference
   // Internal cache size
   static void setCacheSize(std::size_t newMaxSize);
 
+  // Forget all cached and known spatial references, including those of OGRSpatialReferenceFactory
+  static void clearCache();
+
   // Get cache statistics
   static Cache::CacheStats getCacheStats();
 
+  // Save the cached spatial references to a file, and load them for example at startup to avoid
+  // parsing the same definitions again. Files written by other GDAL or PROJ versions are ignored.
+  // Return the number of records saved or loaded.
+  static std::size_t saveCache(const std::string &theFilename);
+  static std::size_t loadCache(const std::string &theFilename, unsigned int theThreads = 0);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl;
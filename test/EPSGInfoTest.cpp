@@ -84,6 +84,25 @@ void webmercator()
   TEST_PASSED();
 }
 
+void table()
+{
+  Fmi::EPSGInfo::preload();
+
+  for (int code : {-1, 0, 123456, 999999})
+    if (Fmi::EPSGInfo::isValid(code) || Fmi::EPSGInfo::getInfo(code))
+      TEST_FAILED("EPSG " + std::to_string(code) + " should be invalid");
+
+  const auto tm35fin = Fmi::EPSGInfo::getInfo(3067);
+  if (!tm35fin || tm35fin->geodetic)
+    TEST_FAILED("EPSG 3067 should be a projected CRS");
+
+  const auto etrs89 = Fmi::EPSGInfo::getInfo(4258);
+  if (!etrs89 || !etrs89->geodetic)
+    TEST_FAILED("EPSG 4258 should be a geodetic CRS");
+
+  TEST_PASSED();
+}
+
 // Test driver
 class tests : public tframe::tests
 {
@@ -95,6 +114,7 @@ class tests : public tframe::tests
     TEST(isvalid);
     TEST(wgs84);
     TEST(webmercator);
+    TEST(table);
   }
 
 };  // class tests
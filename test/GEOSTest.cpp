@@ -1,4 +1,5 @@
 #include "GEOS.h"
+#include "OutputSink.h"
 #include "TestDefs.h"
 
 #include <geos/io/WKTReader.h>
@@ -167,6 +168,43 @@ void exportToSvg_closing_paths()
   TEST_PASSED();
 }
 
+// Trailing zeros are kept unless all decimals are zero, the sink output matches the string
+// output
+
+void exportToSvg_precision()
+{
+  using namespace Fmi;
+  using GEOS::exportToSvg;
+
+  geos::io::WKTReader reader(factory);
+
+  string linestring = "LINESTRING (1.5 2.254, 3.1 -0.0001, 10 20.996)";
+
+  std::unique_ptr<geos::geom::Geometry> geom;
+  geom.reset(WKTREAD(linestring));
+
+  string result = exportToSvg(*geom, 2);
+  string ok = "M1.50 2.25 3.10 0 10 21";
+  if (result != ok)
+    TEST_FAILED("Expected: " + ok + "\n\tObtained: " + result);
+
+  result = exportToSvg(*geom, 0);
+  ok = "M2 2 3 0 10 21";
+  if (result != ok)
+    TEST_FAILED("Expected: " + ok + "\n\tObtained: " + result);
+
+  ok = exportToSvg(*geom, 3);
+  ChunkSink sink(8);
+  exportToSvg(sink, *geom, 3);
+  result.clear();
+  for (const auto& chunk : sink.chunks())
+    result.append(chunk.data, chunk.size);
+  if (result != ok)
+    TEST_FAILED("ChunkSink:\n\tExpected: " + ok + "\n\tObtained: " + result);
+
+  TEST_PASSED();
+}
+
 // Test driver
 class tests : public tframe::tests
 {
@@ -177,6 +215,7 @@ class tests : public tframe::tests
   {
     TEST(exportToSvg_wiki_examples);
     TEST(exportToSvg_closing_paths);
+    TEST(exportToSvg_precision);
   }
 
 };  // class tests
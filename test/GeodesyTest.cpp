@@ -0,0 +1,233 @@
+#include "Geodesy.h"
+
+#include <macgyver/StaticCleanup.h>
+#include <ogr_geometry.h>
+#include <regression/tframe.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+const double pi = 3.14159265358979323846;
+const double radius = Fmi::Geodesy::EarthRadius;
+
+bool close_enough(double a, double b, double reltol)
+{
+  return std::abs(a - b) <= reltol * std::max(std::abs(a), std::abs(b));
+}
+
+}  // namespace
+
+namespace Tests
+{
+// ----------------------------------------------------------------------
+
+void spherical_area()
+{
+  // Hemisphere north of the equator as a ring along the equator and the pole
+  const std::vector<double> lon{-180, 180, 180, -180, -180};
+  const std::vector<double> lat{0, 0, 90, 90, 0};
+
+  const double expected = 2 * pi * radius * radius;
+  const double area = Fmi::Geodesy::sphericalArea(lon.data(), lat.data(), lon.size());
+  if (!close_enough(area, expected, 1e-12))
+    TEST_FAILED("Hemisphere area should be " + std::to_string(expected) + ", got " +
+                std::to_string(area));
+
+  // 1x1 degree cell at the equator, both orientations and the OGR overload
+  OGRLinearRing ring;
+  ring.addPoint(0, 0);
+  ring.addPoint(1, 0);
+  ring.addPoint(1, 1);
+  ring.addPoint(0, 1);
+  ring.addPoint(0, 0);
+
+  const double cell = radius * radius * (pi / 180) * std::sin(pi / 180);
+  if (!close_enough(Fmi::Geodesy::sphericalArea(ring), cell, 1e-12))
+    TEST_FAILED("1x1 degree cell area is incorrect: " +
+                std::to_string(Fmi::Geodesy::sphericalArea(ring)));
+
+  ring.reversePoints();
+  if (!close_enough(Fmi::Geodesy::sphericalArea(ring), cell, 1e-12))
+    TEST_FAILED("Area should not depend on the orientation");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void ellipsoidal_area()
+{
+  // The WGS84 ellipsoid surface area is 510065621.7 km^2
+  const std::vector<double> lon{-180, 180, 180, -180, -180};
+  const std::vector<double> lat{-90, -90, 90, 90, -90};
+
+  const double area = Fmi::Geodesy::ellipsoidalArea(lon.data(), lat.data(), lon.size());
+  if (!close_enough(area, 510065621.7e6, 1e-9))
+    TEST_FAILED("Ellipsoid area should be 510065621.7 km^2, got " + std::to_string(area / 1e6));
+
+  // At the equator the ellipsoid is flatter than the sphere, towards the poles the opposite
+  const std::vector<double> lon2{0, 1, 1, 0, 0};
+  const std::vector<double> lat2{0, 0, 1, 1, 0};
+  if (Fmi::Geodesy::ellipsoidalArea(lon2.data(), lat2.data(), lon2.size()) >=
+      Fmi::Geodesy::sphericalArea(lon2.data(), lat2.data(), lon2.size()))
+    TEST_FAILED("Equatorial cell should be smaller on the ellipsoid");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void spherical_length()
+{
+  OGRLineString line;
+  line.addPoint(0, 0);
+  line.addPoint(90, 0);
+  line.addPoint(90, 90);
+
+  const double expected = pi * radius;
+  if (!close_enough(Fmi::Geodesy::sphericalLength(line), expected, 1e-12))
+    TEST_FAILED("Length should be " + std::to_string(expected) + ", got " +
+                std::to_string(Fmi::Geodesy::sphericalLength(line)));
+
+  const std::vector<double> lon1{0, 0, 24.94};
+  const std::vector<double> lat1{0, 0, 60.17};
+  const std::vector<double> lon2{0, 180, 24.94};
+  const std::vector<double> lat2{90, 0, 60.17};
+  std::vector<double> result(lon1.size());
+  Fmi::Geodesy::haversine(
+      lon1.data(), lat1.data(), lon2.data(), lat2.data(), result.data(), result.size());
+
+  if (!close_enough(result[0], pi / 2 * radius, 1e-12))
+    TEST_FAILED("Distance from equator to pole is incorrect: " + std::to_string(result[0]));
+  if (!close_enough(result[1], pi * radius, 1e-12))
+    TEST_FAILED("Distance to antipode is incorrect: " + std::to_string(result[1]));
+  if (result[2] != 0)
+    TEST_FAILED("Distance to the point itself should be zero");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void approximate_distance()
+{
+  if (!close_enough(Fmi::Geodesy::approximateDistance(0, 0, 1, 0), 111320, 1e-12))
+    TEST_FAILED("One degree at the equator should be 111.32 km");
+  if (!close_enough(Fmi::Geodesy::approximateDistance(0, 60, 1, 60), 55660, 1e-12))
+    TEST_FAILED("One degree of longitude at 60N should be 55.66 km");
+  if (!close_enough(Fmi::Geodesy::approximateDistance(25, 60, 25, 61), 111320, 1e-12))
+    TEST_FAILED("One degree of latitude should be 111.32 km");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void densify()
+{
+  // 10 degrees along the equator is 1113.2 km, hence 100 km steps require 12 segments
+  OGRLineString line;
+  line.addPoint(0, 0);
+  line.addPoint(10, 0);
+  Fmi::Geodesy::densify(line, 100000);
+
+  if (line.getNumPoints() != 13)
+    TEST_FAILED("Expected 13 points, got " + std::to_string(line.getNumPoints()));
+  if (line.getX(0) != 0 || line.getX(12) != 10)
+    TEST_FAILED("End points should be preserved");
+  if (!close_enough(line.getX(6), 5, 1e-12))
+    TEST_FAILED("Points should be evenly spaced in longitude");
+
+  // Short segments are left untouched
+  OGRLineString line2;
+  line2.addPoint(0, 0);
+  line2.addPoint(0.5, 0);
+  Fmi::Geodesy::densify(line2, 100000);
+  if (line2.getNumPoints() != 2)
+    TEST_FAILED("Short segment should not be densified");
+
+  // Pole traversals are measured along the equator: 180 degrees = 20037.5 km
+  OGRLineString line3;
+  line3.addPoint(0, 90);
+  line3.addPoint(180, 90);
+  Fmi::Geodesy::densify(line3, 1000000);
+  if (line3.getNumPoints() != 22)
+    TEST_FAILED("Expected 22 points along the pole, got " + std::to_string(line3.getNumPoints()));
+
+  // Z-coordinates are interpolated
+  OGRLineString line4;
+  line4.addPoint(0, 0, 100);
+  line4.addPoint(10, 0, 220);
+  Fmi::Geodesy::densify(line4, 100000);
+  if (line4.Is3D() == 0 || line4.getNumPoints() != 13)
+    TEST_FAILED("Densified 3D linestring should stay 3D");
+  if (!close_enough(line4.getZ(6), 160, 1e-12) || line4.getZ(12) != 220)
+    TEST_FAILED("Z-coordinates should be interpolated linearly");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void azimuth()
+{
+  const std::vector<double> lon1{0, 0, 0, 0, 25};
+  const std::vector<double> lat1{0, 0, 0, 0, 60};
+  const std::vector<double> lon2{0, 10, 0, -10, 25};
+  const std::vector<double> lat2{10, 0, -10, 0, 60};
+  const std::vector<double> expected{0, 90, 180, 270, 0};
+
+  std::vector<double> result(lon1.size());
+  Fmi::Geodesy::azimuth(
+      lon1.data(), lat1.data(), lon2.data(), lat2.data(), result.data(), result.size());
+
+  for (std::size_t i = 0; i < result.size(); i++)
+    if (std::abs(result[i] - expected[i]) > 1e-9)
+      TEST_FAILED("Bearing " + std::to_string(i) + " should be " + std::to_string(expected[i]) +
+                  ", got " + std::to_string(result[i]));
+
+  // Along a parallel the initial bearing points slightly towards the pole
+  double b = 0;
+  const double lon = 25;
+  const double lat = 60;
+  const double lon_east = 35;
+  Fmi::Geodesy::azimuth(&lon, &lat, &lon_east, &lat, &b, 1);
+  if (!(b > 80 && b < 90))
+    TEST_FAILED("Bearing along 60N towards east should be a bit less than 90, got " +
+                std::to_string(b));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(spherical_area);
+    TEST(ellipsoidal_area);
+    TEST(spherical_length);
+    TEST(approximate_distance);
+    TEST(densify);
+    TEST(azimuth);
+  }
+};
+
+}  // namespace Tests
+
+int main()
+{
+  Fmi::StaticCleanup::AtExit cleanup;
+  cout << endl
+       << "Geodesy tester\n"
+          "==============\n";
+  Tests::tests t;
+  return t.run();
+}
@@ -1,4 +1,5 @@
 #include "GeometryAmalgamator.h"
+#include "OGR.h"
 #include "Types.h"
 #include <regression/tframe.h>
 #include <cmath>
@@ -203,6 +204,49 @@ void none_disabled()
   TEST_PASSED();
 }
 
+// ----------------------------------------------------------------------
+
+void threaded_matches_serial()
+{
+  // Twenty separate archipelagos of different sizes, far enough apart to form
+  // independent clusters, plus some lone islands
+  auto make_input = []()
+  {
+    std::vector<OGRGeometryPtr> geoms;
+    for (int c = 0; c < 20; c++)
+    {
+      const double x0 = (c % 5) * 100.0;
+      const double y0 = (c / 5) * 100.0;
+      const int n = 2 + c % 7;
+      for (int row = 0; row < n; row++)
+        for (int col = 0; col < n; col++)
+          geoms.push_back(make_square(x0 + col * 1.0, y0 + row * 1.0, 0.8));
+      geoms.push_back(make_square(x0 + 50, y0 + 50, 0.5));
+    }
+    return geoms;
+  };
+
+  auto serial = make_input();
+  auto threaded = make_input();
+
+  GeometryAmalgamator amalgamator;
+  amalgamator.lengthLimit(0.3);
+  amalgamator.threads(1);
+  amalgamator.apply(serial);
+  amalgamator.threads(4);
+  amalgamator.apply(threaded);
+
+  if (serial.size() != threaded.size())
+    TEST_FAILED("Expected " + to_string(serial.size()) + " polygons from threaded run, got " +
+                to_string(threaded.size()));
+
+  for (std::size_t i = 0; i < serial.size(); i++)
+    if (Fmi::OGR::exportToWkt(*serial[i]) != Fmi::OGR::exportToWkt(*threaded[i]))
+      TEST_FAILED("Threaded result differs from the serial one at polygon " + to_string(i));
+
+  TEST_PASSED();
+}
+
 // Test driver
 class tests : public tframe::tests
 {
@@ -215,6 +259,7 @@ class tests : public tframe::tests
     TEST(archipelago);
     TEST(archipelago_with_mainland);
     TEST(none_disabled);
+    TEST(threaded_matches_serial);
   }
 };
 
@@ -0,0 +1,153 @@
+#include "Box.h"
+#include "GeometryCache.h"
+#include "GeometrySimplifier.h"
+#include "GeometrySmoother.h"
+
+#include <macgyver/Hash.h>
+#include <macgyver/StaticCleanup.h>
+#include <ogr_geometry.h>
+#include <regression/tframe.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+OGRGeometryPtr make_geom(const char* wkt)
+{
+  OGRGeometry* geom = nullptr;
+  OGRGeometryFactory::createFromWkt(wkt, nullptr, &geom);
+  return OGRGeometryPtr(geom);
+}
+
+std::vector<OGRGeometryPtr> make_layer()
+{
+  return {make_geom("POLYGON ((0 0,10 0,10 10,0 10,0 0))"),
+          make_geom("POLYGON ((20 0,30 0,30 10,20 10,20 0),(22 2,22 8,28 8,28 2,22 2))")};
+}
+
+}  // namespace
+
+namespace Tests
+{
+// ----------------------------------------------------------------------
+
+void fingerprint()
+{
+  auto layer1 = make_layer();
+  auto layer2 = make_layer();
+
+  if (Fmi::GeometryCache::fingerprint(layer1) != Fmi::GeometryCache::fingerprint(layer2))
+    TEST_FAILED("Identical layers should have the same fingerprint");
+
+  auto layer3 = make_layer();
+  layer3[1] = make_geom("POLYGON ((20 0,30 0,30 10,20 10,20 0),(22 2,22 8,28 8,28 3,22 2))");
+  if (Fmi::GeometryCache::fingerprint(layer1) == Fmi::GeometryCache::fingerprint(layer3))
+    TEST_FAILED("Moving a hole vertex should change the fingerprint");
+
+  layer3.pop_back();
+  if (Fmi::GeometryCache::fingerprint(layer1) == Fmi::GeometryCache::fingerprint(layer3))
+    TEST_FAILED("Removing a geometry should change the fingerprint");
+
+  auto line = make_geom("LINESTRING (0 0,10 0,10 10,0 10,0 0)");
+  if (Fmi::GeometryCache::fingerprint(*line) == Fmi::GeometryCache::fingerprint(*layer1[0]))
+    TEST_FAILED("Linestring and polygon should have different fingerprints");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void key()
+{
+  const auto fp = Fmi::GeometryCache::fingerprint(make_layer());
+
+  Fmi::GeometrySimplifier simplifier;
+  simplifier.type(Fmi::GeometrySimplifier::Type::VisvalingamWhyatt);
+  simplifier.tolerance(1);
+
+  Fmi::GeometrySmoother smoother;
+  smoother.type(Fmi::GeometrySmoother::Type::Average);
+  smoother.radius(2);
+
+  auto chain1 = simplifier.hash_value();
+  Fmi::hash_combine(chain1, smoother.hash_value());
+
+  smoother.radius(3);
+  auto chain2 = simplifier.hash_value();
+  Fmi::hash_combine(chain2, smoother.hash_value());
+
+  const Fmi::Box box1(0, 0, 30, 10, 300, 100);
+  const Fmi::Box box2(0, 0, 30, 10, 600, 200);
+
+  const auto key = Fmi::GeometryCache::key(fp, chain1, box1);
+  if (key != Fmi::GeometryCache::key(fp, chain1, Fmi::Box(0, 0, 30, 10, 300, 100)))
+    TEST_FAILED("Keys should be reproducible");
+  if (key == Fmi::GeometryCache::key(fp, chain2, box1))
+    TEST_FAILED("Changing the smoother radius should change the key");
+  if (key == Fmi::GeometryCache::key(fp, chain1, box2))
+    TEST_FAILED("Changing the image size should change the key");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void find_insert()
+{
+  auto layer = make_layer();
+  const auto key = Fmi::GeometryCache::key(
+      Fmi::GeometryCache::fingerprint(layer), 12345, Fmi::Box(0, 0, 30, 10, 300, 100));
+
+  if (Fmi::GeometryCache::Find(key))
+    TEST_FAILED("Cache should be empty");
+
+  auto result = Fmi::GeometryCache::Insert(key, std::move(layer));
+  if (!result || result->size() != 2)
+    TEST_FAILED("Insert should return the inserted geometries");
+
+  auto cached = Fmi::GeometryCache::Find(key);
+  if (cached != result)
+    TEST_FAILED("Find should return the shared result");
+
+  if (Fmi::GeometryCache::Find(key + 1))
+    TEST_FAILED("Find with a different key should fail");
+
+  // Evicted when the byte budget is too small to hold the result
+  const auto bytes = Fmi::GeometryCache::byteSize(*result);
+  Fmi::GeometryCache::SetCacheSize(bytes / 2);
+  Fmi::GeometryCache::Insert(key + 1, result);
+  Fmi::GeometryCache::Insert(key + 2, result);
+  if (Fmi::GeometryCache::Find(key) && Fmi::GeometryCache::Find(key + 1) &&
+      Fmi::GeometryCache::Find(key + 2))
+    TEST_FAILED("Byte budget should have forced evictions");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(fingerprint);
+    TEST(key);
+    TEST(find_insert);
+  }
+};
+
+}  // namespace Tests
+
+int main()
+{
+  Fmi::StaticCleanup::AtExit cleanup;
+  cout << endl
+       << "GeometryCache tester\n"
+          "====================\n";
+  Tests::tests t;
+  return t.run();
+}
@@ -2,6 +2,7 @@
 
 #include <macgyver/StaticCleanup.h>
 
+#include <array>
 #include <cmath>
 #include <gdal.h>
 #include <limits>
@@ -15,6 +16,7 @@
 #include "CoordinateTransformation.h"
 #include "GeometryProjector.h"
 #include "Interrupt.h"
+#include "Shape_rect.h"
 #include "SpatialReference.h"
 
 namespace
@@ -954,6 +956,164 @@ TEST(GeometryProjectorTests, MultiPolygon_DropsEmptyChildren_AndKeepsNonEmpty)
   EXPECT_TRUE(geometryIsValid(out.get())) << wktOf(out.get());
 }
 
+// All vertices of a collection are projected in one batch, possibly split across threads.
+// The result must match projecting each member separately.
+
+TEST(GeometryProjectorTests, GeometryCollection_BatchedProjection_MatchesPerMember)
+{
+  CPLSetConfigOption("OGR_GEOMETRY_ACCEPT_UNCLOSED_RING", "NO");
+  static GdalInitGuard guard;
+  Fixture fx;
+
+  OGRPolygon holed;
+  OGRLinearRing ext1;
+  ext1.addPoint(20, 62);
+  ext1.addPoint(22, 62);
+  ext1.addPoint(22, 63);
+  ext1.addPoint(20, 63);
+  ext1.addPoint(20, 62);
+  holed.addRing(&ext1);
+  OGRLinearRing hole;
+  hole.addPoint(20.5, 62.3);
+  hole.addPoint(20.5, 62.6);
+  hole.addPoint(21, 62.6);
+  hole.addPoint(21, 62.3);
+  hole.addPoint(20.5, 62.3);
+  holed.addRing(&hole);
+
+  OGRPolygon large;
+  OGRLinearRing ext2;
+  ext2.addPoint(25, 64);
+  ext2.addPoint(30, 64);
+  ext2.addPoint(30, 68);
+  ext2.addPoint(25, 68);
+  ext2.addPoint(25, 64);
+  large.addRing(&ext2);
+
+  OGRLineString line;
+  line.addPoint(23, 61);
+  line.addPoint(28, 69);
+
+  OGRPoint point(25, 65);
+
+  OGRGeometryCollection gc;
+  gc.addGeometry(&holed);
+  gc.addGeometry(&point);
+  gc.addGeometry(&large);
+  gc.addGeometry(&line);
+
+  // Densify to 100 m to get enough vertices for threading
+  auto serial = fx.makeProjector(0.1);
+  auto threaded = fx.makeProjector(0.1);
+  threaded.setThreads(4);
+
+  auto out1 = serial.projectGeometry(&gc);
+  auto out2 = threaded.projectGeometry(&gc);
+  ASSERT_TRUE(out1);
+  ASSERT_TRUE(out2);
+  EXPECT_EQ(wktOf(out1.get()), wktOf(out2.get()));
+
+  const auto* coll = dynamic_cast<const OGRGeometryCollection*>(out1.get());
+  ASSERT_TRUE(coll);
+  ASSERT_EQ(coll->getNumGeometries(), gc.getNumGeometries()) << wktOf(out1.get());
+  for (int i = 0; i < gc.getNumGeometries(); ++i)
+  {
+    auto member = serial.projectGeometry(gc.getGeometryRef(i));
+    ASSERT_TRUE(member);
+    EXPECT_EQ(wktOf(coll->getGeometryRef(i)), wktOf(member.get()));
+  }
+}
+
+// A densified geometry shared by projectors into different CRSs and with different
+// densification resolutions must project exactly like the plain geometry.
+
+TEST(GeometryProjectorTests, DensifiedGeometry_SharedByProjectors_MatchesPlainGeometry)
+{
+  CPLSetConfigOption("OGR_GEOMETRY_ACCEPT_UNCLOSED_RING", "NO");
+  static GdalInitGuard guard;
+  Fixture fx;
+
+  OGRPolygon poly;
+  OGRLinearRing ext;
+  ext.addPoint(20, 60);
+  ext.addPoint(30, 60);
+  ext.addPoint(30, 69);
+  ext.addPoint(20, 69);
+  ext.addPoint(20, 60);
+  poly.addRing(&ext);
+
+  OGRLineString line;
+  line.addPoint(18, 59);
+  line.addPoint(32, 70);
+
+  OGRGeometryCollection gc;
+  gc.addGeometry(&poly);
+  gc.addGeometry(&line);
+
+  Fmi::DensifiedGeometry densified(gc);
+
+  auto mercator = makeSRS(3857);
+  Fmi::GeometryProjector other(&fx.wgs84, &mercator);
+  other.setProjectedBounds(1500000.0, 7500000.0, 4500000.0, 12000000.0);
+
+  std::vector<Fmi::GeometryProjector> projectors;
+  projectors.push_back(fx.makeProjector(50.0));
+  projectors.push_back(fx.makeProjector(10.0));
+  projectors.push_back(std::move(other));
+
+  // Twice so that the second round uses the cached coordinates
+  for (int round = 0; round < 2; ++round)
+  {
+    for (const auto& projector : projectors)
+    {
+      auto expected = projector.projectGeometry(&gc);
+      auto out = projector.projectGeometry(densified);
+      ASSERT_TRUE(expected);
+      ASSERT_TRUE(out);
+      EXPECT_EQ(wktOf(out.get()), wktOf(expected.get()));
+    }
+  }
+}
+
+// A ring which is not exactly closed is closed by snapping or by a new vertex depending on the
+// ring closure tolerance of the projected bounds. The densified geometry is cached once per
+// resolution, but must still follow the bounds like the plain geometry.
+
+TEST(GeometryProjectorTests, DensifiedGeometry_NearlyClosedRing_FollowsBounds)
+{
+  CPLSetConfigOption("OGR_GEOMETRY_ACCEPT_UNCLOSED_RING", "NO");
+  static GdalInitGuard guard;
+  Fixture fx;
+
+  OGRPolygon poly;
+  OGRLinearRing ext;
+  ext.addPoint(20, 60);
+  ext.addPoint(30, 60);
+  ext.addPoint(30, 69);
+  ext.addPoint(20, 69);
+  ext.addPoint(20, 60.000001);
+  poly.addRing(&ext);
+
+  Fmi::DensifiedGeometry densified(poly);
+
+  // Closure tolerances 1e-8, 1e-5 and 1e-8 degrees around the gap of 1e-6 degrees
+  const std::vector<std::array<double, 4>> bounds = {
+      {19.95, 59.95, 20.05, 60.05}, {0.0, 40.0, 100.0, 90.0}, {19.95, 59.95, 20.05, 60.05}};
+
+  for (const auto& b : bounds)
+  {
+    Fmi::GeometryProjector projector(&fx.wgs84, &fx.wgs84);
+    projector.setProjectedBounds(b[0], b[1], b[2], b[3]);
+    projector.setDensifyResolutionKm(50.0);
+
+    auto expected = projector.projectGeometry(&poly);
+    auto out = projector.projectGeometry(densified);
+    ASSERT_TRUE(expected);
+    ASSERT_TRUE(out);
+    EXPECT_EQ(wktOf(out.get()), wktOf(expected.get()));
+  }
+}
+
 // No consecutive duplicate vertices in polygon output (snapping/closure robustness)
 
 TEST(GeometryProjectorTests, PolygonOutput_HasNoConsecutiveDuplicateVertices)
@@ -2252,6 +2412,124 @@ TEST(GeometryProjectorTests, Interrupt_ObTranTransverseSeam)
   }
 }
 
+// The interrupt geometry is cached per spatial reference, equivalent spatial
+// references share the same immutable object.
+TEST(GeometryProjectorTests, Interrupt_Cached)
+{
+  static GdalInitGuard guard;
+
+  Fmi::SpatialReference srs1("+proj=nsper +lon_0=25 +lat_0=60 +h=3000000 +datum=WGS84 +units=m");
+  Fmi::SpatialReference srs2("+proj=nsper +lon_0=25 +lat_0=60 +h=3000000 +datum=WGS84 +units=m");
+
+  auto intr1 = Fmi::sharedInterruptGeometry(srs1);
+  auto intr2 = Fmi::sharedInterruptGeometry(srs2);
+  ASSERT_TRUE(intr1);
+  ASSERT_TRUE(intr1->andGeometry) << "nsper: expected andGeometry";
+  EXPECT_EQ(intr1.get(), intr2.get()) << "nsper: interrupt geometry not shared";
+
+  // The copying API returns the same shared geometries
+  auto copy = Fmi::interruptGeometry(srs1);
+  EXPECT_EQ(copy.andGeometry.get(), intr1->andGeometry.get());
+
+  Fmi::SpatialReference merc("+proj=merc +lon_0=10 +datum=WGS84 +units=m");
+  auto env1 = Fmi::interruptEnvelope(merc);
+  auto env2 = Fmi::interruptEnvelope(merc);
+  EXPECT_DOUBLE_EQ(env1.MinX, -170.0);
+  EXPECT_DOUBLE_EQ(env1.MaxX, 190.0);
+  EXPECT_DOUBLE_EQ(env2.MinX, env1.MinX);
+
+  auto other = Fmi::sharedInterruptGeometry(merc);
+  EXPECT_NE(other.get(), intr1.get());
+}
+
+// Interrupt cuts are applied only to the polygons which need them. For lcc the
+// south pole cut applies only to parts reaching the pole, and the antimeridian
+// cuts apply only to parts touching ±180. Conditional cuts additionally require
+// the envelope of the part to contain the condition area.
+TEST(GeometryProjectorTests, Interrupt_ConditionalCuts)
+{
+  static GdalInitGuard guard;
+
+  Fmi::SpatialReference lcc("+proj=lcc +lat_1=60 +lat_2=30 +lon_0=0 +datum=WGS84 +units=m");
+  auto intr = Fmi::sharedInterruptGeometry(lcc);
+  ASSERT_TRUE(intr->cutRules) << "lcc: expected precomputed cut rules";
+  EXPECT_FALSE(Fmi::interruptGeometry(lcc).cutRules) << "lcc: copies should not share the rules";
+
+  // A meridian line reaching the pole is cut even though it does not span all longitudes
+  {
+    OGRGeometry* tmp = nullptr;
+    ASSERT_EQ(OGRGeometryFactory::createFromWkt("LINESTRING (30 0,30 -90)", nullptr, &tmp),
+              OGRERR_NONE);
+    std::unique_ptr<OGRGeometry> line(tmp);
+    std::unique_ptr<OGRGeometry> cut(Fmi::interruptCut(*line, *intr));
+    ASSERT_TRUE(cut);
+    OGREnvelope env;
+    cut->getEnvelope(&env);
+    EXPECT_GT(env.MinY, -90.0) << "south pole cut was not applied to the meridian";
+  }
+
+  // A conditional cut is skipped unless the envelope contains the condition
+  {
+    Fmi::Interrupt conditional;
+    Fmi::ConditionalCut cut;
+    cut.condition.MinX = 0;
+    cut.condition.MaxX = 30;
+    cut.condition.MinY = 0;
+    cut.condition.MaxY = 0;
+    cut.shape = std::make_shared<Fmi::Shape_rect>(14, -90, 16, 90);
+    conditional.conditionalCuts.push_back(cut);
+
+    OGRGeometry* tmp = nullptr;
+    ASSERT_EQ(OGRGeometryFactory::createFromWkt(
+                  "MULTIPOLYGON (((10 10,10 20,20 20,20 10,10 10)),"
+                  "((-10 -10,-10 10,40 10,40 -10,-10 -10)))",
+                  nullptr,
+                  &tmp),
+              OGRERR_NONE);
+    std::unique_ptr<OGRGeometry> polys(tmp);
+
+    std::unique_ptr<OGRGeometry> out(Fmi::interruptCut(*polys, conditional));
+    ASSERT_TRUE(out);
+    ASSERT_EQ(wkbFlatten(out->getGeometryType()), wkbMultiPolygon);
+    EXPECT_EQ(out->toMultiPolygon()->getNumGeometries(), 3)
+        << "only the polygon containing the condition should be cut";
+  }
+
+  const char* wkt =
+      "MULTIPOLYGON (((10 10,10 20,20 20,20 10,10 10)),"
+      "((-180 -90,-180 -70,180 -70,180 -90,-180 -90)))";
+  OGRGeometry* tmp = nullptr;
+  ASSERT_EQ(OGRGeometryFactory::createFromWkt(wkt, nullptr, &tmp), OGRERR_NONE);
+  std::unique_ptr<OGRGeometry> geom(tmp);
+
+  // The small polygon alone needs no cuts and is returned as is
+  std::unique_ptr<OGRGeometry> square(
+      Fmi::interruptCut(*geom->toMultiPolygon()->getGeometryRef(0), *intr));
+  ASSERT_TRUE(square);
+  EXPECT_EQ(wkbFlatten(square->getGeometryType()), wkbPolygon);
+  EXPECT_TRUE(square->Equals(geom->toMultiPolygon()->getGeometryRef(0)));
+
+  std::unique_ptr<OGRGeometry> out(Fmi::interruptCut(*geom, *intr));
+  ASSERT_TRUE(out);
+  ASSERT_EQ(wkbFlatten(out->getGeometryType()), wkbMultiPolygon);
+
+  // The small polygon survives untouched, the polar cap loses its edges at the cuts
+  bool found = false;
+  for (const auto* part : *out->toMultiPolygon())
+  {
+    OGREnvelope env;
+    part->getEnvelope(&env);
+    if (env.MinX == 10 && env.MaxX == 20 && env.MinY == 10 && env.MaxY == 20)
+      found = true;
+    else
+    {
+      EXPECT_GT(env.MinY, -90.0) << "south pole cut was not applied";
+      EXPECT_GT(env.MinX, -180.0) << "antimeridian cut was not applied";
+    }
+  }
+  EXPECT_TRUE(found) << "the polygon not crossing the cuts was modified";
+}
+
 // ---------------------------------------------------------------------------
 // Polar-cap regression helper
 // ---------------------------------------------------------------------------
@@ -5,6 +5,9 @@
 #include <geos/geom/Geometry.h>
 #include <regression/tframe.h>
 #include <ogr_geometry.h>
+#include <cmath>
+#include <map>
+#include <string>
 #include <vector>
 
 using namespace std;
@@ -190,6 +193,215 @@ void none_type()
   TEST_PASSED();
 }
 
+// ----------------------------------------------------------------------
+// Adjacent isoband-like cells with wavy shared edges. The threaded result
+// must match the serial one, and the shared edges must be simplified
+// identically in both cells so that no unshared vertices appear.
+// ----------------------------------------------------------------------
+
+namespace
+{
+// Wavy edge from (x1,y1) to (x2,y2), identical coordinates for both neighbouring cells
+void addEdge(OGRLinearRing* ring, double x1, double y1, double x2, double y2, bool reverse)
+{
+  const int n = 10;
+  for (int k = 0; k < n; k++)
+  {
+    const int s = (reverse ? n - k : k);
+    const double t = static_cast<double>(s) / n;
+    const double wave = (s == 0 || s == n ? 0 : 0.1 * std::sin(13 * t + 5 * x1 + 7 * y1));
+    const bool horizontal = (y1 == y2);
+    ring->addPoint(x1 + t * (x2 - x1) + (horizontal ? 0 : wave),
+                   y1 + t * (y2 - y1) + (horizontal ? wave : 0));
+  }
+}
+
+std::vector<OGRGeometryPtr> makeGrid(int n)
+{
+  std::vector<OGRGeometryPtr> geoms;
+  for (int j = 0; j < n; j++)
+    for (int i = 0; i < n; i++)
+    {
+      auto* ring = new OGRLinearRing;
+      addEdge(ring, i, j, i + 1, j, false);
+      addEdge(ring, i + 1, j, i + 1, j + 1, false);
+      addEdge(ring, i, j + 1, i + 1, j + 1, true);
+      addEdge(ring, i, j, i, j + 1, true);
+      ring->closeRings();
+      auto* poly = new OGRPolygon;
+      poly->addRingDirectly(ring);
+      geoms.push_back(OGRGeometryPtr(poly));
+    }
+  return geoms;
+}
+
+// Histogram of how many times each distinct vertex appears. Edges of the cells on the grid
+// boundary end at vertices shared by two cells only, and are not simplified symmetrically.
+std::map<int, int> sharing(const std::vector<OGRGeometryPtr>& geoms, double lo, double hi)
+{
+  std::map<std::pair<double, double>, int> counts;
+  for (const auto& geom : geoms)
+  {
+    const auto* ring = dynamic_cast<const OGRPolygon*>(geom.get())->getExteriorRing();
+    for (int i = 1, n = ring->getNumPoints(); i < n; i++)
+    {
+      const double x = ring->getX(i);
+      const double y = ring->getY(i);
+      if (x > lo && x < hi && y > lo && y < hi)
+        ++counts[std::make_pair(x, y)];
+    }
+  }
+  std::map<int, int> histogram;
+  for (const auto& count : counts)
+    ++histogram[count.second];
+  return histogram;
+}
+}  // namespace
+
+void threaded_matches_serial()
+{
+  auto before = sharing(makeGrid(40), 1.5, 38.5);
+
+  auto serial = makeGrid(40);
+  auto threaded = makeGrid(40);
+
+  GeometrySimplifier simplifier;
+  simplifier.type(GeometrySimplifier::Type::VisvalingamWhyatt);
+  simplifier.tolerance(0.01);
+
+  simplifier.threads(1);
+  simplifier.apply(serial, true);
+  simplifier.threads(4);
+  simplifier.apply(threaded, true);
+
+  for (std::size_t i = 0; i < serial.size(); i++)
+    if (OGR::exportToWkt(*serial[i]) != OGR::exportToWkt(*threaded[i]))
+      TEST_FAILED("Threaded simplification differs from serial simplification for cell " +
+                  std::to_string(i));
+
+  auto after = sharing(serial, 1.5, 38.5);
+  if (after[1] != 0)
+    TEST_FAILED("Shared cell edges were simplified differently in adjacent cells");
+
+  if (after[2] >= before[2])
+    TEST_FAILED("Shared cell edges should have been simplified");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void progressive()
+{
+  auto input = makeGrid(8);
+  input.push_back(make_geom("LINESTRING (0 -1, 1 -0.9, 2 -1, 3 -0.7, 4 -1, 5 -0.95, 6 -1)"));
+
+  ProgressiveSimplifier ranked(input, true);
+
+  // Extraction in any order must match a full simplification with the same tolerance
+  for (double tolerance : {0.05, 0.001, 0.3, 0.01, 100.0})
+  {
+    auto expected = makeGrid(8);
+    expected.push_back(make_geom("LINESTRING (0 -1, 1 -0.9, 2 -1, 3 -0.7, 4 -1, 5 -0.95, 6 -1)"));
+
+    GeometrySimplifier simplifier;
+    simplifier.type(GeometrySimplifier::Type::VisvalingamWhyatt);
+    simplifier.tolerance(tolerance);
+    simplifier.apply(expected, true);
+
+    auto result = ranked.extract(simplifier);
+    if (result.size() != expected.size())
+      TEST_FAILED("Extracted layer has the wrong number of geometries");
+
+    for (std::size_t i = 0; i < result.size(); i++)
+      if (OGR::exportToWkt(*result[i]) != OGR::exportToWkt(*expected[i]))
+        TEST_FAILED("Tolerance " + std::to_string(tolerance) + ": expected " +
+                    OGR::exportToWkt(*expected[i]) + ", got " + OGR::exportToWkt(*result[i]));
+  }
+
+  // A disabled simplifier returns copies of the input
+  auto copy = ranked.extract(GeometrySimplifier());
+  if (OGR::exportToWkt(*copy.back()) != OGR::exportToWkt(*input.back()))
+    TEST_FAILED("Disabled simplifier should not modify the geometries, got " +
+                OGR::exportToWkt(*copy.back()));
+
+  // The Z-coordinates of the kept vertices are extracted too
+  ProgressiveSimplifier zranked(
+      {make_geom("LINESTRING Z (0 0 1, 1 0.1 2, 2 0 3, 3 0.1 4, 4 0 5, 5 1 6)")}, false);
+  auto zresult = zranked.extract(0.3);
+  const auto* line = zresult[0]->toLineString();
+  if (line->Is3D() == 0)
+    TEST_FAILED("Extracted linestring should still be 3D");
+  if (line->getNumPoints() != 3)
+    TEST_FAILED("Expected 3 extracted vertices, got " + std::to_string(line->getNumPoints()));
+  if (line->getZ(0) != 1 || line->getZ(1) != 5 || line->getZ(2) != 6)
+    TEST_FAILED("Extracted Z-coordinates do not match the kept vertices");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+// With arcs the shared edges of the boundary cells are simplified
+// identically too, since the edges are simplified once between junctions.
+// ----------------------------------------------------------------------
+
+void arcs()
+{
+  auto before = sharing(makeGrid(40), 0.5, 39.5);
+
+  auto serial = makeGrid(40);
+  auto threaded = makeGrid(40);
+
+  GeometrySimplifier simplifier;
+  simplifier.type(GeometrySimplifier::Type::VisvalingamWhyatt);
+  simplifier.tolerance(0.01);
+  simplifier.arcs(true);
+
+  simplifier.threads(1);
+  simplifier.apply(serial, true);
+  simplifier.threads(4);
+  simplifier.apply(threaded, true);
+
+  for (std::size_t i = 0; i < serial.size(); i++)
+    if (OGR::exportToWkt(*serial[i]) != OGR::exportToWkt(*threaded[i]))
+      TEST_FAILED("Threaded simplification differs from serial simplification for cell " +
+                  std::to_string(i));
+
+  auto after = sharing(serial, 0.5, 39.5);
+  if (after[1] != 0)
+    TEST_FAILED("Shared arcs were simplified differently in adjacent cells");
+
+  if (after[2] >= before[2])
+    TEST_FAILED("Shared arcs should have been simplified");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+// The Z-coordinates of the kept vertices are kept
+// ----------------------------------------------------------------------
+
+void z_values()
+{
+  std::vector<OGRGeometryPtr> geoms = {
+      make_geom("LINESTRING Z (0 0 1, 1 0.1 2, 2 0 3, 3 0.1 4, 4 0 5, 5 1 6)")};
+
+  GeometrySimplifier simplifier;
+  simplifier.type(GeometrySimplifier::Type::VisvalingamWhyatt);
+  simplifier.tolerance(0.3);
+  simplifier.apply(geoms, false);
+
+  const auto* line = geoms[0]->toLineString();
+  if (line->Is3D() == 0)
+    TEST_FAILED("Simplified linestring should still be 3D");
+  if (line->getNumPoints() != 3)
+    TEST_FAILED("Expected 3 vertices, got " + std::to_string(line->getNumPoints()));
+  if (line->getZ(0) != 1 || line->getZ(1) != 5 || line->getZ(2) != 6)
+    TEST_FAILED("Z-coordinates do not match the kept vertices");
+
+  TEST_PASSED();
+}
+
 // Test driver
 class tests : public tframe::tests
 {
@@ -201,6 +413,10 @@ class tests : public tframe::tests
     TEST(closed_ring);
     TEST(degenerate_protection);
     TEST(none_type);
+    TEST(threaded_matches_serial);
+    TEST(progressive);
+    TEST(arcs);
+    TEST(z_values);
   }
 };
 
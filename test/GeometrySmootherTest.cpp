@@ -5,6 +5,7 @@
 #include <geos/geom/Geometry.h>
 #include <regression/tframe.h>
 #include <cmath>
+#include <map>
 #include <ogr_geometry.h>
 #include <vector>
 
@@ -144,6 +145,210 @@ void taubin()
   TEST_PASSED();
 }
 
+// ----------------------------------------------------------------------
+// Window sums on an isoline with a single spike, radius 1.5. The spike is
+// sqrt(2) away from its neighbours along the path, the other vertices 1.
+// ----------------------------------------------------------------------
+
+namespace
+{
+OGRGeometryPtr makeSpike()
+{
+  auto* line = new OGRLineString;
+  for (int i = 0; i <= 6; i++)
+    line->addPoint(i, i == 3 ? 1 : 0);
+  return OGRGeometryPtr(line);
+}
+
+double spikeY(GeometrySmoother::Type type, int i)
+{
+  std::vector<OGRGeometryPtr> g{makeSpike()};
+  GeometrySmoother s;
+  s.type(type);
+  s.radius(1.5);
+  s.apply(g, false);
+  return dynamic_cast<const OGRLineString*>(g[0].get())->getY(i);
+}
+}  // namespace
+
+void kernels()
+{
+  // Average: the spike and its neighbours see 3 vertices with one of them the spike
+  for (int i = 2; i <= 4; i++)
+    if (std::fabs(spikeY(GeometrySmoother::Type::Average, i) - 1.0 / 3) > 1e-12)
+      TEST_FAILED("Average smoothing at vertex " + std::to_string(i) + " should be 1/3, got " +
+                  std::to_string(spikeY(GeometrySmoother::Type::Average, i)));
+
+  if (spikeY(GeometrySmoother::Type::Average, 1) != 0)
+    TEST_FAILED("Average smoothing should not reach vertex 1");
+
+  // Linear: weight 1 at the vertex itself, (1.5-d)/1.5 for the neighbours
+  const double w1 = (1.5 - 1) / 1.5;
+  const double w2 = (1.5 - std::sqrt(2.0)) / 1.5;
+
+  const double y3 = 1 / (1 + 2 * w2);
+  if (std::fabs(spikeY(GeometrySmoother::Type::Linear, 3) - y3) > 1e-12)
+    TEST_FAILED("Linear smoothing at the spike should be " + std::to_string(y3) + ", got " +
+                std::to_string(spikeY(GeometrySmoother::Type::Linear, 3)));
+
+  const double y2 = w2 / (1 + w1 + w2);
+  if (std::fabs(spikeY(GeometrySmoother::Type::Linear, 2) - y2) > 1e-12)
+    TEST_FAILED("Linear smoothing next to the spike should be " + std::to_string(y2) + ", got " +
+                std::to_string(spikeY(GeometrySmoother::Type::Linear, 2)));
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+// Adjacent isoband-like cells with wavy shared edges. The threaded result
+// must match the serial one, and the shared edges must stay bit-identical
+// so that the vertex sharing pattern does not change.
+// ----------------------------------------------------------------------
+
+namespace
+{
+// Wavy edge from (x1,y1) to (x2,y2), identical coordinates for both neighbouring cells
+void addEdge(OGRLinearRing* ring, double x1, double y1, double x2, double y2, bool reverse)
+{
+  const int n = 10;
+  for (int k = 0; k < n; k++)
+  {
+    const int s = (reverse ? n - k : k);
+    const double t = static_cast<double>(s) / n;
+    const double wave = (s == 0 || s == n ? 0 : 0.1 * std::sin(13 * t + 5 * x1 + 7 * y1));
+    const bool horizontal = (y1 == y2);
+    ring->addPoint(x1 + t * (x2 - x1) + (horizontal ? 0 : wave),
+                   y1 + t * (y2 - y1) + (horizontal ? wave : 0));
+  }
+}
+
+std::vector<OGRGeometryPtr> makeGrid(int n)
+{
+  std::vector<OGRGeometryPtr> geoms;
+  for (int j = 0; j < n; j++)
+    for (int i = 0; i < n; i++)
+    {
+      auto* ring = new OGRLinearRing;
+      addEdge(ring, i, j, i + 1, j, false);
+      addEdge(ring, i + 1, j, i + 1, j + 1, false);
+      addEdge(ring, i, j + 1, i + 1, j + 1, true);
+      addEdge(ring, i, j, i, j + 1, true);
+      ring->closeRings();
+      auto* poly = new OGRPolygon;
+      poly->addRingDirectly(ring);
+      geoms.push_back(OGRGeometryPtr(poly));
+    }
+  return geoms;
+}
+
+// Histogram of how many times each distinct vertex appears
+std::map<int, int> sharing(const std::vector<OGRGeometryPtr>& geoms)
+{
+  std::map<std::pair<double, double>, int> counts;
+  for (const auto& geom : geoms)
+  {
+    const auto* ring = dynamic_cast<const OGRPolygon*>(geom.get())->getExteriorRing();
+    for (int i = 1, n = ring->getNumPoints(); i < n; i++)
+      ++counts[std::make_pair(ring->getX(i), ring->getY(i))];
+  }
+  std::map<int, int> histogram;
+  for (const auto& count : counts)
+    ++histogram[count.second];
+  return histogram;
+}
+}  // namespace
+
+void threaded_matches_serial()
+{
+  const auto before = sharing(makeGrid(40));
+
+  auto serial = makeGrid(40);
+  auto threaded = makeGrid(40);
+
+  GeometrySmoother s;
+  s.type(GeometrySmoother::Type::Gaussian);
+  s.radius(0.35);
+  s.iterations(2);
+
+  s.threads(1);
+  s.apply(serial, true);
+  s.threads(4);
+  s.apply(threaded, true);
+
+  for (std::size_t i = 0; i < serial.size(); i++)
+    if (OGR::exportToWkt(*serial[i]) != OGR::exportToWkt(*threaded[i]))
+      TEST_FAILED("Threaded smoothing differs from serial smoothing for cell " +
+                  std::to_string(i));
+
+  if (sharing(serial) != before)
+    TEST_FAILED("Shared cell edges are no longer identical after smoothing");
+
+  if (OGR::exportToWkt(*serial[0]) == OGR::exportToWkt(*makeGrid(1)[0]))
+    TEST_FAILED("Shared cell edges should have been smoothed");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+// With arcs the shared edges are smoothed up to the cell corners instead
+// of freezing the vertices next to them, and remain identical.
+// ----------------------------------------------------------------------
+
+void arcs()
+{
+  const auto before = sharing(makeGrid(40));
+
+  auto vertices = makeGrid(40);
+  auto arcs = makeGrid(40);
+
+  GeometrySmoother s;
+  s.type(GeometrySmoother::Type::Gaussian);
+  s.radius(0.35);
+  s.iterations(2);
+
+  s.apply(vertices, true);
+  s.arcs(true);
+  s.apply(arcs, true);
+
+  if (sharing(arcs) != before)
+    TEST_FAILED("Shared arcs are no longer identical after smoothing");
+
+  if (OGR::exportToWkt(*arcs[41]) == OGR::exportToWkt(*vertices[41]))
+    TEST_FAILED("Arcs should have been smoothed up to the junctions");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+// The Z-coordinates of the vertices are kept
+// ----------------------------------------------------------------------
+
+void z_values()
+{
+  OGRGeometry* geom = nullptr;
+  OGRGeometryFactory::createFromWkt(
+      "LINESTRING Z (0 0 1,1 1 2,2 0 3,3 1 4,4 0 5)", nullptr, &geom);
+  std::vector<OGRGeometryPtr> geoms{OGRGeometryPtr(geom)};
+
+  GeometrySmoother s;
+  s.type(GeometrySmoother::Type::Average);
+  s.radius(1.5);
+  s.apply(geoms, false);
+
+  const auto* line = geoms[0]->toLineString();
+  if (line->Is3D() == 0)
+    TEST_FAILED("Smoothed linestring should still be 3D");
+  if (line->getNumPoints() != 5)
+    TEST_FAILED("Smoothing should not change the number of vertices");
+  if (line->getY(1) == 1)
+    TEST_FAILED("The linestring should have been smoothed");
+  for (int i = 0; i < 5; i++)
+    if (line->getZ(i) != i + 1)
+      TEST_FAILED("Z-coordinate of vertex " + std::to_string(i) + " changed");
+
+  TEST_PASSED();
+}
+
 // Test driver
 class tests : public tframe::tests
 {
@@ -154,6 +359,10 @@ class tests : public tframe::tests
   {
     TEST(apply);
     TEST(taubin);
+    TEST(kernels);
+    TEST(threaded_matches_serial);
+    TEST(arcs);
+    TEST(z_values);
   }
 
 };  // class tests
@@ -0,0 +1,271 @@
+#include "HostPool.h"
+#include "TestDefs.h"
+#include <gdal.h>
+#include <ogrsf_frmts.h>
+#include <regression/tframe.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+namespace Tests
+{
+Fmi::Host test_host()
+{
+  return Fmi::Host(GIS_TEST_DB_HOST, GIS_TEST_DB_NAME, GIS_TEST_DB_USER, GIS_TEST_DB_PASSWORD);
+}
+
+// The tests needing a database pass trivially if the test database cannot be reached
+bool database_available()
+{
+  static const bool available = []
+  {
+    try
+    {
+      test_host().connect();
+      return true;
+    }
+    catch (...)
+    {
+      cout << "\n\tTest database " GIS_TEST_DB_HOST " not available, skipping" << endl;
+      return false;
+    }
+  }();
+  return available;
+}
+
+// Server process id of the connection, or -1 if the query fails
+int backend_pid(const GDALDataPtr& theConnection)
+{
+  auto* result = theConnection->ExecuteSQL("SELECT pg_backend_pid()", nullptr, nullptr);
+  if (result == nullptr)
+    return -1;
+  int pid = -1;
+  std::unique_ptr<OGRFeature> feature(result->GetNextFeature());
+  if (feature)
+    pid = feature->GetFieldAsInteger(0);
+  theConnection->ReleaseResultSet(result);
+  return pid;
+}
+
+// Nothing listens on port 1, opening connections must fail without leaking pool slots
+void connect_failure()
+{
+  Fmi::HostPool pool(Fmi::Host("127.0.0.1", "gis", "nobody", "secret", 1), 2);
+
+  for (int i = 0; i < 3; i++)
+  {
+    bool failed = false;
+    try
+    {
+      auto conn = pool.get();
+    }
+    catch (...)
+    {
+      failed = true;
+    }
+    if (!failed)
+      TEST_FAILED("Connecting to port 1 should fail");
+    if (pool.size() != 0)
+      TEST_FAILED("Failed connections should not be counted, got " + std::to_string(pool.size()));
+  }
+
+  if (pool.idle() != 0)
+    TEST_FAILED("There should be no idle connections");
+
+  pool.clear();
+
+  TEST_PASSED();
+}
+
+// A returned connection is handed out again instead of opening a new one
+void reuse()
+{
+  if (!database_available())
+    TEST_PASSED();
+
+  Fmi::HostPool pool(test_host(), 2);
+
+  int pid1 = 0;
+  {
+    auto conn = pool.get();
+    pid1 = backend_pid(conn.get());
+  }
+  if (pool.size() != 1 || pool.idle() != 1)
+    TEST_FAILED("Expected one idle connection, got " + std::to_string(pool.size()) + " open and " +
+                std::to_string(pool.idle()) + " idle");
+
+  int pid2 = 0;
+  {
+    auto conn = pool.get();
+    if (pool.idle() != 0)
+      TEST_FAILED("The idle connection should be in use");
+    pid2 = backend_pid(conn.get());
+  }
+  if (pid1 <= 0 || pid1 != pid2)
+    TEST_FAILED("Expected the same backend, got " + std::to_string(pid1) + " and " +
+                std::to_string(pid2));
+  if (pool.size() != 1)
+    TEST_FAILED("Expected one open connection, got " + std::to_string(pool.size()));
+
+  TEST_PASSED();
+}
+
+// get() waits for a connection at the cap and times out if none is returned
+void cap()
+{
+  if (!database_available())
+    TEST_PASSED();
+
+  {
+    Fmi::HostPool pool(test_host(), 1, std::chrono::milliseconds(100));
+    auto conn = pool.get();
+
+    const auto start = std::chrono::steady_clock::now();
+    bool failed = false;
+    try
+    {
+      auto conn2 = pool.get();
+    }
+    catch (...)
+    {
+      failed = true;
+    }
+    if (!failed)
+      TEST_FAILED("Getting a second connection from a pool of one should time out");
+    if (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100))
+      TEST_FAILED("get() returned before the timeout");
+    if (pool.size() != 1)
+      TEST_FAILED("Expected one open connection, got " + std::to_string(pool.size()));
+  }
+
+  {
+    Fmi::HostPool pool(test_host(), 1, std::chrono::seconds(10));
+    auto conn = std::make_unique<Fmi::HostPool::Connection>(pool.get());
+    const int pid1 = backend_pid(conn->get());
+
+    // The waiting get() receives the connection returned by the other thread
+    std::thread releaser(
+        [&conn]
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+          conn.reset();
+        });
+    auto conn2 = pool.get();
+    releaser.join();
+
+    if (backend_pid(conn2.get()) != pid1)
+      TEST_FAILED("Expected the returned connection to be reused");
+    if (pool.size() != 1)
+      TEST_FAILED("Expected one open connection, got " + std::to_string(pool.size()));
+  }
+
+  TEST_PASSED();
+}
+
+// An invalidated connection is closed and replaced by a new one
+void invalidate()
+{
+  if (!database_available())
+    TEST_PASSED();
+
+  Fmi::HostPool pool(test_host(), 1, std::chrono::milliseconds(100));
+
+  int pid1 = 0;
+  {
+    auto conn = pool.get();
+    pid1 = backend_pid(conn.get());
+    conn.invalidate();
+  }
+  if (pool.size() != 0 || pool.idle() != 0)
+    TEST_FAILED("The invalidated connection should have been closed");
+
+  // The closed connection no longer counts towards the cap
+  auto conn = pool.get();
+  const int pid2 = backend_pid(conn.get());
+  if (pid2 <= 0 || pid2 == pid1)
+    TEST_FAILED("Expected a new backend, got " + std::to_string(pid1) + " and " +
+                std::to_string(pid2));
+
+  TEST_PASSED();
+}
+
+// A broken idle connection is replaced when it is handed out after the health check interval
+void health_check()
+{
+  if (!database_available())
+    TEST_PASSED();
+
+  Fmi::HostPool pool(test_host(), 1, std::chrono::milliseconds(100), std::chrono::milliseconds(0));
+
+  int pid1 = 0;
+  {
+    auto conn = pool.get();
+    pid1 = backend_pid(conn.get());
+    // Break the connection without telling the pool
+    auto* result = conn.get()->ExecuteSQL(
+        "SELECT pg_terminate_backend(pg_backend_pid())", nullptr, nullptr);
+    if (result != nullptr)
+      conn.get()->ReleaseResultSet(result);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  auto conn = pool.get();
+  const int pid2 = backend_pid(conn.get());
+  if (pid2 <= 0 || pid2 == pid1)
+    TEST_FAILED("Expected the broken connection to be replaced, got backends " +
+                std::to_string(pid1) + " and " + std::to_string(pid2));
+  if (pool.size() != 1)
+    TEST_FAILED("Expected one open connection, got " + std::to_string(pool.size()));
+
+  TEST_PASSED();
+}
+
+void invalid_size()
+{
+  bool failed = false;
+  try
+  {
+    Fmi::HostPool pool(Fmi::Host("127.0.0.1", "gis", "nobody", "secret"), 0);
+  }
+  catch (...)
+  {
+    failed = true;
+  }
+  if (!failed)
+    TEST_FAILED("An empty pool should not be allowed");
+  TEST_PASSED();
+}
+
+// Test driver
+class tests : public tframe::tests
+{
+  // Overridden message separator
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  // Main test suite
+  void test()
+  {
+    TEST(connect_failure);
+    TEST(invalid_size);
+    TEST(reuse);
+    TEST(cap);
+    TEST(invalidate);
+    TEST(health_check);
+  }
+
+};  // class tests
+
+}  // namespace Tests
+
+int main(void)
+{
+  GDALAllRegister();
+
+  cout << endl
+       << "HostPool tester\n"
+          "==============="
+       << endl;
+  Tests::tests t;
+  return t.run();
+}
@@ -1,6 +1,7 @@
 #include "Box.h"
 #include "CoordinateTransformation.h"
 #include "OGR.h"
+#include "OutputSink.h"
 #include "Shape_rect.h"
 #include "SpatialReference.h"
 #include "TestDefs.h"
@@ -8,6 +9,9 @@
 #include <regression/tframe.h>
 #include <memory>
 #include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 #include <ogr_geometry.h>
 
 using namespace std;
@@ -452,6 +456,248 @@ void exportToSvg_precision()
 
 // ----------------------------------------------------------------------
 
+void exportToSvg_fixed_point()
+{
+  using namespace Fmi;
+  using Fmi::Box;
+  using OGR::exportToSvg;
+
+  // Rounding, negative zero and numbers too large for the integer formatting
+
+  {
+    const char* wkt = "LINESTRING (-1.23456 2.5, 1234.56789 -0.0004, 1e14 3)";
+    OGRGeometry* geom;
+    OGRGeometryFactory::createFromWkt(wkt, NULL, &geom);
+    string result = exportToSvg(*geom, Box::identity(), 3);
+    OGRGeometryFactory::destroyGeometry(geom);
+    string ok = "M-1.235 2.5 1234.568 0 100000000000000 3";
+    if (result != ok)
+      TEST_FAILED("Expected: " + ok + "\n\tObtained: " + result);
+  }
+
+  // Pixel coordinates with duplicates after rounding
+
+  {
+    const char* wkt = "POLYGON ((10 10, 12.3456 45.6789, 90 90, 90.04 90.04, 10 10))";
+    OGRGeometry* geom;
+    OGRGeometryFactory::createFromWkt(wkt, NULL, &geom);
+    Box box(0, 0, 100, 100, 1000, 1000);
+    string result1 = exportToSvg(*geom, box, 1);
+    string result0 = exportToSvg(*geom, box, 0);
+    OGRGeometryFactory::destroyGeometry(geom);
+
+    string ok1 = "M100 900 123.5 543.2 900 100 900.4 99.6Z";
+    if (result1 != ok1)
+      TEST_FAILED("Precision 1:\n\tExpected: " + ok1 + "\n\tObtained: " + result1);
+
+    string ok0 = "M100 900 123 543 900 100Z";
+    if (result0 != ok0)
+      TEST_FAILED("Precision 0:\n\tExpected: " + ok0 + "\n\tObtained: " + result0);
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void exportToSvg_formats()
+{
+  using namespace Fmi;
+  using Fmi::Box;
+  using OGR::exportToSvg;
+
+  const char* linestring = "LINESTRING (10 10, 20 10, 20 5, 25 8, 25 8, 30 11)";
+  const char* polygon = "POLYGON ((0 0, 10 0, 10 10, 0 10, 0 0))";
+
+  OGR::SvgOptions options;
+  options.precision = 0;
+
+  OGRGeometry* geom;
+  {
+    OGRGeometryFactory::createFromWkt(linestring, NULL, &geom);
+    options.format = OGR::SvgFormat::Relative;
+    string result = exportToSvg(*geom, Box::identity(), options);
+    OGRGeometryFactory::destroyGeometry(geom);
+    string ok = "M10 10h10v-5l5 3 5 3";
+    if (result != ok)
+      TEST_FAILED("Relative:\n\tExpected: " + ok + "\n\tObtained: " + result);
+  }
+
+  {
+    OGRGeometryFactory::createFromWkt(polygon, NULL, &geom);
+    options.format = OGR::SvgFormat::Relative;
+    string result = exportToSvg(*geom, Box::identity(), options);
+    string ok = "M0 0h10v10h-10Z";
+    if (result != ok)
+    {
+      OGRGeometryFactory::destroyGeometry(geom);
+      TEST_FAILED("Relative:\n\tExpected: " + ok + "\n\tObtained: " + result);
+    }
+
+    // Decimals, ring, position, 3 deltas as zigzag varints
+    options.format = OGR::SvgFormat::Binary;
+    result = exportToSvg(*geom, Box::identity(), options);
+    OGRGeometryFactory::destroyGeometry(geom);
+    const char bytes[] = {0, 2, 0, 0, 3, 20, 0, 0, 20, 19, 0};
+    if (result != string(bytes, sizeof(bytes)))
+      TEST_FAILED("Binary output failed");
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void exportToSvg_reduce()
+{
+  using namespace Fmi;
+  using Fmi::Box;
+  using OGR::exportToSvg;
+
+  // Collinear runs, a duplicate and a back-tracking spike
+  const char* linestring = "LINESTRING (0 0,1 0,2 0,2 0,3 0,3 1,3 2,3 1.4,3 3)";
+  // Collinear vertices at the closing vertex and a hole inside one pixel
+  const char* polygon1 =
+      "POLYGON ((0 0,5 0,10 0,10 10,0 10,0 5,0 0),(2 2,2.2 2.1,2.4 2.3,2 2))";
+  // Ring starting in the middle of an edge
+  const char* polygon2 = "POLYGON ((5 0,10 0,10 10,0 10,0 0,5 0))";
+
+  OGR::SvgOptions options;
+  options.precision = 0;
+  options.reduce = true;
+
+  std::vector<std::pair<const char*, string>> tests = {
+      {linestring, "M0 0 3 0 3 3"},
+      {polygon1, "M0 0 10 0 10 10 0 10Z"},
+      {polygon2, "M10 0 10 10 0 10 0 0Z"}};
+
+  for (const auto& test : tests)
+  {
+    OGRGeometry* geom;
+    OGRGeometryFactory::createFromWkt(test.first, NULL, &geom);
+    string result = exportToSvg(*geom, Box::identity(), options);
+    OGRGeometryFactory::destroyGeometry(geom);
+    if (result != test.second)
+      TEST_FAILED("Input: " + string(test.first) + "\n\tExpected: " + test.second +
+                  "\n\tObtained: " + result);
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void exportToSink()
+{
+  using namespace Fmi;
+  using Fmi::Box;
+
+  const char* polygon = "POLYGON ((0 0,10 0,10 10.25,0 0),(1 1,2 1,1 2,1 1))";
+  const char* collection = "GEOMETRYCOLLECTION (POINT (1 2),LINESTRING (0.1234 5,6 -7.5))";
+
+  OGRGeometry* geom;
+  {
+    OGRGeometryFactory::createFromWkt(polygon, NULL, &geom);
+    string result = OGR::exportToGeoJson(*geom, 1);
+    string ok =
+        R"({"type":"Polygon","coordinates":[[[0,0],[10,0],[10,10.3],[0,0]],)"
+        R"([[1,1],[2,1],[1,2],[1,1]]]})";
+    if (result != ok)
+    {
+      OGRGeometryFactory::destroyGeometry(geom);
+      TEST_FAILED("GeoJSON:\n\tExpected: " + ok + "\n\tObtained: " + result);
+    }
+
+    // Appends to the existing content
+    result = "x";
+    BufferSink<string> sink(result);
+    OGR::exportToWkt(sink, *geom, 2);
+    ok = "xPOLYGON ((0 0,10 0,10 10.25,0 0),(1 1,2 1,1 2,1 1))";
+    if (result != ok)
+    {
+      OGRGeometryFactory::destroyGeometry(geom);
+      TEST_FAILED("WKT:\n\tExpected: " + ok + "\n\tObtained: " + result);
+    }
+
+    // Chunks and callbacks must reproduce the string output
+    ok = OGR::exportToSvg(*geom, Box::identity(), 1);
+    ChunkSink chunks(4);
+    OGR::exportToSvg(chunks, *geom, Box::identity(), OGR::SvgOptions());
+    result.clear();
+    for (const auto& chunk : chunks.chunks())
+      result.append(chunk.data, chunk.size);
+    if (result != ok)
+    {
+      OGRGeometryFactory::destroyGeometry(geom);
+      TEST_FAILED("ChunkSink:\n\tExpected: " + ok + "\n\tObtained: " + result);
+    }
+
+    result.clear();
+    CallbackSink callback([&result](const char* data, std::size_t size)
+                          { result.append(data, size); });
+    OGR::exportToSvg(callback, *geom, Box::identity(), OGR::SvgOptions());
+    OGRGeometryFactory::destroyGeometry(geom);
+    if (result != ok)
+      TEST_FAILED("CallbackSink:\n\tExpected: " + ok + "\n\tObtained: " + result);
+  }
+
+  {
+    OGRGeometryFactory::createFromWkt(collection, NULL, &geom);
+    string result = OGR::exportToGeoJson(*geom, 2);
+    string ok =
+        R"({"type":"GeometryCollection","geometries":[{"type":"Point","coordinates":[1,2]},)"
+        R"({"type":"LineString","coordinates":[[0.12,5],[6,-7.5]]}]})";
+    if (result != ok)
+    {
+      OGRGeometryFactory::destroyGeometry(geom);
+      TEST_FAILED("GeoJSON:\n\tExpected: " + ok + "\n\tObtained: " + result);
+    }
+
+    result.clear();
+    BufferSink<string> sink(result);
+    OGR::exportToWkt(sink, *geom, 2);
+    OGRGeometryFactory::destroyGeometry(geom);
+    ok = "GEOMETRYCOLLECTION (POINT (1 2),LINESTRING (0.12 5,6 -7.5))";
+    if (result != ok)
+      TEST_FAILED("WKT:\n\tExpected: " + ok + "\n\tObtained: " + result);
+  }
+
+  {
+    // Multipoint members are not parenthesized, just like in OGRGeometry::exportToWkt
+    OGRGeometryFactory::createFromWkt("MULTIPOINT ((1 2),(3.126 -4))", NULL, &geom);
+    string result;
+    BufferSink<string> sink(result);
+    OGR::exportToWkt(sink, *geom, 2);
+    OGRGeometryFactory::destroyGeometry(geom);
+    string ok = "MULTIPOINT (1 2,3.13 -4)";
+    if (result != ok)
+      TEST_FAILED("WKT:\n\tExpected: " + ok + "\n\tObtained: " + result);
+  }
+
+  {
+    // A writer failing before finish() leaves only the written characters in the buffer
+    string result = "x";
+    try
+    {
+      BufferSink<string> sink(result);
+      OutputCursor cursor(sink);
+      char* pos = cursor.reserve(100);
+      *pos++ = 'y';
+      cursor.advance(pos);
+      throw std::runtime_error("writer failed");
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+    if (result != "xy")
+      TEST_FAILED("Unfinished cursor:\n\tExpected: xy\n\tObtained: " + result);
+  }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
 void lineclip()
 {
   using namespace Fmi;
@@ -2158,6 +2404,10 @@ class tests : public tframe::tests
     TEST(exportToSvg_wiki_examples);
     TEST(exportToWkt_spatialreference);
     TEST(exportToSvg_precision);
+    TEST(exportToSvg_fixed_point);
+    TEST(exportToSvg_formats);
+    TEST(exportToSvg_reduce);
+    TEST(exportToSink);
     TEST(exportToProj);
     TEST(expand_geometry);
     TEST(despeckle);
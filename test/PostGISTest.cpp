@@ -0,0 +1,126 @@
+#include "CoordinateTransformation.h"
+#include "PostGIS.h"
+#include "TestDefs.h"
+#include <gdal.h>
+#include <regression/tframe.h>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+namespace Tests
+{
+// The filter box in the spatial reference of the layer is unchanged
+void filter_same_crs()
+{
+  Fmi::PostGIS::SpatialFilter filter{Fmi::BBox(20, 30, 60, 70), Fmi::SpatialReference("WGS84")};
+  auto env = Fmi::PostGIS::filterEnvelope(filter, Fmi::SpatialReference("WGS84"));
+  if (!env)
+    TEST_FAILED("Expected an envelope for a geographic box");
+  if (env->MinX != 20 || env->MaxX != 30 || env->MinY != 60 || env->MaxY != 70)
+    TEST_FAILED("Expected 20,60,30,70 but got " + std::to_string(env->MinX) + "," +
+                std::to_string(env->MinY) + "," + std::to_string(env->MaxX) + "," +
+                std::to_string(env->MaxY));
+  TEST_PASSED();
+}
+
+// A geographic box projected to EPSG:3067 covers the curved edges, not just the corners
+void filter_reproject()
+{
+  Fmi::SpatialReference layer("EPSG:3067");
+  Fmi::PostGIS::SpatialFilter filter{Fmi::BBox(20, 30, 60, 70), Fmi::SpatialReference("WGS84")};
+  auto env = Fmi::PostGIS::filterEnvelope(filter, layer);
+  if (!env)
+    TEST_FAILED("Expected an envelope for a box inside EPSG:3067");
+
+  // The northern edge bulges north from the corners, and is northernmost at the central
+  // meridian 27E of EPSG:3067
+  std::vector<double> x = {20, 30, 30, 20, 25, 27};
+  std::vector<double> y = {60, 60, 70, 70, 70, 70};
+  Fmi::CoordinateTransformation transformation("WGS84", layer);
+  transformation.transform(x, y);
+
+  for (std::size_t i = 0; i < 5; i++)
+    if (x[i] < env->MinX || x[i] > env->MaxX || y[i] < env->MinY || y[i] > env->MaxY)
+      TEST_FAILED("Point " + std::to_string(i) + " is outside the envelope");
+
+  if (env->MaxY <= std::max(y[2], y[3]))
+    TEST_FAILED("The curved northern edge should extend north of the corners");
+  if (env->MaxY > y[5] + 1)
+    TEST_FAILED("The envelope should not extend further north than the northern edge");
+  TEST_PASSED();
+}
+
+// A polar stereographic box around the north pole includes the pole and all longitudes
+void filter_pole()
+{
+  Fmi::SpatialReference stere("+proj=stere +lat_0=90 +lat_ts=60 +lon_0=20 +datum=WGS84 +units=m");
+  Fmi::PostGIS::SpatialFilter filter{Fmi::BBox(-1000000, 1000000, -1000000, 1000000), stere};
+  auto env = Fmi::PostGIS::filterEnvelope(filter, Fmi::SpatialReference("WGS84"));
+  if (!env)
+    TEST_FAILED("Expected an envelope for a box around the pole");
+  if (env->MaxY != 90)
+    TEST_FAILED("Expected the north pole to be included, got MaxY=" + std::to_string(env->MaxY));
+  if (env->MinX != -180 || env->MaxX != 180)
+    TEST_FAILED("Expected all longitudes, got " + std::to_string(env->MinX) + "..." +
+                std::to_string(env->MaxX));
+  if (env->MinY < 70 || env->MinY > 85)
+    TEST_FAILED("Expected the southern limit to be 70...85, got " + std::to_string(env->MinY));
+  TEST_PASSED();
+}
+
+// A box crossing the antimeridian covers all longitudes in a geographic layer
+void filter_antimeridian()
+{
+  Fmi::SpatialReference pacific("+proj=eqc +lon_0=180 +datum=WGS84 +units=m");
+  Fmi::PostGIS::SpatialFilter filter{Fmi::BBox(-1000000, 1000000, 0, 1000000), pacific};
+  auto env = Fmi::PostGIS::filterEnvelope(filter, Fmi::SpatialReference("WGS84"));
+  if (!env)
+    TEST_FAILED("Expected an envelope for a box crossing the antimeridian");
+  if (env->MinX != -180 || env->MaxX != 180)
+    TEST_FAILED("Expected all longitudes, got " + std::to_string(env->MinX) + "..." +
+                std::to_string(env->MaxX));
+  if (env->MaxY >= 90)
+    TEST_FAILED("The pole is not inside the box");
+
+  // The same box at the prime meridian is not widened
+  Fmi::SpatialReference atlantic("+proj=eqc +lon_0=0 +datum=WGS84 +units=m");
+  Fmi::PostGIS::SpatialFilter filter2{filter.bbox, atlantic};
+  env = Fmi::PostGIS::filterEnvelope(filter2, Fmi::SpatialReference("WGS84"));
+  if (!env)
+    TEST_FAILED("Expected an envelope for a box at the prime meridian");
+  if (env->MinX < -10 || env->MaxX > 10)
+    TEST_FAILED("Expected longitudes within -10...10, got " + std::to_string(env->MinX) + "..." +
+                std::to_string(env->MaxX));
+  TEST_PASSED();
+}
+
+// Test driver
+class tests : public tframe::tests
+{
+  // Overridden message separator
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  // Main test suite
+  void test()
+  {
+    TEST(filter_same_crs);
+    TEST(filter_reproject);
+    TEST(filter_pole);
+    TEST(filter_antimeridian);
+  }
+
+};  // class tests
+
+}  // namespace Tests
+
+int main(void)
+{
+  GDALAllRegister();
+
+  cout << endl
+       << "PostGIS tester\n"
+          "=============="
+       << endl;
+  Tests::tests t;
+  return t.run();
+}
@@ -0,0 +1,193 @@
+#include "CoordinateMatrix.h"
+#include "OGR.h"
+#include "PreparedGeometry.h"
+
+#include <macgyver/StaticCleanup.h>
+#include <ogr_geometry.h>
+#include <regression/tframe.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+std::unique_ptr<OGRGeometry> make_geom(const std::string& wkt)
+{
+  OGRGeometry* g = nullptr;
+  OGRGeometryFactory::createFromWkt(wkt.c_str(), nullptr, &g);
+  return std::unique_ptr<OGRGeometry>(g);
+}
+
+// Two squares, the first one with a hole, and a concave polygon
+const char* multipolygon =
+    "MULTIPOLYGON (((0 0,10 0,10 10,0 10,0 0),(2 2,2 8,8 8,8 2,2 2)),"
+    "((20 0,30 0,30 10,20 10,20 0)),"
+    "((0.5 20.5,10.5 20.5,10.5 30.5,5.5 25.5,0.5 30.5,0.5 20.5)))";
+
+}  // namespace
+
+namespace Tests
+{
+// ----------------------------------------------------------------------
+
+void inside_single()
+{
+  auto geom = make_geom(multipolygon);
+  Fmi::PreparedGeometry prepared(*geom);
+
+  if (prepared.empty())
+    TEST_FAILED("Multipolygon should not be empty");
+
+  if (!prepared.inside(1, 1))
+    TEST_FAILED("1,1 should be inside the first polygon");
+  if (prepared.inside(5, 5))
+    TEST_FAILED("5,5 should be inside the hole");
+  if (!prepared.inside(25, 5))
+    TEST_FAILED("25,5 should be inside the second polygon");
+  if (prepared.inside(15, 5))
+    TEST_FAILED("15,5 should be between the polygons");
+  if (!prepared.inside(2.5, 27))
+    TEST_FAILED("2.5,27 should be inside the concave polygon");
+  if (prepared.inside(5.5, 29))
+    TEST_FAILED("5.5,29 should be in the notch of the concave polygon");
+  if (prepared.inside(-100, -100))
+    TEST_FAILED("-100,-100 should be outside all envelopes");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void inside_matches_ogr()
+{
+  auto geom = make_geom(multipolygon);
+  Fmi::PreparedGeometry prepared(*geom);
+
+  // Offset the points so that none of them is exactly on a boundary
+  for (int j = -4; j < 140; j++)
+    for (int i = -4; i < 140; i++)
+    {
+      const double x = 0.25 * i + 0.125;
+      const double y = 0.25 * j + 0.0625;
+      if (prepared.inside(x, y) != Fmi::OGR::inside(*geom, x, y))
+        TEST_FAILED("PreparedGeometry and OGR::inside disagree at " + std::to_string(x) + "," +
+                    std::to_string(y));
+    }
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void inside_batch()
+{
+  auto geom = make_geom(multipolygon);
+
+  const std::vector<double> x{1, 5, 25, 15, 2.5, 5.5};
+  const std::vector<double> y{1, 5, 5, 5, 27, 29};
+  const std::vector<bool> expected{true, false, true, false, true, false};
+
+  std::unique_ptr<bool[]> result(new bool[x.size()]);
+  Fmi::OGR::inside(*geom, x.data(), y.data(), result.get(), x.size());
+
+  for (std::size_t i = 0; i < x.size(); i++)
+    if (result[i] != expected[i])
+      TEST_FAILED("Batch result " + std::to_string(i) + " is incorrect");
+
+  // Repeated calls give the same result
+  Fmi::OGR::inside(*geom, x.data(), y.data(), result.get(), x.size());
+  for (std::size_t i = 0; i < x.size(); i++)
+    if (result[i] != expected[i])
+      TEST_FAILED("Repeated batch result " + std::to_string(i) + " is incorrect");
+
+  // A modified geometry is indexed anew
+  Fmi::OGR::translate(*geom, 100, 0);
+  Fmi::OGR::inside(*geom, x.data(), y.data(), result.get(), x.size());
+  for (std::size_t i = 0; i < x.size(); i++)
+    if (result[i])
+      TEST_FAILED("Batch result " + std::to_string(i) + " after translation is incorrect");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void inside_lines_and_empty()
+{
+  auto line = make_geom("LINESTRING (0 0,10 0,10 10,0 10,0 0)");
+  Fmi::PreparedGeometry prepared(*line);
+  if (!prepared.empty())
+    TEST_FAILED("Linestrings cannot contain points");
+  if (prepared.inside(5, 5))
+    TEST_FAILED("5,5 cannot be inside a linestring");
+
+  auto empty = make_geom("POLYGON EMPTY");
+  Fmi::PreparedGeometry prepared2(*empty);
+  if (prepared2.inside(0, 0))
+    TEST_FAILED("Nothing can be inside an empty polygon");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+void mask_grid()
+{
+  auto geom = make_geom(multipolygon);
+  Fmi::PreparedGeometry prepared(*geom);
+
+  // Grid points at integer coordinates hit the vertices and edges exactly, which
+  // is the hardest case for the scanline fill to match the pointwise tests.
+  const std::size_t nx = 41;
+  const std::size_t ny = 41;
+
+  auto mask1 = prepared.mask(nx, ny, -5, -5, 35, 35);
+  auto mask2 = prepared.mask(Fmi::CoordinateMatrix(nx, ny, -5, -5, 35, 35));
+
+  if (mask1.width() != nx || mask1.height() != ny)
+    TEST_FAILED("Mask has the wrong size");
+
+  for (std::size_t j = 0; j < ny; j++)
+    for (std::size_t i = 0; i < nx; i++)
+      if (mask1(i, j) != mask2(i, j))
+        TEST_FAILED("Scanline and pointwise masks differ at " + std::to_string(i) + "," +
+                    std::to_string(j));
+
+  // Point 6,6 is at x=1,y=1 inside the first polygon, 10,10 at x=y=5 in the hole
+  if (!mask1(6, 6))
+    TEST_FAILED("Grid point 6,6 should be inside");
+  if (mask1(10, 10))
+    TEST_FAILED("Grid point 10,10 should be inside the hole");
+
+  TEST_PASSED();
+}
+
+// ----------------------------------------------------------------------
+
+class tests : public tframe::tests
+{
+  virtual const char* error_message_prefix() const { return "\n\t"; }
+  void test()
+  {
+    TEST(inside_single);
+    TEST(inside_matches_ogr);
+    TEST(inside_batch);
+    TEST(inside_lines_and_empty);
+    TEST(mask_grid);
+  }
+};
+
+}  // namespace Tests
+
+int main()
+{
+  Fmi::StaticCleanup::AtExit cleanup;
+  cout << endl
+       << "PreparedGeometry tester\n"
+          "=======================\n";
+  Tests::tests t;
+  return t.run();
+}
@@ -2,6 +2,7 @@
 #include "CoordinateTransformation.h"
 #include "OGR.h"
 #include "Shape_circle.h"
+#include "Shape_polygon.h"
 #include "Shape_rect.h"
 #include "Shape_sphere.h"
 #include "SpatialReference.h"
@@ -234,6 +235,35 @@ class tests : public tframe::tests
                   precision = atoi(sParams[4].c_str());
               }
             }
+            else if (sParams[0] == "POLYGON")
+            {
+              // POLYGON,x1 y1,x2 y2,...,xn yn[,precision]
+              OGRLinearRing ring;
+              for (uint i = 1; i < sz; i++)
+              {
+                double x = 0;
+                double y = 0;
+                if (sscanf(sParams[i].c_str(), "%lf %lf", &x, &y) == 2)
+                  ring.addPoint(x, y);
+                else if (i == sz - 1)
+                  precision = atoi(sParams[i].c_str());
+              }
+
+              if (ring.getNumPoints() < 3)
+              {
+                out << "Test " << testId << " : ";
+                out << "*** FAILED ***\n";
+                out << "\tFile     : " << filename << " (" << line << ")\n";
+                out << "\tReason   : "
+                    << "Invalid number of vertices for Shape_polygon!\n";
+                out << "\tShape    : " << shapeStr << "\n";
+                addFailure();
+              }
+              else
+              {
+                shape.reset(new Fmi::Shape_polygon(ring));
+              }
+            }
             else
             {
               out << "Test " << testId << " : ";
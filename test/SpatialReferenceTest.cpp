@@ -1,11 +1,17 @@
+#include "OGRSpatialReferenceFactory.h"
 #include "SpatialReference.h"
 #include "TestDefs.h"
 
 #include <macgyver/StaticCleanup.h>
 #include <regression/tframe.h>
 #include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -105,6 +111,119 @@ void getepsg_parallel()
   TEST_PASSED();
 }
 
+void savecache()
+{
+  const std::string fmi =
+      "+proj=stere +lat_0=90 +lat_ts=60 +lon_0=20 +k=1 +x_0=0 +y_0=0 +R=6371220 +units=m +wktext "
+      "+towgs84=0,0,0 +no_defs +type=crs";
+
+  Fmi::SpatialReference wgs84("WGS84");
+  Fmi::SpatialReference epsg3067("EPSG:3067");
+  Fmi::SpatialReference stere(fmi);
+
+  const auto filename =
+      (std::filesystem::temp_directory_path() / "SpatialReferenceTest.cache").string();
+
+  auto saved = Fmi::SpatialReference::saveCache(filename);
+  // Three factory records and three SpatialReference records at least
+  if (saved < 6)
+    TEST_FAILED("Expected at least 6 saved records, got " + std::to_string(saved));
+
+  // Reload into empty caches
+  Fmi::SpatialReference::clearCache();
+  auto loaded = Fmi::SpatialReference::loadCache(filename, 2);
+  if (loaded != saved)
+    TEST_FAILED("Saved " + std::to_string(saved) + " records but loaded " + std::to_string(loaded));
+
+  Fmi::SpatialReference crs(fmi);
+  if (crs.WKT() != stere.WKT() || crs.projStr() != stere.projStr())
+    TEST_FAILED("Loaded cache changed the FMI polar stereographic definition");
+  if (crs.get() == stere.get())
+    TEST_FAILED("The FMI polar stereographic definition should have been rebuilt from the file");
+  if (Fmi::SpatialReference("WGS84").getEPSG() != 4326)
+    TEST_FAILED("Failed to get 4326 for 'WGS84' after loading the cache");
+
+  // Modify the file to verify the objects come from it: EPSG:3067 gets the factory definition
+  // of EPSG:4326, and the FMI definition the WKT of EPSG:3067
+  {
+    std::vector<std::string> lines;
+    {
+      std::ifstream in(filename);
+      std::string line;
+      while (std::getline(in, line))
+        lines.push_back(line);
+    }
+
+    std::string wkt2_4326;
+    for (const auto& line : lines)
+      if (line.rfind("F\tEPSG:4326\t", 0) == 0)
+        wkt2_4326 = line.substr(line.rfind('\t') + 1);
+
+    bool f_modified = false;
+    bool s_modified = false;
+    std::ofstream out(filename);
+    for (auto line : lines)
+    {
+      if (line.rfind("F\tEPSG:3067\t", 0) == 0 && !wkt2_4326.empty())
+      {
+        line = "F\tEPSG:3067\t" + wkt2_4326;
+        f_modified = true;
+      }
+      else if (line.rfind("S\t" + fmi + "\t", 0) == 0)
+      {
+        const auto pos = line.find('\t', 3 + fmi.size());
+        line = "S\t" + fmi + "\t" + epsg3067.WKT() + line.substr(pos);
+        s_modified = true;
+      }
+      out << line << '\n';
+    }
+    if (!f_modified || !s_modified)
+      TEST_FAILED("Failed to find the EPSG:3067 and FMI records in the snapshot");
+  }
+
+  Fmi::SpatialReference::clearCache();
+  Fmi::SpatialReference::loadCache(filename);
+  if (!Fmi::OGRSpatialReferenceFactory::Create("EPSG:3067")->IsGeographic())
+    TEST_FAILED("EPSG:3067 should have been restored from the modified factory record");
+  if (Fmi::SpatialReference(fmi).WKT() != epsg3067.WKT())
+    TEST_FAILED("The FMI definition should have been restored from the modified record");
+
+  Fmi::SpatialReference::clearCache();
+  if (Fmi::OGRSpatialReferenceFactory::Create("EPSG:3067")->IsGeographic())
+    TEST_FAILED("Clearing the cache should discard the restored definitions");
+
+  // Snapshots written by other GDAL or PROJ versions are ignored
+  {
+    std::ofstream out(filename);
+    out << "# SpatialReference cache 1 GDAL 0.0 PROJ 0.0.0\n";
+  }
+  loaded = Fmi::SpatialReference::loadCache(filename);
+  std::remove(filename.c_str());
+  if (loaded != 0)
+    TEST_FAILED("Should ignore snapshots of other versions, loaded " + std::to_string(loaded));
+
+  TEST_PASSED();
+}
+
+void canonical()
+{
+  Fmi::SpatialReference crs1("EPSG:4326");
+  Fmi::SpatialReference crs2("epsg:4326");
+  Fmi::SpatialReference crs3(" WGS84 ");
+  Fmi::SpatialReference crs4(4326);
+
+  if (crs1.get() != crs2.get() || crs1.get() != crs3.get() || crs1.get() != crs4.get())
+    TEST_FAILED("Equivalent descriptors of EPSG:4326 should share the same object");
+
+  Fmi::SpatialReference crs5("EPSG:3067");
+  if (crs5.get() == crs1.get())
+    TEST_FAILED("EPSG:3067 and EPSG:4326 should not share the same object");
+  if (crs5.getEPSG() != 3067)
+    TEST_FAILED("Failed to get 3067 for 'EPSG:3067'");
+
+  TEST_PASSED();
+}
+
 // Test driver
 class tests : public tframe::tests
 {
@@ -115,6 +234,8 @@ class tests : public tframe::tests
   {
     TEST(getepsg);
     TEST(getepsg_parallel);
+    TEST(canonical);
+    TEST(savecache);
   }
 
 };  // class tests
@@ -13,3 +13,17 @@
 #ifndef GIS_SMALLTESTDATA
 #define GIS_SMALLTESTDATA 0
 #endif
+
+// PostgreSQL database for the connection pool tests, which pass trivially if it cannot be reached
+#ifndef GIS_TEST_DB_HOST
+#define GIS_TEST_DB_HOST "127.0.0.1"
+#endif
+#ifndef GIS_TEST_DB_NAME
+#define GIS_TEST_DB_NAME "postgres"
+#endif
+#ifndef GIS_TEST_DB_USER
+#define GIS_TEST_DB_USER "postgres"
+#endif
+#ifndef GIS_TEST_DB_PASSWORD
+#define GIS_TEST_DB_PASSWORD ""
+#endif